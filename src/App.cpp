@@ -15,6 +15,7 @@
 #include <Language.h>
 #include <LocaleRoster.h>
 #include <Path.h>
+#include <StringFormat.h>
 #include <tracker_private.h>
 #include <WindowStack.h>
 
@@ -30,6 +31,7 @@
 #include "FindWindow.h"
 #include "GoToLineWindow.h"
 #include "Preferences.h"
+#include "RecoveryJournal.h"
 #include "Styler.h"
 #include "Utils.h"
 #include "QuitAlert.h"
@@ -200,6 +202,7 @@ App::QuitRequested()
 void
 App::ReadyToRun()
 {
+	_RecoverJournals();
 	if(fSuppressInitialWindow == false && CountWindows() == 0) {
 		PostMessage(WINDOW_NEW);
 	}
@@ -269,7 +272,8 @@ App::MessageReceived(BMessage* message)
 		}
 		fPreferences->fFindWindowState = *message;
 	} break;
-	case FINDWINDOW_BOOKMARKALL: {
+	case FINDWINDOW_BOOKMARKALL:
+	case FINDWINDOW_FINDALL: {
 		if(fLastActiveWindow != nullptr) {
 			BMessenger messenger((BWindow*) fLastActiveWindow);
 			messenger.SendMessage(message);
@@ -319,6 +323,16 @@ App::MessageReceived(BMessage* message)
 			_CreateWindowWithQuitReply(detached);
 		}
 	} break;
+	case WINDOW_NEW_FOR_STDIN: {
+		// the sender streams standard input straight to the window
+		std::unique_ptr<BWindowStack> stack;
+		auto window = _CreateWindow(message, stack);
+		window->ReadStdin();
+		window->Show();
+		BMessage reply(B_REPLY);
+		reply.AddMessenger("window", BMessenger(window));
+		message->SendReply(&reply);
+	} break;
 	case WINDOW_CLOSE: {
 		EditorWindow* window;
 		if(message->FindPointer("window", (void**) &window) == B_OK) {
@@ -415,3 +429,39 @@ App::_CreateWindowWithQuitReply(BMessage* message, const entry_ref* ref,
 		window->OpenFile(ref, line, column);
 	window->Show();
 }
+
+
+/**
+ * Offers to restore unsaved changes of windows which were not closed
+ * properly, e.g. because of a crash. Every document is restored in its own
+ * window.
+ */
+void
+App::_RecoverJournals()
+{
+	const auto journals = RecoveryJournal::Orphans(
+		RecoveryJournal::Directory(fPreferences->fSettingsPath));
+	if(journals.empty())
+		return;
+
+	BString message;
+	static BStringFormat format(B_TRANSLATE("Koder was not closed properly. "
+		"{0, plural, one{# document has} other{# documents have}} unsaved "
+		"changes. Do you want to restore them?"));
+	format.Format(message, static_cast<int32>(journals.size()));
+	BAlert* alert = new BAlert(B_TRANSLATE("Unsaved changes"), message.String(),
+		B_TRANSLATE("Discard"), B_TRANSLATE("Restore"), nullptr,
+		B_WIDTH_AS_USUAL, B_EVEN_SPACING, B_WARNING_ALERT);
+	if(alert->Go() == 0) {
+		for(const auto& journal : journals)
+			BEntry(journal.Path()).Remove();
+		return;
+	}
+
+	std::unique_ptr<BWindowStack> windowStack;
+	for(const auto& journal : journals) {
+		auto window = _CreateWindow(nullptr, windowStack);
+		window->RecoverJournal(journal.Path());
+		window->Show();
+	}
+}
@@ -26,7 +26,12 @@ class Styler;
 enum {
 	SUPPRESS_INITIAL_WINDOW		= 'Siwn',
 	WINDOW_NEW_WITH_QUIT_REPLY	= 'NWwn',
-	ACTIVATE_WINDOW				= 'actw'
+	WINDOW_NEW_FOR_STDIN		= 'NWsi',
+	ACTIVATE_WINDOW				= 'actw',
+
+	// sent to the window created for standard input
+	STDIN_DATA					= 'sidt',
+	STDIN_FINISHED				= 'sifn'
 };
 
 
@@ -57,6 +62,7 @@ private:
 									const entry_ref* ref = nullptr,
 									const int32 line = -1,
 									const int32 column = -1);
+	void						_RecoverJournals();
 
 	BObjectList<EditorWindow>	fWindows;
 	EditorWindow*				fLastActiveWindow;
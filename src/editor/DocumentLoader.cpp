@@ -0,0 +1,191 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include "DocumentLoader.h"
+
+#include <File.h>
+#include <Message.h>
+
+#include <ILoader.h>
+
+#include <algorithm>
+#include <vector>
+
+
+DocumentLoader::DocumentLoader(BScintillaView* editor, const char* path,
+	BMessenger target, int documentOptions, TextEncoding encoding,
+	Compression compression)
+	:
+	fEditor(editor),
+	fPath(path),
+	fTarget(target),
+	fDocumentOptions(documentOptions),
+	fEncoding(encoding),
+	fCompression(compression),
+	fLoader(nullptr),
+	fDocument(nullptr),
+	fThread(-1),
+	fCancelled(false)
+{
+}
+
+
+DocumentLoader::~DocumentLoader()
+{
+	Cancel();
+	if(fThread >= 0) {
+		status_t result;
+		wait_for_thread(fThread, &result);
+	}
+	if(fLoader != nullptr)
+		fLoader->Release();
+	if(fDocument != nullptr)
+		fEditor->SendMessage(SCI_RELEASEDOCUMENT, 0, (sptr_t) fDocument);
+}
+
+
+status_t
+DocumentLoader::Start()
+{
+	BFile file(fPath.c_str(), B_READ_ONLY);
+	off_t size;
+	status_t status = file.InitCheck();
+	if(status != B_OK || (status = file.GetSize(&size)) != B_OK)
+		return status;
+
+	// must be created on the thread owning the view
+	fLoader = reinterpret_cast<Scintilla::ILoader*>(fEditor->SendMessage(
+		SCI_CREATELOADER, size, fDocumentOptions));
+	if(fLoader == nullptr)
+		return B_NO_MEMORY;
+
+	fThread = spawn_thread(_LoadThread, "document loader",
+		B_NORMAL_PRIORITY, this);
+	if(fThread < 0)
+		return fThread;
+	return resume_thread(fThread);
+}
+
+
+void
+DocumentLoader::Cancel()
+{
+	fCancelled = true;
+}
+
+
+/**
+ * Returns the loaded document with a reference count of 1. Caller takes the
+ * ownership and should release it after attaching to a view.
+ */
+void*
+DocumentLoader::TakeDocument()
+{
+	void* document = fDocument;
+	fDocument = nullptr;
+	return document;
+}
+
+
+/* static */ status_t
+DocumentLoader::_LoadThread(void* data)
+{
+	DocumentLoader* self = static_cast<DocumentLoader*>(data);
+	status_t status = self->_Load();
+	if(self->fCancelled == false) {
+		BMessage finished(LOADER_FINISHED);
+		finished.AddInt32("status", status);
+		self->fTarget.SendMessage(&finished);
+	}
+	return status;
+}
+
+
+status_t
+DocumentLoader::_Load()
+{
+	BFile file(fPath.c_str(), B_READ_ONLY);
+	off_t size;
+	status_t status = file.InitCheck();
+	if(status != B_OK || (status = file.GetSize(&size)) != B_OK)
+		return status;
+
+	// compressed data is read in smaller pieces, so that what they expand to
+	// stays around the chunk size
+	std::vector<char> buffer(fCompression == Compression::NONE
+		? kChunkSize : kChunkSize / 16);
+	Decompressor decompressor(fCompression);
+	TextDecoder decoder(fEncoding);
+	std::string decompressed, decoded;
+	off_t total = 0;
+	int32 lastPercent = -1;
+	while(fCancelled == false) {
+		ssize_t bytesRead = file.Read(buffer.data(), buffer.size());
+		if(bytesRead < 0)
+			return bytesRead;
+		if(bytesRead == 0)
+			break;
+		std::string_view chunk(buffer.data(), bytesRead);
+		fFileHasher.Update(chunk);
+		if(fCompression != Compression::NONE) {
+			decompressed.clear();
+			if(decompressor.Decompress(chunk, decompressed) == false)
+				return B_BAD_DATA;
+			chunk = decompressed;
+		}
+		if((status = _AddData(chunk, decoder, decoded)) != B_OK)
+			return status;
+		total += bytesRead;
+
+		// don't flood the window with messages
+		int32 percent = size > 0 ? total * 100 / size : 100;
+		if(percent != lastPercent) {
+			BMessage progress(LOADER_PROGRESS);
+			progress.AddFloat("progress", std::min(percent, (int32) 100) / 100.0f);
+			fTarget.SendMessage(&progress);
+			lastPercent = percent;
+		}
+	}
+	if(fCancelled == true)
+		return B_CANCELED;
+
+	decompressed.clear();
+	if(decompressor.Finish(decompressed) == false)
+		return B_BAD_DATA;
+	if((status = _AddData(decompressed, decoder, decoded)) != B_OK)
+		return status;
+	decoded.clear();
+	decoder.Finish(decoded);
+	fLineEndings.Update(decoded);
+	if(!decoded.empty()
+			&& fLoader->AddData(decoded.data(), decoded.size()) != SC_STATUS_OK)
+		return B_NO_MEMORY;
+
+	// the loader turns into the document, with the same reference
+	fDocument = fLoader->ConvertToDocument();
+	fLoader = nullptr;
+	return fDocument != nullptr ? B_OK : B_NO_MEMORY;
+}
+
+
+/**
+ * Converts data to UTF-8 if needed and adds it to the document.
+ */
+status_t
+DocumentLoader::_AddData(std::string_view data, TextDecoder& decoder,
+	std::string& decoded)
+{
+	if(fEncoding != TextEncoding::UTF8) {
+		decoded.clear();
+		decoder.Decode(data, decoded);
+		data = decoded;
+	}
+	fLineEndings.Update(data);
+	if(!data.empty()
+			&& fLoader->AddData(data.data(), data.size()) != SC_STATUS_OK)
+		return B_NO_MEMORY;
+	return B_OK;
+}
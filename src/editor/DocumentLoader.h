@@ -0,0 +1,87 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#ifndef DOCUMENTLOADER_H
+#define DOCUMENTLOADER_H
+
+
+#include <atomic>
+#include <string>
+#include <string_view>
+
+#include <Messenger.h>
+#include <OS.h>
+
+#include <ScintillaView.h>
+
+#include "Compression.h"
+#include "Encoding.h"
+#include "Hash.h"
+#include "LineEndings.h"
+
+
+namespace Scintilla {
+	class ILoader;
+}
+
+
+enum {
+	LOADER_PROGRESS		= 'ldpr',
+	LOADER_FINISHED		= 'ldfn'
+};
+
+
+/**
+ * DocumentLoader reads a file into a fresh Scintilla document on a worker
+ * thread, using the loader interface (SCI_CREATELOADER). The view keeps its
+ * current document until loading is done, so the window stays responsive.
+ * Progress is reported to the target as LOADER_PROGRESS messages with
+ * a "progress" float, completion as LOADER_FINISHED with a "status" int32.
+ * After LOADER_FINISHED the document can be taken with TakeDocument().
+ * Compressed files are decompressed and text in other encodings is converted
+ * to UTF-8 chunk by chunk. Line endings are counted on the way, see
+ * LineEndings(), and the file as read is hashed, see FileHasher().
+ */
+class DocumentLoader {
+public:
+	static const size_t	kChunkSize = 1024 * 1024;
+
+						DocumentLoader(BScintillaView* editor,
+							const char* path, BMessenger target,
+							int documentOptions = 0,
+							TextEncoding encoding = TextEncoding::UTF8,
+							Compression compression = Compression::NONE);
+						~DocumentLoader();
+
+	status_t			Start();
+	void				Cancel();
+
+	void*				TakeDocument();
+	const LineEndingCounter&	LineEndings() const { return fLineEndings; }
+	const Hasher&		FileHasher() const { return fFileHasher; }
+
+private:
+	static	status_t	_LoadThread(void* data);
+			status_t	_Load();
+			status_t	_AddData(std::string_view data, TextDecoder& decoder,
+							std::string& decoded);
+
+	BScintillaView*		fEditor;
+	std::string			fPath;
+	BMessenger			fTarget;
+	int					fDocumentOptions;
+	TextEncoding		fEncoding;
+	Compression			fCompression;
+
+	Scintilla::ILoader*	fLoader;
+	void*				fDocument;
+	LineEndingCounter	fLineEndings;
+	Hasher				fFileHasher;
+	thread_id			fThread;
+	std::atomic<bool>	fCancelled;
+};
+
+
+#endif // DOCUMENTLOADER_H
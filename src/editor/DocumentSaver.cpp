@@ -0,0 +1,213 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include "DocumentSaver.h"
+
+#include <Message.h>
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <span>
+
+#include "DocumentLoader.h"
+#include "File.h"
+#include "LocalHistory.h"
+
+
+namespace {
+
+int32 sNextSerial = 0;
+
+}
+
+
+status_t
+WriteText(File* file, const std::array<std::string_view, 2>& spans,
+	TextEncoding encoding, Compression compression, Hasher* hasher)
+{
+	status_t status = B_OK;
+	Compressor compressor(compression);
+	std::string compressed;
+	auto output = [&](std::string_view data) {
+		if(hasher != nullptr)
+			hasher->Update(data);
+		if(file != nullptr)
+			status = file->Write(data);
+	};
+	auto write = [&](std::string_view data) {
+		if(status != B_OK)
+			return;
+		if(compression == Compression::NONE) {
+			output(data);
+			return;
+		}
+		compressed.clear();
+		if(compressor.Compress(data, compressed) == false)
+			status = B_ERROR;
+		else
+			output(compressed);
+	};
+
+	if(encoding == TextEncoding::UTF8 || encoding == TextEncoding::UTF8_BOM) {
+		if(encoding == TextEncoding::UTF8_BOM)
+			write("\xEF\xBB\xBF");
+		for(auto span : spans) {
+			// in chunks, so that the compressed output does not pile up
+			while(!span.empty() && status == B_OK) {
+				const size_t length = std::min(span.size(), DocumentLoader::kChunkSize);
+				write(span.substr(0, length));
+				span.remove_prefix(length);
+			}
+		}
+	} else {
+		TextEncoder encoder(encoding);
+		std::string encoded;
+		for(auto span : spans) {
+			while(!span.empty() && status == B_OK) {
+				const size_t length = std::min(span.size(), DocumentLoader::kChunkSize);
+				encoded.clear();
+				encoder.Encode(span.substr(0, length), encoded);
+				write(encoded);
+				span.remove_prefix(length);
+			}
+		}
+		encoded.clear();
+		encoder.Finish(encoded);
+		write(encoded);
+	}
+
+	if(status == B_OK && compression != Compression::NONE) {
+		compressed.clear();
+		if(compressor.Finish(compressed) == false)
+			status = B_ERROR;
+		else
+			output(compressed);
+	}
+	return status;
+}
+
+
+/**
+ * Copying the document is a memcpy, far cheaper than writing it out, and
+ * Scintilla has no way to share its buffer with another thread.
+ */
+DocumentSaver::DocumentSaver(const char* path,
+	const std::array<std::string_view, 2>& spans, BMessenger target,
+	TextEncoding encoding, Compression compression, bool atomic)
+	:
+	fPath(path),
+	fTarget(target),
+	fEncoding(encoding),
+	fCompression(compression),
+	fAtomic(atomic),
+	fSerial(atomic_add(&sNextSerial, 1)),
+	fThread(-1),
+	fStatus(B_NO_INIT)
+{
+	fText.reserve(spans[0].size() + spans[1].size());
+	fText.append(spans[0]);
+	fText.append(spans[1]);
+}
+
+
+DocumentSaver::~DocumentSaver()
+{
+	Wait();
+}
+
+
+/**
+ * Records the text in the local history in directory once it is written.
+ * Must be called before Start().
+ */
+void
+DocumentSaver::SetHistoryDirectory(const BPath& directory)
+{
+	fHistoryDirectory = directory;
+}
+
+
+status_t
+DocumentSaver::Start()
+{
+	fThread = spawn_thread(_SaveThread, "document saver",
+		B_NORMAL_PRIORITY, this);
+	if(fThread < 0)
+		return fThread;
+	return resume_thread(fThread);
+}
+
+
+/**
+ * Waits for the file to be written and returns the result.
+ */
+status_t
+DocumentSaver::Wait()
+{
+	if(fThread >= 0) {
+		status_t result;
+		wait_for_thread(fThread, &result);
+		fThread = -1;
+	}
+	return fStatus;
+}
+
+
+/* static */ status_t
+DocumentSaver::_SaveThread(void* data)
+{
+	DocumentSaver* self = static_cast<DocumentSaver*>(data);
+	self->fStatus = self->_Save();
+	BMessage finished(SAVER_FINISHED);
+	finished.AddInt32("status", self->fStatus);
+	finished.AddInt32("serial", self->fSerial);
+	self->fTarget.SendMessage(&finished);
+	return self->fStatus;
+}
+
+
+status_t
+DocumentSaver::_Save()
+{
+	std::unique_ptr<File> file;
+	AtomicFile* atomicFile = nullptr;
+	std::optional<BackupFileGuard> backupGuard;
+	if(fAtomic == true) {
+		atomicFile = new AtomicFile(fPath.c_str());
+		file.reset(atomicFile);
+		if(file->InitCheck() != B_OK) {
+			// e.g. the directory is not writable, overwrite in place instead
+			file.reset();
+			atomicFile = nullptr;
+		}
+	}
+	if(file == nullptr) {
+		backupGuard.emplace(fPath.c_str());
+		file = std::make_unique<File>(fPath.c_str(),
+			B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
+	}
+	status_t status = file->InitCheck();
+	if(status != B_OK)
+		return status;
+
+	const std::array<std::string_view, 2> spans = { fText, std::string_view() };
+	if((status = WriteText(file.get(), spans, fEncoding, fCompression,
+			&fFileHasher)) != B_OK)
+		return status;
+	if(atomicFile != nullptr && (status = atomicFile->Commit()) != B_OK)
+		return status;
+	if(backupGuard)
+		backupGuard->SaveSuccessful();
+
+	// chunking and hashing a big file takes a while, keep it off the window
+	if(fHistoryDirectory.InitCheck() == B_OK) {
+		const std::string_view text = fText;
+		LocalHistory(fHistoryDirectory).Record(fPath.c_str(),
+			std::span<const std::string_view>(&text, 1));
+	}
+	return B_OK;
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#ifndef DOCUMENTSAVER_H
+#define DOCUMENTSAVER_H
+
+
+#include <array>
+#include <string>
+#include <string_view>
+
+#include <Messenger.h>
+#include <OS.h>
+#include <Path.h>
+
+#include "Compression.h"
+#include "Encoding.h"
+#include "Hash.h"
+
+
+class File;
+
+
+enum {
+	SAVER_FINISHED		= 'svfn'
+};
+
+
+/**
+ * Writes the text given as spans in encoding, compressed if needed. UTF-8
+ * is written as is, other encodings are converted in chunks.
+ * The written bytes are fed to hasher, if given. With file set to nullptr
+ * nothing is written, only the hash is computed.
+ */
+status_t	WriteText(File* file, const std::array<std::string_view, 2>& spans,
+				TextEncoding encoding, Compression compression,
+				Hasher* hasher = nullptr);
+
+
+/**
+ * DocumentSaver writes a copy of the document to a file on a worker thread,
+ * so that a slow volume does not freeze the window. The copy is taken when
+ * the saver is created and the document can be edited while it is written.
+ * Completion is reported to the target as SAVER_FINISHED with a "status"
+ * int32 and the saver's Serial() as "serial", which tells it apart from
+ * a message left queued by an earlier saver. Wait() blocks until the file
+ * is written.
+ * With atomic set the file is written next to path and renamed over it,
+ * otherwise it is overwritten in place, with a backup kept until the end.
+ * Once written, the text is recorded in the local history in the directory
+ * given to SetHistoryDirectory(), if any, on the same thread.
+ */
+class DocumentSaver {
+public:
+						DocumentSaver(const char* path,
+							const std::array<std::string_view, 2>& spans,
+							BMessenger target,
+							TextEncoding encoding = TextEncoding::UTF8,
+							Compression compression = Compression::NONE,
+							bool atomic = true);
+						~DocumentSaver();
+
+	void				SetHistoryDirectory(const BPath& directory);
+	status_t			Start();
+	status_t			Wait();
+
+	int32				Serial() const { return fSerial; }
+	const char*			Path() const { return fPath.c_str(); }
+	// the file as written, valid after success
+	const Hasher&		FileHasher() const { return fFileHasher; }
+
+private:
+	static	status_t	_SaveThread(void* data);
+			status_t	_Save();
+
+	std::string			fPath;
+	std::string			fText;
+	BMessenger			fTarget;
+	TextEncoding		fEncoding;
+	Compression			fCompression;
+	bool				fAtomic;
+	int32				fSerial;
+	BPath				fHistoryDirectory;
+
+	Hasher				fFileHasher;
+	thread_id			fThread;
+	status_t			fStatus;
+};
+
+
+#endif // DOCUMENTSAVER_H
@@ -5,13 +5,18 @@
 
 #include "Editor.h"
 
+#include <Looper.h>
 #include <Messenger.h>
+#include <OS.h>
 
 #include <algorithm>
 #include <string>
+#include <string_view>
 
 #include "ScintillaUtils.h"
 #include "EditorStatusView.h"
+#include "RecoveryJournal.h"
+#include "Regex.h"
 
 
 #ifndef SC_MASK_HISTORY
@@ -22,9 +27,31 @@ namespace Sci = Scintilla;
 using namespace Sci::Properties;
 
 
+namespace {
+
+const char* kTrailingWhitespace = "[ \\t]+$";
+
+const uint32 kExtendOccurrences = 'exoc';
+// of text searched for occurrences at once in idle time
+const Sci_Position kOccurrencesChunk = 256 * 1024;
+// spent searching for occurrences before letting other messages through
+const bigtime_t kOccurrencesTimeSlice = 4000;
+// around the visible text, for occurrences which are partly visible
+const Sci_Position kVisibleMargin = 256;
+// read past the end of searched ranges for regex matches crossing it
+const Sci_Position kRegexLookahead = 4096;
+// longer selections and words are not highlighted
+const Sci_Position kMaxOccurrenceLength = 1024;
+
+}
+
+
 Editor::Editor()
 	:
 	BScintillaView("EditorView", B_FRAME_EVENTS, true, true, B_NO_BORDER),
+	fJournal(nullptr),
+	fChangeCount(0),
+	fFirstLineNumber(-1),
 	fCommentLineToken(""),
 	fCommentBlockStartToken(""),
 	fCommentBlockEndToken(""),
@@ -37,8 +64,19 @@ Editor::Editor()
 	fChangeMarginEnabled(false),
 	fBracesHighlightingEnabled(false),
 	fTrailingWSHighlightingEnabled(false),
+	fOccurrencesHighlightingEnabled(false),
+	fOccurrencesChangeCount(0),
+	fOccurrencesPending(false),
 	fType(""),
-	fReadOnly(false)
+	fEncoding(""),
+	fReadOnly(false),
+	fProgress(-1.0f),
+	fIndexing(false),
+	fMatchIndex(-1),
+	fMatchCount(-1),
+	fMatchesFinished(false),
+	fLargeFileMode(false),
+	fMixedEOL(false)
 {
 	fStatusView = new editor::StatusView(this);
 
@@ -101,6 +139,20 @@ Editor::FrameResized(float width, float height)
 }
 
 
+void
+Editor::MessageReceived(BMessage* message)
+{
+	switch(message->what) {
+		case kExtendOccurrences:
+			_ExtendOccurrences();
+		break;
+		default:
+			BScintillaView::MessageReceived(message);
+		break;
+	}
+}
+
+
 void
 Editor::NotificationReceived(SCNotification* notification)
 {
@@ -113,7 +165,23 @@ Editor::NotificationReceived(SCNotification* notification)
 			window_msg.SendMessage(EDITOR_SAVEPOINT_REACHED);
 		break;
 		case SCN_MODIFIED:
-			window_msg.SendMessage(EDITOR_MODIFIED);
+			if(notification->modificationType
+					& (SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT))
+				fChangeCount++;
+			// the inserted text is only available during the notification
+			if(fJournal != nullptr) {
+				if(notification->modificationType & SC_MOD_INSERTTEXT)
+					fJournal->Inserted(notification->position,
+						notification->text, notification->length);
+				else if(notification->modificationType & SC_MOD_DELETETEXT)
+					fJournal->Deleted(notification->position,
+						notification->length);
+			}
+			// occurrence highlighting fills indicators by the thousand,
+			// only text and bookmark changes concern the window
+			if(notification->modificationType
+					& (SC_MOD_INSERTTEXT | SC_MOD_DELETETEXT | SC_MOD_CHANGEMARKER))
+				window_msg.SendMessage(EDITOR_MODIFIED);
 		break;
 		case SCN_CHARADDED: {
 			char ch = static_cast<char>(notification->ch);
@@ -121,15 +189,23 @@ Editor::NotificationReceived(SCNotification* notification)
 		} break;
 		case SCN_UPDATEUI:
 			_BraceHighlight();
-			UpdateLineNumberWidth();
+			// line count changes only with content
+			if(notification->updated & SC_UPDATE_CONTENT)
+				UpdateLineNumberWidth();
 			_UpdateStatusView();
-			if(fTrailingWSHighlightingEnabled)
+			if(fTrailingWSHighlightingEnabled && !fLargeFileMode)
 				HighlightTrailingWhitespace();
+			if(fOccurrencesHighlightingEnabled)
+				_HighlightOccurrences();
 			window_msg.SendMessage(EDITOR_UPDATEUI);
 		break;
 		case SCN_MARGINCLICK:
 			_MarginClick(notification->margin, notification->position);
 		break;
+		case SCN_ZOOM:
+			// the width is measured in the zoomed font
+			UpdateLineNumberWidth();
+		break;
 	}
 }
 
@@ -150,7 +226,49 @@ Editor::SetType(std::string type)
 	fType = type;
 	_UpdateStatusView();
 
-	SendMessage(SCI_COLOURISE, 0, -1);
+	// large documents are styled lazily, as they are scrolled into view
+	if(fLargeFileMode == false)
+		SendMessage(SCI_COLOURISE, 0, -1);
+}
+
+
+void
+Editor::SetEncoding(std::string encoding)
+{
+	fEncoding = encoding;
+	_UpdateStatusView();
+}
+
+
+/**
+ * Sets the line endings used for new lines. mixed tells the status view that
+ * the text also has other line endings.
+ */
+void
+Editor::SetEOLMode(int eolMode, bool mixed)
+{
+	fMixedEOL = mixed;
+	SendMessage(SCI_SETEOLMODE, eolMode);
+	_UpdateStatusView();
+}
+
+
+/**
+ * Every insertion and deletion made to the document is recorded in journal,
+ * if it is started.
+ */
+void
+Editor::SetJournal(RecoveryJournal* journal)
+{
+	fJournal = journal;
+}
+
+
+void
+Editor::ConvertEOLs(int eolMode)
+{
+	SendMessage(SCI_CONVERTEOLS, eolMode);
+	SetEOLMode(eolMode);
 }
 
 
@@ -171,6 +289,133 @@ Editor::SetReadOnly(bool readOnly)
 }
 
 
+/**
+ * Shows progress (0-1) of a long running operation, like loading a big file,
+ * in the status view. Negative value hides it. Unlike loading, indexing the
+ * lines of a paged file can't be cancelled.
+ */
+void
+Editor::SetProgress(float progress, bool indexing)
+{
+	fProgress = progress;
+	fIndexing = indexing;
+	_UpdateStatusView();
+}
+
+
+/**
+ * Shows which of the count matches found by Find All is selected, -1 if none
+ * is, in the status view. Negative count hides it. finished tells whether
+ * more matches can still come.
+ */
+void
+Editor::SetMatchStatus(int64 index, int64 count, bool finished)
+{
+	if(index == fMatchIndex && count == fMatchCount
+			&& finished == fMatchesFinished)
+		return;
+	fMatchIndex = index;
+	fMatchCount = count;
+	fMatchesFinished = finished;
+	_UpdateStatusView();
+}
+
+
+/**
+ * In large file mode the document is styled lazily instead of all at once in
+ * SetType(), and change history and trailing whitespace highlighting stay off
+ * regardless of preferences. The mode is shown in the status view.
+ */
+void
+Editor::SetLargeFileMode(bool largeFile)
+{
+	fLargeFileMode = largeFile;
+	SetChangeMarginEnabled(fChangeMarginEnabled);
+	SetTrailingWSHighlightingEnabled(fTrailingWSHighlightingEnabled);
+	_UpdateStatusView();
+}
+
+
+/**
+ * When only a part of a file is loaded, lines are numbered from line instead
+ * of 1, both in the margin and in the status view. Pass -1 to go back to
+ * numbering the document. Has to be called again after the text changes.
+ */
+void
+Editor::SetFirstLineNumber(int64 line)
+{
+	fFirstLineNumber = line;
+	SendMessage(SCI_MARGINTEXTCLEARALL);
+	if(fFirstLineNumber < 0) {
+		SendMessage(SCI_SETMARGINTYPEN, Margin::NUMBER, SC_MARGIN_NUMBER);
+	} else {
+		// the number margin can't start from anything else than 1
+		SendMessage(SCI_SETMARGINTYPEN, Margin::NUMBER, SC_MARGIN_RTEXT);
+		const Sci_Position lineCount = SendMessage(SCI_GETLINECOUNT);
+		for(Sci_Position i = 0; i < lineCount; i++) {
+			const std::string number = std::to_string(fFirstLineNumber + i + 1);
+			SendMessage(SCI_MARGINSETTEXT, i, (sptr_t) number.c_str());
+			SendMessage(SCI_MARGINSETSTYLE, i, STYLE_LINENUMBER);
+		}
+	}
+	UpdateLineNumberWidth();
+	_UpdateStatusView();
+}
+
+
+/**
+ * Replaces the document with a new, empty one, created with options
+ * (SC_DOCUMENTOPTION_*). Does nothing if the current one already has them.
+ */
+void
+Editor::NewDocument(int options)
+{
+	if(SendMessage(SCI_GETDOCUMENTOPTIONS) == options)
+		return;
+	sptr_t document = SendMessage(SCI_CREATEDOCUMENT, 0, options);
+	SendMessage(SCI_SETDOCPOINTER, 0, document);
+	SendMessage(SCI_RELEASEDOCUMENT, 0, document);
+}
+
+
+/**
+ * Replaces the document with length bytes of text. Unlike SetText() it does
+ * not stop at NUL bytes, and the buffer is allocated once up front instead of
+ * growing while the text is inserted.
+ */
+void
+Editor::LoadText(const char* text, Sci_Position length)
+{
+	SendMessage(SCI_CLEARALL);
+	if(text == nullptr || length <= 0)
+		return;
+	SendMessage(SCI_ALLOCATE, length + 1);
+	SendMessage(SCI_APPENDTEXT, length, reinterpret_cast<sptr_t>(text));
+}
+
+
+/**
+ * Returns the document as at most two spans of memory, the text before and
+ * after the gap in Scintilla's buffer. Neither the gap is moved nor the text
+ * copied. Spans are valid until the document is modified.
+ */
+std::array<std::string_view, 2>
+Editor::TextSpans()
+{
+	const Sci_Position length = SendMessage(SCI_GETLENGTH);
+	const Sci_Position gap = std::min<Sci_Position>(
+		SendMessage(SCI_GETGAPPOSITION), length);
+	const auto span = [this](Sci_Position start, Sci_Position spanLength) {
+		if(spanLength <= 0)
+			return std::string_view();
+		const char* data = reinterpret_cast<const char*>(
+			SendMessage(SCI_GETRANGEPOINTER, start, spanLength));
+		return std::string_view(data, spanLength);
+	};
+	return { span(0, gap), span(gap, length - gap) };
+}
+
+
 void
 Editor::CommentLine(Scintilla::Range range)
 {
@@ -314,26 +559,28 @@ Editor::ClearHighlightedWhitespace()
 }
 
 
+/**
+ * Whitespace is collected first and removed from the end, so that positions
+ * of the remaining matches stay valid.
+ */
 void
 Editor::TrimTrailingWhitespace()
 {
-	Sci::Guard<SearchTarget, SearchFlags> guard(this);
-
-	Sci_Position length = SendMessage(SCI_GETLENGTH, 0, 0);
-	Set<SearchTarget>({0, length});
-	Set<SearchFlags>(SCFIND_REGEXP | SCFIND_CXX11REGEX);
+	const std::string_view text(
+		reinterpret_cast<const char*>(SendMessage(SCI_GETCHARACTERPOINTER)),
+		SendMessage(SCI_GETLENGTH));
+	const auto whitespace = Regex::Compile(kTrailingWhitespace);
+	std::vector<std::pair<size_t, size_t>> ranges;
+	RegexMatch match;
+	size_t start = 0;
+	while(whitespace->Search(text, start, text.size(), match) == true) {
+		ranges.push_back(match.groups[0]);
+		start = match.End();
+	}
 
 	Sci::UndoAction action(this);
-	const std::string whitespace = "\\s+$";
-	int result;
-	do {
-		result = SendMessage(SCI_SEARCHINTARGET, whitespace.size(), (sptr_t) whitespace.c_str());
-		if(result != -1) {
-			SendMessage(SCI_REPLACETARGET, -1, (sptr_t) "");
-
-			Set<SearchTarget>({Get<SearchTargetEnd>(), length});
-		}
-	} while(result != -1);
+	for(auto it = ranges.rbegin(); it != ranges.rend(); it++)
+		SendMessage(SCI_DELETERANGE, it->first, it->second - it->first);
 }
 
 
@@ -394,17 +641,11 @@ Editor::ToggleBookmark(int64 line)
 
 
 void
-Editor::SetBookmarks(const BMessage &lines)
+Editor::SetBookmarks(const std::vector<int64>& lines)
 {
 	SendMessage(SCI_MARKERDELETEALL, (1 << Marker::BOOKMARK));
-	type_code type;
-	int32 count;
-	if(lines.GetInfo("line", &type, &count) == B_OK) {
-		for(int32 i = 0; i < count; i++) {
-			int64 line = lines.GetInt64("line", i, -1);
-			SendMessage(SCI_MARKERADD, line, Marker::BOOKMARK);
-		}
-	}
+	for(int64 line : lines)
+		SendMessage(SCI_MARKERADD, line, Marker::BOOKMARK);
 }
 
 
@@ -438,11 +679,32 @@ Editor::SetBookmarksFromSearch(const BMessage &searchMessage)
 		finish = SendMessage(SCI_GETCURRENTPOS);
 	}
 
+	if(regex == true) {
+		const auto compiled = Regex::Compile(search,
+			(wholeWord == true ? Regex::WHOLE_WORD : 0)
+				| (matchCase == true ? 0 : Regex::IGNORE_CASE));
+		if(compiled == nullptr)
+			return;
+		const std::string_view text(
+			reinterpret_cast<const char*>(SendMessage(SCI_GETCHARACTERPOINTER)),
+			SendMessage(SCI_GETLENGTH));
+		RegexMatch match;
+		size_t position = start;
+		while(position <= static_cast<size_t>(finish)
+				&& compiled->Search(text, position, finish, match) == true) {
+			int64 line = SendMessage(SCI_LINEFROMPOSITION, match.Start());
+			SendMessage(SCI_MARKERADD, line, Marker::BOOKMARK);
+			// the rest of the line would only add the same bookmark
+			position = std::max(match.End(),
+				static_cast<size_t>(SendMessage(SCI_GETLINEENDPOSITION, line)) + 1);
+		}
+		return;
+	}
+
 	Set<SearchTarget>({start, finish});
 
 	Set<SearchFlags>((wholeWord == true ? SCFIND_WHOLEWORD : 0)
-						| (matchCase == true ? SCFIND_MATCHCASE : 0)
-						| (regex == true ? (SCFIND_REGEXP | SCFIND_CXX11REGEX) : 0));
+						| (matchCase == true ? SCFIND_MATCHCASE : 0));
 
 	int result;
 	do {
@@ -457,15 +719,45 @@ Editor::SetBookmarksFromSearch(const BMessage &searchMessage)
 }
 
 
-BMessage
+std::vector<int64>
 Editor::Bookmarks()
 {
-	int64 line = 0;
-	BMessage lines;
+	std::vector<int64> lines;
+	int64 line = SendMessage(SCI_MARKERNEXT, 0, (1 << Marker::BOOKMARK));
 	while(line != -1) {
+		lines.push_back(line);
 		line = SendMessage(SCI_MARKERNEXT, line + 1, (1 << Marker::BOOKMARK));
-		if(line != -1)
-			lines.AddInt64("line", line);
+	}
+	return lines;
+}
+
+
+/**
+ * Collapses folds whose header lines are given. Fold levels come from the
+ * lexer, so the text up to the last of them is styled first.
+ */
+void
+Editor::SetFolds(const std::vector<int64>& lines)
+{
+	if(lines.empty())
+		return;
+	SendMessage(SCI_COLOURISE, 0,
+		SendMessage(SCI_GETLINEENDPOSITION, lines.back()));
+	for(int64 line : lines) {
+		if(SendMessage(SCI_GETFOLDLEVEL, line) & SC_FOLDLEVELHEADERFLAG)
+			SendMessage(SCI_FOLDLINE, line, SC_FOLDACTION_CONTRACT);
+	}
+}
+
+
+std::vector<int64>
+Editor::Folds()
+{
+	std::vector<int64> lines;
+	int64 line = SendMessage(SCI_CONTRACTEDFOLDNEXT, 0);
+	while(line != -1) {
+		lines.push_back(line);
+		line = SendMessage(SCI_CONTRACTEDFOLDNEXT, line + 1);
 	}
 	return lines;
 }
@@ -557,6 +849,11 @@ void
 Editor::SetChangeMarginEnabled(bool enabled)
 {
 	fChangeMarginEnabled = enabled;
+	if(fLargeFileMode) {
+		SendMessage(SCI_SETMARGINWIDTHN, Margin::CHANGES, 0);
+		SendMessage(SCI_SETCHANGEHISTORY, SC_CHANGE_HISTORY_DISABLED);
+		return;
+	}
 	SendMessage(SCI_SETMARGINWIDTHN, Margin::CHANGES, enabled ? 2 : 0);
 	// toggle the flag so it doesn't switch to indicator mode when the margin width is 0
 	SendMessage(SCI_SETCHANGEHISTORY, SC_CHANGE_HISTORY_ENABLED | (enabled ? SC_CHANGE_HISTORY_MARKERS : 0));
@@ -575,7 +872,7 @@ void
 Editor::SetTrailingWSHighlightingEnabled(bool enabled)
 {
 	fTrailingWSHighlightingEnabled = enabled;
-	if(enabled) {
+	if(enabled && !fLargeFileMode) {
 		HighlightTrailingWhitespace();
 	} else {
 		ClearHighlightedWhitespace();
@@ -584,6 +881,37 @@ Editor::SetTrailingWSHighlightingEnabled(bool enabled)
 }
 
 
+void
+Editor::SetOccurrencesHighlightingEnabled(bool enabled)
+{
+	fOccurrencesHighlightingEnabled = enabled;
+	if(enabled)
+		_HighlightOccurrences();
+	else
+		_ClearOccurrences();
+}
+
+
+/**
+ * Occurrences of term are highlighted while one of them is selected, as it is
+ * after finding it.
+ */
+void
+Editor::SetSearchTerm(const std::string& term, bool matchCase, bool matchWord,
+	bool regex)
+{
+	OccurrenceTerm searchTerm{ term, matchCase, matchWord, regex };
+	if(searchTerm == fSearchTerm)
+		return;
+	fSearchTerm = searchTerm;
+	fSearchTermSearch.reset();
+	if(!term.empty()) {
+		fSearchTermSearch = std::make_unique<TextSearch>(term, matchCase,
+			matchWord, regex);
+	}
+}
+
+
 std::string
 Editor::SelectionText()
 {
@@ -629,7 +957,8 @@ void
 Editor::UpdateLineNumberWidth()
 {
 	if(fNumberMarginEnabled) {
-		int numLines = SendMessage(SCI_GETLINECOUNT);
+		int64 numLines = SendMessage(SCI_GETLINECOUNT)
+			+ std::max<int64>(fFirstLineNumber, 0);
 		int i = 0;
 		for(; numLines > 0; numLines /= 10, ++i);
 		int charWidth = SendMessage(SCI_TEXTWIDTH, STYLE_LINENUMBER, (sptr_t) "0") + 2;
@@ -645,13 +974,31 @@ void
 Editor::_UpdateStatusView()
 {
 	Sci_Position pos = SendMessage(SCI_GETCURRENTPOS, 0, 0);
-	int line = SendMessage(SCI_LINEFROMPOSITION, pos, 0);
+	int64 line = SendMessage(SCI_LINEFROMPOSITION, pos, 0)
+		+ std::max<int64>(fFirstLineNumber, 0);
 	int column = SendMessage(SCI_GETCOLUMN, pos, 0);
 	BMessage update(editor::StatusView::UPDATE_STATUS);
 	update.AddInt32("line", line + 1);
 	update.AddInt32("column", column + 1);
 	update.AddString("type", fType.c_str());
+	update.AddString("encoding", fEncoding.c_str());
+	switch(SendMessage(SCI_GETEOLMODE)) {
+		case SC_EOL_CRLF:	update.AddString("eol", "CRLF"); break;
+		case SC_EOL_CR:		update.AddString("eol", "CR"); break;
+		default:			update.AddString("eol", "LF"); break;
+	}
+	update.AddBool("mixedEOL", fMixedEOL);
 	update.AddBool("readOnly", fReadOnly);
+	update.AddBool("largeFile", fLargeFileMode);
+	if(fMatchCount >= 0) {
+		update.AddInt64("matchIndex", fMatchIndex);
+		update.AddInt64("matchCount", fMatchCount);
+		update.AddBool("matchesFinished", fMatchesFinished);
+	}
+	if(fProgress >= 0.0f) {
+		update.AddFloat("progress", fProgress);
+		update.AddBool("indexing", fIndexing);
+	}
 	fStatusView->SetStatus(&update);
 }
 
@@ -722,10 +1069,7 @@ Editor::_HighlightTrailingWhitespace(Sci_Position start, Sci_Position end)
 		return;
 	}
 
-	Sci::Guard<SearchTarget, SearchFlags, CurrentIndicator> guard(this);
-
-	Set<SearchTarget>({start, end});
-	Set<SearchFlags>(SCFIND_REGEXP | SCFIND_CXX11REGEX);
+	Sci::Guard<CurrentIndicator> guard(this);
 
 	Set<CurrentIndicator>(Indicator::WHITESPACE);
 
@@ -733,18 +1077,20 @@ Editor::_HighlightTrailingWhitespace(Sci_Position start, Sci_Position end)
 	SendMessage(SCI_INDICATORCLEARRANGE, fHighlightedWhitespaceStart,
 		fHighlightedWhitespaceEnd - fHighlightedWhitespaceStart);
 
-	const std::string whitespace = "\\s+$";
-	int result;
-	do {
-		result = SendMessage(SCI_SEARCHINTARGET, whitespace.size(), (sptr_t) whitespace.c_str());
-		if(result != -1) {
-			auto found = Get<SearchTarget>();
-
-			SendMessage(SCI_INDICATORFILLRANGE, found.first, found.second - found.first);
-
-			Set<SearchTarget>({found.second + 1, end});
-		}
-	} while(result != -1);
+	// one character more, to tell whether the range ends at a line end
+	const Sci_Position rangeEnd = std::min<Sci_Position>(end + 1,
+		SendMessage(SCI_GETLENGTH));
+	const std::string_view text(
+		reinterpret_cast<const char*>(SendMessage(SCI_GETRANGEPOINTER, start,
+			rangeEnd - start)), rangeEnd - start);
+	const auto whitespace = Regex::Compile(kTrailingWhitespace);
+	RegexMatch match;
+	size_t position = 0;
+	while(whitespace->Search(text, position, end - start, match) == true) {
+		SendMessage(SCI_INDICATORFILLRANGE, start + match.Start(),
+			match.End() - match.Start());
+		position = match.End();
+	}
 
 	fHighlightedWhitespaceStart = start;
 	fHighlightedWhitespaceEnd = end;
@@ -752,6 +1098,219 @@ Editor::_HighlightTrailingWhitespace(Sci_Position start, Sci_Position end)
 }
 
 
+/**
+ * Highlights occurrences of the term picked by _OccurrenceTerm() in the
+ * visible text right away, the rest of the text is left to
+ * _ExtendOccurrences(). Searched ranges are remembered until the term or the
+ * text changes, so scrolling back and forth doesn't search them again.
+ */
+void
+Editor::_HighlightOccurrences()
+{
+	OccurrenceTerm term;
+	if(_OccurrenceTerm(term) == false) {
+		_ClearOccurrences();
+		return;
+	}
+	if(term != fOccurrenceTerm || fOccurrenceSearch == nullptr) {
+		_ClearOccurrences();
+		fOccurrenceTerm = term;
+		fOccurrenceSearch = std::make_unique<TextSearch>(term.text,
+			term.matchCase, term.matchWord, term.regex);
+		if(fOccurrenceSearch->IsValid() == false) {
+			fOccurrenceSearch.reset();
+			return;
+		}
+	} else if(fOccurrencesChangeCount != fChangeCount) {
+		// positions found so far are of the text before the change
+		_ClearOccurrences();
+	}
+	fOccurrencesChangeCount = fChangeCount;
+
+	Sci_Position start, end;
+	_VisibleRange(start, end);
+	for(const auto& gap : fOccurrencesSearched.Gaps(start, end))
+		_FindOccurrences(gap.first, gap.second);
+
+	if(fOccurrencesPending == false && Looper() != nullptr
+			&& fOccurrencesSearched.Contains(0, SendMessage(SCI_GETLENGTH)) == false) {
+		fOccurrencesPending = true;
+		Looper()->PostMessage(kExtendOccurrences, this);
+	}
+}
+
+
+/**
+ * Picks the term to highlight: the search term if one of its matches is
+ * selected, the selected text if it doesn't span lines, or the word the caret
+ * is in if nothing is selected.
+ */
+bool
+Editor::_OccurrenceTerm(OccurrenceTerm& term)
+{
+	if(SendMessage(SCI_GETSELECTIONS) > 1)
+		return false;
+	const Sci_Position start = SendMessage(SCI_GETSELECTIONSTART);
+	const Sci_Position end = SendMessage(SCI_GETSELECTIONEND);
+	const auto text = [this](Sci_Position from, Sci_Position to) {
+		return std::string_view(reinterpret_cast<const char*>(
+			SendMessage(SCI_GETRANGEPOINTER, from, to - from)), to - from);
+	};
+	if(start == end) {
+		const Sci_Position wordStart = SendMessage(SCI_WORDSTARTPOSITION, start,
+			true);
+		const Sci_Position wordEnd = SendMessage(SCI_WORDENDPOSITION, start, true);
+		if(wordStart == wordEnd || wordEnd - wordStart > kMaxOccurrenceLength)
+			return false;
+		term = { std::string(text(wordStart, wordEnd)), true, true, false };
+		return true;
+	}
+	if(end - start > kMaxOccurrenceLength)
+		return false;
+
+	if(fSearchTermSearch != nullptr) {
+		// with the characters around, for ^, $ and word boundaries
+		const Sci_Position textStart = _CharacterStart(
+			std::max<Sci_Position>(start - 4, 0));
+		const Sci_Position textEnd = _CharacterStart(
+			std::min<Sci_Position>(end + 4, SendMessage(SCI_GETLENGTH)));
+		size_t matchStart, matchEnd;
+		if(fSearchTermSearch->Find(text(textStart, textEnd), start - textStart,
+				end - textStart, matchStart, matchEnd) == true
+				&& matchStart == size_t(start - textStart)
+				&& matchEnd == size_t(end - textStart)) {
+			term = fSearchTerm;
+			return true;
+		}
+	}
+	if(SendMessage(SCI_LINEFROMPOSITION, start)
+			!= SendMessage(SCI_LINEFROMPOSITION, end))
+		return false;
+	term = { std::string(text(start, end)), true, false, false };
+	return true;
+}
+
+
+void
+Editor::_VisibleRange(Sci_Position& start, Sci_Position& end)
+{
+	const Sci_Position length = SendMessage(SCI_GETLENGTH);
+	const BRect bounds = Bounds();
+	start = SendMessage(SCI_POSITIONFROMPOINT, 0, 0);
+	end = SendMessage(SCI_POSITIONFROMPOINT, bounds.IntegerWidth(),
+		bounds.IntegerHeight());
+	start = _CharacterStart(std::max<Sci_Position>(start - kVisibleMargin, 0));
+	end = _CharacterStart(std::min(end + kVisibleMargin, length));
+}
+
+
+/**
+ * Returns the start of the character position is in.
+ */
+Sci_Position
+Editor::_CharacterStart(Sci_Position position)
+{
+	if(position <= 0 || position >= SendMessage(SCI_GETLENGTH))
+		return position;
+	return SendMessage(SCI_POSITIONBEFORE, position + 1);
+}
+
+
+/**
+ * Highlights occurrences which start between start and end. The text is read
+ * a bit further, so that the ones crossing end are found whole.
+ */
+void
+Editor::_FindOccurrences(Sci_Position start, Sci_Position end)
+{
+	const Sci_Position length = SendMessage(SCI_GETLENGTH);
+	// folding case can change the length of an occurrence a little
+	const Sci_Position lookahead = fOccurrenceTerm.regex ? kRegexLookahead
+		: fOccurrenceTerm.text.size() * 2 + 4;
+	const Sci_Position textStart = _CharacterStart(
+		std::max<Sci_Position>(start - 4, 0));
+	const Sci_Position textEnd = _CharacterStart(
+		std::min(end + lookahead, length));
+	const std::string_view text(
+		reinterpret_cast<const char*>(SendMessage(SCI_GETRANGEPOINTER,
+			textStart, textEnd - textStart)), textEnd - textStart);
+
+	Sci::Guard<CurrentIndicator> guard(this);
+	Set<CurrentIndicator>(Indicator::OCCURRENCE);
+
+	const size_t rangeEnd = end - textStart;
+	size_t position = start - textStart;
+	size_t matchStart, matchEnd;
+	while(position < rangeEnd && fOccurrenceSearch->Find(text, position,
+			text.size(), matchStart, matchEnd) == true && matchStart < rangeEnd) {
+		if(matchEnd > matchStart) {
+			SendMessage(SCI_INDICATORFILLRANGE, textStart + matchStart,
+				matchEnd - matchStart);
+			position = matchEnd;
+		} else {
+			// skip a whole character past an empty match
+			position = matchStart + 1;
+			while(position < text.size() && (text[position] & 0xC0) == 0x80)
+				position++;
+		}
+	}
+	fOccurrencesSearched.Add(start, end);
+}
+
+
+/**
+ * Searches the text which is not visible for occurrences, a chunk at a time
+ * for a short while before giving way to other messages, first after the
+ * visible text, then before it.
+ */
+void
+Editor::_ExtendOccurrences()
+{
+	fOccurrencesPending = false;
+	if(fOccurrencesHighlightingEnabled == false || fOccurrenceSearch == nullptr
+			|| fOccurrencesChangeCount != fChangeCount
+			|| fOccurrencesSearched.IsEmpty())
+		return;
+
+	const Sci_Position length = SendMessage(SCI_GETLENGTH);
+	Sci_Position visibleStart, visibleEnd;
+	_VisibleRange(visibleStart, visibleEnd);
+	const bigtime_t deadline = system_time() + kOccurrencesTimeSlice;
+	do {
+		auto gaps = fOccurrencesSearched.Gaps(visibleEnd, length);
+		if(!gaps.empty()) {
+			const Sci_Position start = gaps.front().first;
+			_FindOccurrences(start, _CharacterStart(
+				std::min<Sci_Position>(gaps.front().second,
+					start + kOccurrencesChunk)));
+			continue;
+		}
+		gaps = fOccurrencesSearched.Gaps(0, visibleStart);
+		if(gaps.empty())
+			return;
+		const Sci_Position end = gaps.back().second;
+		_FindOccurrences(_CharacterStart(std::max<Sci_Position>(
+			gaps.back().first, end - kOccurrencesChunk)), end);
+	} while(system_time() < deadline);
+
+	fOccurrencesPending = true;
+	Looper()->PostMessage(kExtendOccurrences, this);
+}
+
+
+void
+Editor::_ClearOccurrences()
+{
+	if(fOccurrencesSearched.IsEmpty())
+		return;
+
+	Sci::Guard<CurrentIndicator> guard(this);
+	Set<CurrentIndicator>(Indicator::OCCURRENCE);
+	SendMessage(SCI_INDICATORCLEARRANGE, 0, SendMessage(SCI_GETLENGTH));
+	fOccurrencesSearched.Clear();
+}
+
+
 std::string
 Editor::_LineFeedString(int eolMode)
 {
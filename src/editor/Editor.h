@@ -12,16 +12,21 @@
 #include <ScintillaView.h>
 #include <SciLexer.h>
 
+#include <array>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "RangeSet.h"
 #include "ScintillaUtils.h"
+#include "TextSearch.h"
 
 
 namespace editor {
 	class StatusView;
 }
+class RecoveryJournal;
 
 
 enum {
@@ -45,13 +50,15 @@ public:
 		BOOKMARK	= 0
 	};
 	enum Indicator {
-		WHITESPACE	= 0
+		WHITESPACE	= 0,
+		OCCURRENCE	= 1
 	};
 
 						Editor();
 
 	virtual	void		DoLayout();
 	virtual	void		FrameResized(float width, float height);
+	virtual	void		MessageReceived(BMessage* message);
 
 	void				NotificationReceived(SCNotification* notification);
 	void				ContextMenu(BPoint point);
@@ -59,6 +66,24 @@ public:
 	void				SetType(std::string type);
 	void				SetRef(const entry_ref& ref);
 	void				SetReadOnly(bool readOnly);
+	void				SetProgress(float progress, bool indexing = false);
+	void				SetMatchStatus(int64 index, int64 count, bool finished);
+	void				SetLargeFileMode(bool largeFile);
+	void				SetEncoding(std::string encoding);
+	void				SetEOLMode(int eolMode, bool mixed = false);
+	void				SetJournal(RecoveryJournal* journal);
+	void				SetFirstLineNumber(int64 line);
+	void				ConvertEOLs(int eolMode);
+	bool				LargeFileMode() const { return fLargeFileMode; }
+	// number of the first line of a file shown in part, -1 if shown whole
+	int64				FirstLineNumber() const { return fFirstLineNumber; }
+	// number of insertions and deletions so far, to tell if text has changed
+	uint64				ChangeCount() const { return fChangeCount; }
+
+	void				NewDocument(int options);
+
+	void				LoadText(const char* text, Sci_Position length);
+	std::array<std::string_view, 2>	TextSpans();
 
 	void				CommentLine(Scintilla::Range range);
 	void				CommentBlock(Scintilla::Range range);
@@ -79,21 +104,27 @@ public:
 
 	void				GoToLine(int64 line);
 
-	void				SetBookmarks(const BMessage &lines);
+	void				SetBookmarks(const std::vector<int64>& lines);
 	void				SetBookmarksFromSearch(const BMessage &searchMessage);
-	BMessage			Bookmarks();
+	std::vector<int64>	Bookmarks();
 	BMessage			BookmarksWithText();
 
 	bool				ToggleBookmark(int64 line = -1);
 	void				GoToNextBookmark();
 	void				GoToPreviousBookmark();
 
+	void				SetFolds(const std::vector<int64>& lines);
+	std::vector<int64>	Folds();
+
 	void				SetNumberMarginEnabled(bool enabled);
 	void				SetFoldMarginEnabled(bool enabled);
 	void				SetBookmarkMarginEnabled(bool enabled);
 	void				SetChangeMarginEnabled(bool enabled);
 	void				SetBracesHighlightingEnabled(bool enabled);
 	void				SetTrailingWSHighlightingEnabled(bool enabled);
+	void				SetOccurrencesHighlightingEnabled(bool enabled);
+	void				SetSearchTerm(const std::string& term, bool matchCase,
+							bool matchWord, bool regex);
 
 	std::string			SelectionText();
 
@@ -103,6 +134,15 @@ public:
 	void				Set(typename T::type value) { T::Set(this, value); }
 
 private:
+	struct OccurrenceTerm {
+		std::string		text;
+		bool			matchCase = true;
+		bool			matchWord = false;
+		bool			regex = false;
+
+		bool			operator==(const OccurrenceTerm& other) const = default;
+	};
+
 	void				_MaintainIndentation(char ch);
 	void				_UpdateStatusView();
 	void				_BraceHighlight();
@@ -110,10 +150,20 @@ private:
 	void				_MarginClick(int margin, int pos);
 	void				_HighlightTrailingWhitespace(Sci_Position start, Sci_Position end);
 	std::string			_LineFeedString(int eolMode);
+	void				_HighlightOccurrences();
+	bool				_OccurrenceTerm(OccurrenceTerm& term);
+	void				_VisibleRange(Sci_Position& start, Sci_Position& end);
+	Sci_Position		_CharacterStart(Sci_Position position);
+	void				_FindOccurrences(Sci_Position start, Sci_Position end);
+	void				_ExtendOccurrences();
+	void				_ClearOccurrences();
 
 	void				_SetLineIndentation(int line, int indent);
 
 	editor::StatusView*	fStatusView;
+	RecoveryJournal*	fJournal;
+	uint64				fChangeCount;
+	int64				fFirstLineNumber;
 
 	std::string			fCommentLineToken;
 	std::string			fCommentBlockStartToken;
@@ -129,10 +179,30 @@ private:
 	bool				fChangeMarginEnabled;
 	bool				fBracesHighlightingEnabled;
 	bool				fTrailingWSHighlightingEnabled;
+	bool				fOccurrencesHighlightingEnabled;
+
+	// last term searched for in the Find window
+	OccurrenceTerm		fSearchTerm;
+	std::unique_ptr<TextSearch>	fSearchTermSearch;
+	// highlighted term, ranges of the text at fOccurrencesChangeCount
+	// searched for it so far
+	OccurrenceTerm		fOccurrenceTerm;
+	std::unique_ptr<TextSearch>	fOccurrenceSearch;
+	uint64				fOccurrencesChangeCount;
+	RangeSet			fOccurrencesSearched;
+	bool				fOccurrencesPending;
 
 	// needed for StatusView
 	std::string			fType;
+	std::string			fEncoding;
 	bool				fReadOnly;
+	float				fProgress;
+	bool				fIndexing;
+	int64				fMatchIndex;
+	int64				fMatchCount;
+	bool				fMatchesFinished;
+	bool				fLargeFileMode;
+	bool				fMixedEOL;
 };
 
 
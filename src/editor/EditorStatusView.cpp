@@ -25,6 +25,7 @@
 #include <MenuItem.h>
 #include <Message.h>
 #include <Messenger.h>
+#include <NumberFormat.h>
 #include <PopUpMenu.h>
 #include <ScrollView.h>
 #include <StringView.h>
@@ -47,6 +48,7 @@ StatusView::StatusView(BScrollView* scrollView)
 			:
 			controls::StatusView(scrollView),
 			fReadOnly(false),
+			fIndexing(false),
 			fNavigationPressed(false),
 			fNavigationButtonWidth(scrollView->ScrollBar(B_HORIZONTAL)->Frame().Height())
 {
@@ -153,10 +155,24 @@ StatusView::MouseDown(BPoint where)
 		msgr.SendMessage(MAINMENU_SEARCH_GOTOLINE);
 	}
 
+	// only loading can be cancelled
+	if (!fCellText[kProgressCell].IsEmpty() && !fIndexing) {
+		float left = fNavigationButtonWidth;
+		for (size_t i = 0; i < kProgressCell; i++)
+			left += fCellWidth[i];
+		if (where.x >= left && where.x < left + fCellWidth[kProgressCell]) {
+			BMessenger msgr(Window());
+			msgr.SendMessage(FILE_LOAD_CANCEL);
+			return;
+		}
+	}
+
 	if (!fReadOnly)
 		return;
 
-	float left = fNavigationButtonWidth + fCellWidth[kPositionCell] + fCellWidth[kTypeCell];
+	float left = fNavigationButtonWidth + fCellWidth[kPositionCell]
+		+ fCellWidth[kTypeCell] + fCellWidth[kEncodingCell]
+		+ fCellWidth[kEOLCell];
 	if (where.x < left)
 		return;
 
@@ -202,12 +218,60 @@ StatusView::SetStatus(BMessage* message)
 		fCellText[kTypeCell] = fType;
 	}
 
+	const char* encoding;
+	if (message->FindString("encoding", &encoding) == B_OK)
+		fCellText[kEncodingCell] = encoding;
+
+	const char* eol;
+	if (message->FindString("eol", &eol) == B_OK) {
+		if (message->GetBool("mixedEOL", false))
+			fCellText[kEOLCell].SetToFormat(B_TRANSLATE("%s (mixed)"), eol);
+		else
+			fCellText[kEOLCell] = eol;
+	}
+
 	fReadOnly = false;
 	if (message->FindBool("readOnly", &fReadOnly) == B_OK && fReadOnly) {
 		fCellText[kFileStateCell] = B_TRANSLATE("Read-only");
 	} else
 		fCellText[kFileStateCell].Truncate(0);
 
+	bool largeFile;
+	if (message->FindBool("largeFile", &largeFile) == B_OK && largeFile)
+		fCellText[kModeCell] = B_TRANSLATE("Large file");
+	else
+		fCellText[kModeCell].Truncate(0);
+
+	int64 matchCount;
+	if (message->FindInt64("matchCount", &matchCount) == B_OK) {
+		BNumberFormat numberFormat;
+		BString count;
+		numberFormat.Format(count, matchCount);
+		int64 matchIndex = message->GetInt64("matchIndex", -1);
+		if (matchIndex >= 0) {
+			BString index;
+			numberFormat.Format(index, matchIndex + 1);
+			fCellText[kMatchCell].SetToFormat(B_TRANSLATE("Match %s of %s"),
+				index.String(), count.String());
+		} else {
+			fCellText[kMatchCell].SetToFormat(B_TRANSLATE("%s matches"),
+				count.String());
+		}
+		if (message->GetBool("matchesFinished", true) == false)
+			fCellText[kMatchCell] << B_UTF8_ELLIPSIS;
+	} else
+		fCellText[kMatchCell].Truncate(0);
+
+	float progress;
+	fIndexing = message->GetBool("indexing", false);
+	if (message->FindFloat("progress", &progress) == B_OK) {
+		fCellText[kProgressCell].SetToFormat(fIndexing
+				? B_TRANSLATE("Indexing lines %d%%")
+				: B_TRANSLATE("Loading %d%% (click to cancel)"),
+			static_cast<int>(progress * 100));
+	} else
+		fCellText[kProgressCell].Truncate(0);
+
 	Invalidate();
 }
 
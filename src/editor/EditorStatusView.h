@@ -54,12 +54,18 @@ private:
 	enum {
 		kPositionCell,
 		kTypeCell,
+		kEncodingCell,
+		kEOLCell,
 		kFileStateCell,
+		kModeCell,
+		kMatchCell,
+		kProgressCell,
 		kStatusCellCount
 	};
 			BString			fCellText[kStatusCellCount];
 			float			fCellWidth[kStatusCellCount];
 			bool			fReadOnly;
+			bool			fIndexing;
 			bool			fNavigationPressed;
 			BString			fType;
 			entry_ref		fRef;
@@ -5,41 +5,59 @@
 
 #include "EditorWindow.h"
 
+#include <algorithm>
+#include <cstring>
 #include <string>
+#include <vector>
 
 #include <Alert.h>
 #include <Application.h>
 #include <Bitmap.h>
 #include <Button.h>
 #include <Catalog.h>
+#include <DateTimeFormat.h>
 #include <Entry.h>
 #include <FilePanel.h>
 #include <GroupLayout.h>
 #include <LayoutBuilder.h>
 #include <MenuBar.h>
+#include <MessageRunner.h>
 #include <MimeType.h>
 #include <NodeMonitor.h>
 #include <ObjectList.h>
 #include <Path.h>
 #include <PopUpMenu.h>
 #include <Roster.h>
+#include <ScrollView.h>
 #include <String.h>
+#include <StringForSize.h>
 #include <StringFormat.h>
 #include <ToolBar.h>
 #include <Url.h>
+#include <Volume.h>
 #include <kernel/fs_attr.h>
+#include <sys/stat.h>
 
 #include "App.h"
 #include "AppPreferencesWindow.h"
 #include "BookmarksWindow.h"
 #include "Editor.h"
+#include "DocumentLoader.h"
+#include "DocumentSaver.h"
 #include "Editorconfig.h"
 #include "File.h"
+#include "FileState.h"
 #include "FindReplaceHandler.h"
+#include "FindResultsWindow.h"
 #include "FindWindow.h"
 #include "GoToLineWindow.h"
+#include "HexView.h"
 #include "IconMenuItem.h"
 #include "Languages.h"
+#include "LineDiff.h"
+#include "LineIndexer.h"
+#include "LocalHistory.h"
+#include "MatchFinder.h"
 #include "Preferences.h"
 #include "ScintillaUtils.h"
 #include "StatusView.h"
@@ -56,6 +74,22 @@ using namespace Scintilla::Properties;
 
 
 const float kWindowStagger = 17.0f;
+const off_t kBackgroundLoadSize = 32 * 1024 * 1024;
+const size_t kBackgroundLoadPreviewSize = 64 * 1024;
+// compressed text, logs especially, is often this many times larger
+const off_t kCompressionRatioEstimate = 10;
+const bigtime_t kJournalSyncInterval = 5000000;
+// stat changes arriving within this time are handled once
+const bigtime_t kStatChangedDelay = 250000;
+const uint32 kWatchedStatFields = B_STAT_MODE | B_STAT_SIZE
+	| B_STAT_MODIFICATION_TIME;
+// files at least this big, or a quarter of memory if more, are paged
+const off_t kPagedViewMinSize = 1024 * 1024 * 1024;
+const uint64 kPageSize = 4 * 1024 * 1024;
+// longer lines are cut at page boundaries
+const uint64 kMaxPagedLineLength = 64 * 1024;
+// bigger files are taken as changed rather than hashed on the window thread
+const off_t kMaxHashedFileSize = 16 * 1024 * 1024;
 
 
 Preferences* EditorWindow::fPreferences = nullptr;
@@ -63,20 +97,41 @@ Preferences* EditorWindow::fPreferences = nullptr;
 
 EditorWindow::EditorWindow(bool stagger)
 	:
-	BWindow(fPreferences->fWindowRect, gAppName, B_DOCUMENT_WINDOW, 0)
+	BWindow(fPreferences->fWindowRect, gAppName, B_DOCUMENT_WINDOW, 0),
+	fJournal(RecoveryJournal::Directory(fPreferences->fSettingsPath)),
+	fFileStateStore(FileStateStore::Directory(fPreferences->fSettingsPath))
 {
 	fActivatedGuard = false;
+	fRestoredFirstLine = -1;
 
 	fModifiedOutside = false;
 	fModified = false;
 	fReadOnly = false;
+	fEncoding = TextEncoding::UTF8;
+	fCompression = Compression::NONE;
+
+	fFollowOffset = 0;
+	fFollow = false;
+	fReadingStdin = false;
+	fHeldStdin = false;
+	fVolumeDevice = -1;
+	fVolumeReadOnly = false;
+
+	fPageStart = 0;
+	fPageEnd = 0;
+	fPageFirstLine = 0;
+	fPendingLine = -1;
 
 	fOnQuitReplyToMessage = nullptr;
 
 	fGoToLineWindow = nullptr;
 	fBookmarksWindow = nullptr;
+	fFindResultsWindow = nullptr;
 	fOpenedFilePath = nullptr;
 	fOpenedFileModificationTime = -1;
+	fLoadingLine = -1;
+	fLoadingColumn = -1;
+	fSaveChangeCount = 0;
 
 	fCurrentLanguage = "text";
 
@@ -110,6 +165,9 @@ EditorWindow::EditorWindow(bool stagger)
 				.AddItem(B_TRANSLATE("<empty>"), MAINMENU_OPEN_RECENT)
 			.End()
 			.AddItem(B_TRANSLATE("Reload"), MAINMENU_FILE_RELOAD)
+			.AddMenu(B_TRANSLATE("Local history"))
+				.AddItem(B_TRANSLATE("<empty>"), MAINMENU_FILE_LOCAL_HISTORY)
+			.End()
 			.AddItem(B_TRANSLATE("Save"), MAINMENU_FILE_SAVE, 'S')
 			.AddItem(B_TRANSLATE("Save as" B_UTF8_ELLIPSIS), MAINMENU_FILE_SAVEAS)
 			.AddSeparator()
@@ -150,6 +208,7 @@ EditorWindow::EditorWindow(bool stagger)
 			.End()
 			.AddItem(B_TRANSLATE("Show toolbar"), MAINMENU_VIEW_TOOLBAR)
 			.AddItem(B_TRANSLATE("Wrap lines"), MAINMENU_VIEW_WRAPLINES)
+			.AddItem(B_TRANSLATE("Follow file"), MAINMENU_VIEW_FOLLOW)
 			.AddMenu(B_TRANSLATE("Code folding"))
 				.AddItem(B_TRANSLATE("Expand all folds"), MAINMENU_VIEW_EXPANDFOLDS)
 				.AddItem(B_TRANSLATE("Collapse all folds"), MAINMENU_VIEW_COLLAPSEFOLDS)
@@ -185,6 +244,9 @@ EditorWindow::EditorWindow(bool stagger)
 	fOpenRecentMenu = fMainMenu->FindItem(MAINMENU_OPEN_RECENT)->Menu();
 	_PopulateOpenRecentMenu(fOpenRecentMenu);
 
+	fLocalHistoryMenu = fMainMenu->FindItem(MAINMENU_FILE_LOCAL_HISTORY)->Menu();
+	fLocalHistoryMenu->ItemAt(0)->SetEnabled(false);
+
 	fLanguageMenu = fMainMenu->FindItem(MAINMENU_LANGUAGE)->Menu();
 	_PopulateLanguageMenu();
 
@@ -204,6 +266,7 @@ EditorWindow::EditorWindow(bool stagger)
 	fContextMenu->SetTargetForItems(*windowMessenger);
 
 	fEditor = new Editor();
+	fEditor->SetEncoding(EncodingName(fEncoding));
 
 	fToolbar = new ToolBar(this);
 	fToolbar->AddAction(MAINMENU_FILE_NEW,
@@ -264,6 +327,11 @@ EditorWindow::EditorWindow(bool stagger)
 	layout->AddView(fMainMenu);
 	layout->AddView(fToolbar);
 	layout->AddView(fEditor);
+	fHexView = new HexView();
+	fHexScrollView = new BScrollView("hexScrollView", fHexView, 0, false,
+		true, B_NO_BORDER);
+	fHexScrollView->Hide();
+	layout->AddView(fHexScrollView);
 	layout->SetInsets(0, 0, -1, -1);
 	SetKeyMenuBar(fMainMenu);
 
@@ -280,6 +348,12 @@ EditorWindow::EditorWindow(bool stagger)
 	fEditor->SendMessage(SCI_SETSCROLLWIDTHTRACKING, true, 0);
 	fEditor->SendMessage(SCI_SETSAVEPOINT, 0, 0);
 
+	fEditor->SetJournal(&fJournal);
+	_StartJournal();
+	BMessage journalSync(JOURNAL_SYNC);
+	fJournalRunner.reset(new BMessageRunner(BMessenger(this), &journalSync,
+		kJournalSyncInterval));
+
 	BFont font;
 	font.SetFamilyAndStyle(fPreferences->fFontFamily.c_str(), nullptr);
 	font.SetSize(fPreferences->fFontSize);
@@ -299,6 +373,9 @@ EditorWindow::~EditorWindow()
 {
 	be_app->StopWatching(this, VIEW_SPECIAL_CHANGED);
 
+	// the journal goes away before the editor does
+	fEditor->SetJournal(nullptr);
+
 	RemoveCommonFilter(fFindReplaceHandler->IncrementalSearchFilter());
 
 	delete fFindReplaceHandler;
@@ -319,10 +396,24 @@ EditorWindow::New()
  * the save point and undo buffer, sets the caret on position when it was
  * closed, sets the langugage, adds the file to recent documents, refreshes the
  * window title and syncs the preferences.
+ * Big files are loaded in the background, in that case the second part of
+ * the process (from resetting the save point) happens when loading is done.
  */
 void
 EditorWindow::OpenFile(const entry_ref* ref, Sci_Position line, Sci_Position column)
 {
+	_WaitForSave();
+	_CancelLoading();
+	// loading is not a change worth recovering
+	fJournal.Stop();
+	_ShowHexView(false);
+	_ClosePaged();
+	fFileHasher.reset();
+	// the rest of standard input, if any, does not belong to the file
+	fReadingStdin = false;
+	fHeldStdin = false;
+	fAppendDecoder.reset();
+
 	fEditor->SetReadOnly(false);
 		// let us load new file
 	if(fOpenedFilePath != nullptr) {
@@ -333,50 +424,94 @@ EditorWindow::OpenFile(const entry_ref* ref, Sci_Position line, Sci_Position col
 
 	BEntry entry(ref);
 
+	if(fOpenedFilePath == nullptr)
+		fOpenedFilePath = new BPath(&entry);
+	else
+		fOpenedFilePath->SetTo(&entry);
+
 	File file(&entry, B_READ_ONLY);
 	if(entry.Exists()) {
 		fReadOnly = !File::CanWrite(&file);
 		file.Monitor(true, this);
 		file.GetModificationTime(&fOpenedFileModificationTime);
-		fEditor->SetText(file.Read().data());
+		off_t size = 0;
+		file.GetSize(&size);
+		char magic[kCompressionMagicSize];
+		fCompression = DetectCompression(magic,
+			std::max<ssize_t>(file.ReadAt(0, magic, sizeof(magic)), 0));
+		// binary files are shown as they are instead of being loaded
+		if(fCompression == Compression::NONE && file.LooksBinary()
+				&& fHexView->SetFile(fOpenedFilePath->Path()) == B_OK) {
+			fEditor->SetLargeFileMode(false);
+			fEditor->LoadText(nullptr, 0);
+			fEditor->SendMessage(SCI_SETSAVEPOINT);
+			fEditor->SendMessage(SCI_EMPTYUNDOBUFFER);
+			fEditor->SetReadOnly(true);
+			fEditor->SetRef(*ref);
+			_ShowHexView(true);
+			be_roster->AddToRecentDocuments(ref, gAppMime);
+			RefreshTitle();
+			return;
+		}
+		// files which would not fit in memory are only viewed, in pages
+		if(fCompression == Compression::NONE && size >= _PagedViewSize()
+				&& _OpenPaged(line) == B_OK) {
+			fEditor->SetRef(*ref);
+			be_roster->AddToRecentDocuments(ref, gAppMime);
+			RefreshTitle();
+			return;
+		}
+		const int options = _DocumentOptions(fCompression == Compression::NONE
+			? size : size * kCompressionRatioEstimate);
+		fEditor->SetLargeFileMode(options != SC_DOCUMENTOPTION_DEFAULT);
+		// compressed files are always decompressed while loading
+		if((size >= kBackgroundLoadSize || fCompression != Compression::NONE)
+				&& _LoadInBackground(file, options, line, column) == B_OK) {
+			fEditor->SetRef(*ref);
+			RefreshTitle();
+			return;
+		}
+		fEditor->NewDocument(options);
+		FileMapping mapping(fOpenedFilePath->Path());
+		std::vector<char> buffer;
+		std::string_view data;
+		if(mapping.InitCheck() == B_OK) {
+			data = std::string_view(mapping.Data(), mapping.Size());
+		} else {
+			// some file systems can't be mapped, read them the old way
+			buffer = file.Read();
+			data = std::string_view(buffer.data(), buffer.size() - 1);
+		}
+		fFileHasher.emplace();
+		fFileHasher->Update(data);
+		std::string decompressed;
+		if(fCompression != Compression::NONE) {
+			Decompressor decompressor(fCompression);
+			// part of a corrupt file would be compressed over all of it
+			if(decompressor.Decompress(data, decompressed) == false
+					|| decompressor.Finish(decompressed) == false) {
+				OKAlert(B_TRANSLATE("Open error"), B_TRANSLATE("An error "
+					"occurred while attempting to open the file."), B_STOP_ALERT);
+				_CloseDocument();
+				return;
+			}
+			data = decompressed;
+		}
+		fEncoding = DetectEncoding(data.data(), data.size());
+		_LoadText(data.data(), data.size());
+		fLineEndings = LineEndingCounter();
+		for(const auto& span : fEditor->TextSpans())
+			fLineEndings.Update(span);
 	} else {
 		// TODO check if we have directory permissions to create a new file?
 		fReadOnly = false;
+		fEncoding = TextEncoding::UTF8;
+		fCompression = CompressionForFilename(fOpenedFilePath->Leaf());
+		fLineEndings = LineEndingCounter();
+		fEditor->SetLargeFileMode(false);
 	}
 
-	fModifiedOutside = false;
-
-	fEditor->SendMessage(SCI_SETSAVEPOINT);
-	fEditor->SendMessage(SCI_EMPTYUNDOBUFFER);
-
-	Sci_Position gotoPos = file.ReadCaretPosition();
-	if(line != -1) {
-		gotoPos = fEditor->SendMessage(SCI_POSITIONFROMLINE, line - 1);
-		if(column != -1) {
-			gotoPos += column;
-		}
-	}
-	fEditor->SendMessage(SCI_GOTOPOS, gotoPos, 0);
-	fEditor->SetBookmarks(file.ReadBookmarks());
-	fOpenedFileMimeType.SetTo(file.ReadMimeType().c_str());
-
-	char name[B_FILE_NAME_LENGTH];
-	entry.GetName(name);
-	_SetLanguageByFilename(name);
-
-	fEditor->SetReadOnly(fReadOnly);
-	fEditor->SetRef(*ref);
-
-	be_roster->AddToRecentDocuments(ref, gAppMime);
-
-	if(fOpenedFilePath == nullptr)
-		fOpenedFilePath = new BPath(&entry);
-	else
-		fOpenedFilePath->SetTo(&entry);
-	RefreshTitle();
-
-	// load .editorconfig and apply settings
-	_SyncWithPreferences();
+	_FinishOpenFile(line, column);
 }
 
 
@@ -398,6 +533,9 @@ EditorWindow::RefreshTitle()
 	if(fReadOnly) {
 		title << " " << B_TRANSLATE("[read-only]");
 	}
+	if(fHexView->HasFile()) {
+		title << " " << B_TRANSLATE("[binary]");
+	}
 	SetTitle(title);
 }
 
@@ -406,6 +544,12 @@ void
 EditorWindow::SaveFile(entry_ref* ref)
 {
 	if(ref == nullptr) return;
+	// the document is incomplete until loading finishes
+	if(fDocumentLoader != nullptr) return;
+	// binary and paged files are only viewed
+	if(fHexView->HasFile() || fPagedMapping != nullptr) return;
+	// one save at a time
+	_WaitForSave();
 
 	std::string path(BPath(ref).Path());
 
@@ -415,27 +559,18 @@ EditorWindow::SaveFile(entry_ref* ref)
 		File::Monitor(&open, false, this);
 	}
 
-	BackupFileGuard backupGuard(path.c_str(), this);
-
 	BEntry entry(path.c_str());
 	if(entry.InitCheck() == B_OK && entry.Exists() == false && fCurrentLanguage == "text") {
 		// this is a new file with an unset language so let's rescan
 		_SetLanguageByFilename(path.c_str());
 	}
 
-	// TODO error checking
-	File file(path.c_str(), B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
-	status_t result = file.InitCheck();
-	if(result == B_PERMISSION_DENIED) {
-		OKAlert(B_TRANSLATE("Access denied"), B_TRANSLATE("You don't have "
-			"sufficient permissions to edit this file."), B_STOP_ALERT);
+	if(_EnsureEncodable() == false)
 		return;
-	} else if(result != B_OK) {
-		OKAlert(B_TRANSLATE("Save error"), B_TRANSLATE("An error occurred "
-			"while attempting to save the file."), B_STOP_ALERT);
-		return;
-	}
-	file.Monitor(false, this);
+
+	// saving under another name follows its extension, e.g. .gz
+	if(fOpenedFilePath == nullptr || path != fOpenedFilePath->Path())
+		fCompression = CompressionForFilename(path);
 
 	if(fFilePreferences.fTrimTrailingWhitespace.value_or(
 			fPreferences->fTrimTrailingWhitespaceOnSave) == true) {
@@ -446,11 +581,74 @@ EditorWindow::SaveFile(entry_ref* ref)
 		fEditor->AppendNLAtTheEndIfNotPresent();
 	}
 
-	std::vector<char> buffer(fEditor->TextLength() + 1);
-	fEditor->GetText(0, buffer.size(), buffer.data());
-	file.Write(buffer);
-	fEditor->SendMessage(SCI_SETSAVEPOINT);
+	const auto spans = fEditor->TextSpans();
+	// writing what the file already holds would only touch it
+	if(_FileHolds(path, spans)) {
+		fEditor->SendMessage(SCI_SETSAVEPOINT);
+		File::Monitor(&entry, true, this);
+		return;
+	}
+
+	// the file is written in the background, the document stays editable
+	fDocumentSaver = std::make_unique<DocumentSaver>(path.c_str(), spans,
+		BMessenger(this), fEncoding, fCompression, fPreferences->fAtomicSave);
+	if(fPreferences->fLocalHistory == true)
+		fDocumentSaver->SetHistoryDirectory(_LocalHistoryPath());
+	fSaveChangeCount = fEditor->ChangeCount();
+	status_t status = fDocumentSaver->Start();
+	if(status != B_OK) {
+		fDocumentSaver->Wait();
+		_SavingFinished(status);
+	}
+}
+
+
+/**
+ * Blocks until the file being saved, if any, is written.
+ */
+void
+EditorWindow::_WaitForSave()
+{
+	if(fDocumentSaver == nullptr)
+		return;
+	_SavingFinished(fDocumentSaver->Wait());
+}
+
 
+/**
+ * Called once the background save is done. The document is only marked as
+ * saved if it was not changed in the meantime; otherwise the changes made
+ * during the save are still unsaved.
+ */
+void
+EditorWindow::_SavingFinished(status_t status)
+{
+	if(fDocumentSaver == nullptr)
+		return;
+	std::unique_ptr<DocumentSaver> saver = std::move(fDocumentSaver);
+	const std::string path = saver->Path();
+
+	if(status != B_OK) {
+		if(status == B_PERMISSION_DENIED) {
+			OKAlert(B_TRANSLATE("Access denied"), B_TRANSLATE("You don't have "
+				"sufficient permissions to edit this file."), B_STOP_ALERT);
+		} else {
+			OKAlert(B_TRANSLATE("Save error"), B_TRANSLATE("An error occurred "
+				"while attempting to save the file."), B_STOP_ALERT);
+		}
+		if(fOpenedFilePath != nullptr) {
+			BEntry open(fOpenedFilePath->Path());
+			File::Monitor(&open, true, this);
+		}
+		return;
+	}
+
+	const bool changed = fEditor->ChangeCount() != fSaveChangeCount;
+	if(changed == false)
+		fEditor->SendMessage(SCI_SETSAVEPOINT);
+	fFileHasher = saver->FileHasher();
+
+	File file(path.c_str(), B_READ_ONLY);
 	if(fOpenedFileMimeType.InitCheck() != B_OK) {
 		if(BMimeType::GuessMimeType(path.c_str(), &fOpenedFileMimeType) != B_OK
 			|| strcmp(fOpenedFileMimeType.Type(), "application/octet-stream") == 0) {
@@ -470,6 +668,7 @@ EditorWindow::SaveFile(entry_ref* ref)
 
 	file.Monitor(true, this);
 	file.GetModificationTime(&fOpenedFileModificationTime);
+	_SetFollowOffset(&file);
 	fModifiedOutside = false;
 
 	if(fOpenedFilePath != nullptr) {
@@ -477,7 +676,34 @@ EditorWindow::SaveFile(entry_ref* ref)
 	}
 	fOpenedFilePath = new BPath(path.c_str());
 	RefreshTitle();
-	backupGuard.SaveSuccessful();
+
+	_StartJournal();
+	// the journal starts from the saved file, add what was typed since
+	if(changed == true)
+		fJournal.Compact(fEditor->TextSpans());
+}
+
+
+/**
+ * Restores unsaved changes from a journal left behind by a window which was
+ * not closed properly. If the document had a file, it is opened first and
+ * the changes are applied once it is loaded.
+ */
+void
+EditorWindow::RecoverJournal(const char* journalPath)
+{
+	RecoveryJournal::Info info;
+	if(RecoveryJournal::ReadInfo(journalPath, info) != B_OK) {
+		BEntry(journalPath).Remove();
+		return;
+	}
+
+	fPendingJournal = journalPath;
+	entry_ref ref;
+	if(!info.path.empty() && get_ref_for_path(info.path.c_str(), &ref) == B_OK)
+		OpenFile(&ref);
+	else
+		_ReplayJournal();
 }
 
 
@@ -493,6 +719,7 @@ EditorWindow::QuitRequested()
 		break;
 		case ModifiedAlertResult::SAVE:
 			_Save();
+			_WaitForSave();
 		// fallthrough
 		case ModifiedAlertResult::DISCARD:
 			close = true;
@@ -500,16 +727,30 @@ EditorWindow::QuitRequested()
 		}
 	}
 	if(close == true) {
-		if(fOpenedFilePath != nullptr) {
-			File file(fOpenedFilePath->Path(), B_READ_ONLY);
-			file.WriteCaretPosition(fEditor->SendMessage(SCI_GETCURRENTPOS));
-			file.WriteBookmarks(fEditor->Bookmarks());
+		if(fOpenedFilePath != nullptr && fDocumentLoader == nullptr
+				&& !fHexView->HasFile() && fPagedMapping == nullptr) {
+			FileState state;
+			state.caret = fEditor->SendMessage(SCI_GETCURRENTPOS);
+			state.anchor = fEditor->SendMessage(SCI_GETANCHOR);
+			state.firstVisibleLine = fEditor->SendMessage(SCI_DOCLINEFROMVISIBLE,
+				fEditor->SendMessage(SCI_GETFIRSTVISIBLELINE));
+			const auto folds = fEditor->Folds();
+			state.folds.assign(folds.begin(), folds.end());
+			const auto bookmarks = fEditor->Bookmarks();
+			state.bookmarks.assign(bookmarks.begin(), bookmarks.end());
+			fFileStateStore.Write(fOpenedFilePath->Path(), state);
 		}
 
 		if(fGoToLineWindow != nullptr) {
 			fGoToLineWindow->LockLooper();
 			fGoToLineWindow->Quit();
 		}
+		if(fFindResultsWindow != nullptr) {
+			fFindResultsWindow->LockLooper();
+			fFindResultsWindow->Quit();
+			fFindResultsWindow = nullptr;
+		}
+		fMatchFinder.reset();
 
 		delete fOpenPanel;
 		delete fSavePanel;
@@ -556,6 +797,7 @@ EditorWindow::MessageReceived(BMessage* message)
 	switch(message->what) {
 		case SAVE_FILE: {
 			_Save();
+			_WaitForSave();
 			message->SendReply((uint32) B_OK);
 				// TODO: error handling
 		} break;
@@ -606,6 +848,9 @@ EditorWindow::MessageReceived(BMessage* message)
 				_OpenCorrespondingFile(*fOpenedFilePath, fCurrentLanguage);
 			}
 		} break;
+		case MAINMENU_FILE_LOCAL_HISTORY: {
+			_RestoreRevision(message->GetInt32("revision", -1));
+		} break;
 		case MAINMENU_FILE_TOGGLE_READONLY: {
 			if(fOpenedFilePath == nullptr || fOpenedFileModificationTime == -1) {
 				return;
@@ -633,16 +878,13 @@ EditorWindow::MessageReceived(BMessage* message)
 			fEditor->CommentBlock(fEditor->Get<Selection>());
 		} break;
 		case MAINMENU_EDIT_CONVERTEOLS_UNIX: {
-			fEditor->SendMessage(SCI_CONVERTEOLS, SC_EOL_LF, 0);
-			fEditor->SendMessage(SCI_SETEOLMODE, SC_EOL_LF, 0);
+			fEditor->ConvertEOLs(SC_EOL_LF);
 		} break;
 		case MAINMENU_EDIT_CONVERTEOLS_WINDOWS: {
-			fEditor->SendMessage(SCI_CONVERTEOLS, SC_EOL_CRLF, 0);
-			fEditor->SendMessage(SCI_SETEOLMODE, SC_EOL_CRLF, 0);
+			fEditor->ConvertEOLs(SC_EOL_CRLF);
 		} break;
 		case MAINMENU_EDIT_CONVERTEOLS_MAC: {
-			fEditor->SendMessage(SCI_CONVERTEOLS, SC_EOL_CR, 0);
-			fEditor->SendMessage(SCI_SETEOLMODE, SC_EOL_CR, 0);
+			fEditor->ConvertEOLs(SC_EOL_CR);
 		} break;
 		case MAINMENU_EDIT_TRIMWS: {
 			fEditor->TrimTrailingWhitespace();
@@ -738,6 +980,14 @@ EditorWindow::MessageReceived(BMessage* message)
 			fEditor->SendMessage(SCI_SETWRAPMODE, fPreferences->fWrapLines ?
 				SC_WRAP_WORD : SC_WRAP_NONE, 0);
 		} break;
+		case MAINMENU_VIEW_FOLLOW: {
+			fFollow = !fFollow;
+			fMainMenu->FindItem(message->what)->SetMarked(fFollow);
+			// catch up with what was appended in the meantime
+			if(fFollow == true && fModifiedOutside == true
+					&& _FollowFile() == true)
+				fModifiedOutside = false;
+		} break;
 		case MAINMENU_VIEW_EXPANDFOLDS: {
 			fEditor->SendMessage(SCI_FOLDALL, SC_FOLDACTION_EXPAND);
 		} break;
@@ -839,6 +1089,59 @@ EditorWindow::MessageReceived(BMessage* message)
 			fEditor->SendMessage(SCI_REDO, 0, 0);
 			_SyncEditMenus();
 		} break;
+		case LOADER_PROGRESS: {
+			if(fDocumentLoader != nullptr)
+				fEditor->SetProgress(message->GetFloat("progress", 0.0f));
+		} break;
+		case LOADER_FINISHED: {
+			_LoadingFinished(message->GetInt32("status", B_ERROR));
+		} break;
+		case INDEXER_PROGRESS: {
+			if(fLineIndexer != nullptr)
+				fEditor->SetProgress(message->GetFloat("progress", 0.0f), true);
+			_IndexingProgress();
+		} break;
+		case INDEXER_FINISHED: {
+			fEditor->SetProgress(-1.0f);
+			_IndexingProgress();
+		} break;
+		case FILE_LOAD_CANCEL: {
+			_CancelLoading();
+		} break;
+		case STDIN_DATA: {
+			const void* data;
+			ssize_t size;
+			if(message->FindData("data", B_RAW_TYPE, &data, &size) == B_OK)
+				_AppendStdin(std::string_view(static_cast<const char*>(data), size));
+			// the reply lets the sender read more, keeping one piece in flight
+			message->SendReply((uint32) B_OK);
+		} break;
+		case STDIN_FINISHED: {
+			_FinishStdin();
+			if(message->GetBool("wait", false) == true)
+				SetOnQuitReplyToMessage(DetachCurrentMessage());
+			else
+				message->SendReply((uint32) B_OK);
+		} break;
+		case SAVER_FINISHED: {
+			// a save completed by _WaitForSave() leaves its message queued,
+			// which must not finish the save started after it
+			if(fDocumentSaver == nullptr
+					|| message->GetInt32("serial", -1) != fDocumentSaver->Serial())
+				break;
+			_SavingFinished(fDocumentSaver->Wait());
+		} break;
+		case FILE_STAT_CHANGED: {
+			fStatRunner.reset();
+			_StatChanged();
+		} break;
+		case JOURNAL_SYNC: {
+			fJournal.Sync();
+			if(fJournal.NeedsCompaction(fEditor->SendMessage(SCI_GETLENGTH))) {
+				const auto spans = fEditor->TextSpans();
+				fJournal.Compact(spans);
+			}
+		} break;
 		case EDITOR_SAVEPOINT_LEFT: {
 			OnSavePoint(true);
 		} break;
@@ -846,7 +1149,9 @@ EditorWindow::MessageReceived(BMessage* message)
 			OnSavePoint(false);
 		} break;
 		case EDITOR_UPDATEUI: {
+			_ScrollPage();
 			_SyncEditMenus();
+			_UpdateMatchStatus();
 		} break;
 		case EDITOR_CONTEXT_MENU: {
 			BPoint where;
@@ -857,6 +1162,10 @@ EditorWindow::MessageReceived(BMessage* message)
 		case EDITOR_MODIFIED: {
 			BMessage notice = fEditor->BookmarksWithText();
 			SendNotices(BOOKMARKS_INVALIDATED, &notice);
+			// the matches are positions in the text before the change
+			if(fMatchFinder != nullptr
+					&& fMatchFinder->ChangeCount() != fEditor->ChangeCount())
+				_StopFindAll();
 		} break;
 		case B_ABOUT_REQUESTED:
 			be_app->PostMessage(message);
@@ -864,7 +1173,9 @@ EditorWindow::MessageReceived(BMessage* message)
 		case B_REFS_RECEIVED: {
 			entry_ref ref;
 			if(message->FindRef("refs", &ref) == B_OK) {
+				// streamed text is unmodified, but would be lost
 				if(fOpenedFilePath == nullptr && fModified == false
+					&& fReadingStdin == false && fHeldStdin == false
 					&& !fPreferences->fAlwaysOpenInNewWindow) {
 					OpenFile(&ref);
 				} else {
@@ -876,21 +1187,15 @@ EditorWindow::MessageReceived(BMessage* message)
 		case B_NODE_MONITOR: {
 			int32 opcode = message->GetInt32("opcode", 0);
 			if(opcode == B_STAT_CHANGED) {
-				BEntry entry;
-				if(fOpenedFilePath != nullptr) {
-					entry.SetTo(fOpenedFilePath->Path());
-					time_t mt;
-					entry.GetModificationTime(&mt);
-					if(mt > fOpenedFileModificationTime) {
-						fModifiedOutside = true;
-						fOpenedFileModificationTime = mt;
-					}
-
-					fReadOnly = !File::CanWrite(&entry);
-					fEditor->SetReadOnly(fReadOnly);
+				// editors and build tools write files in many small pieces,
+				// only look at the file once things calm down
+				const uint32 fields = message->GetInt32("fields",
+					kWatchedStatFields);
+				if((fields & kWatchedStatFields) != 0 && fStatRunner == nullptr) {
+					BMessage statChanged(FILE_STAT_CHANGED);
+					fStatRunner.reset(new BMessageRunner(BMessenger(this),
+						&statChanged, kStatChangedDelay, 1));
 				}
-				RefreshTitle();
-				// Notification about this is sent when window is activated
 			} else if(opcode == B_ENTRY_MOVED) {
 				entry_ref ref;
 				const char* name;
@@ -920,16 +1225,30 @@ EditorWindow::MessageReceived(BMessage* message)
 		} break;
 		case GTLW_GO: {
 			int32 line;
-			if(message->FindInt32("line", &line) == B_OK) {
-				fEditor->SendMessage(SCI_ENSUREVISIBLEENFORCEPOLICY, line - 1, 0);
-				fEditor->SendMessage(SCI_GOTOLINE, line - 1, 0);
+			if(message->FindInt32("line", &line) != B_OK)
+				break;
+			if(fPagedMapping != nullptr) {
+				_GoToPagedLine(std::max<int32>(line - 1, 0));
+				break;
 			}
+			fEditor->SendMessage(SCI_ENSUREVISIBLEENFORCEPOLICY, line - 1, 0);
+			fEditor->SendMessage(SCI_GOTOLINE, line - 1, 0);
 		} break;
 		case BOOKMARKS_WINDOW_QUITTING: {
 			fBookmarksWindow = nullptr;
 		} break;
 		// FIXME: this looked better in my head...
 		case FINDWINDOW_FIND: {
+			if(fMatchFinder != nullptr && fMatchFinder->SearchesFor(
+					message->GetString("findText", ""),
+					message->GetBool("matchCase", false),
+					message->GetBool("matchWord", false),
+					message->GetBool("regex", false)) == false)
+				_StopFindAll();
+			fEditor->SetSearchTerm(message->GetString("findText", ""),
+				message->GetBool("matchCase", false),
+				message->GetBool("matchWord", false),
+				message->GetBool("regex", false));
 			message->what = FindReplaceHandler::FIND;
 			PostMessage(message, fFindReplaceHandler, this);
 		} break;
@@ -948,6 +1267,28 @@ EditorWindow::MessageReceived(BMessage* message)
 		case FINDWINDOW_BOOKMARKALL: {
 			fEditor->SetBookmarksFromSearch(*message);
 		} break;
+		case FINDWINDOW_FINDALL: {
+			_FindAll(message);
+		} break;
+		case FINDER_PROGRESS:
+		case FINDER_FINISHED: {
+			// ignore messages sent by a finder which was stopped meanwhile
+			if(fMatchFinder == nullptr
+					|| message->GetPointer("finder") != fMatchFinder.get())
+				break;
+			SendNotices(FIND_RESULTS_CHANGED);
+			_UpdateMatchStatus();
+		} break;
+		case FIND_RESULT_SELECTED: {
+			const int64 start = message->GetInt64("start", 0);
+			const int64 end = message->GetInt64("end", 0);
+			fEditor->SendMessage(SCI_SETSEL, start, end);
+			fEditor->SendMessage(SCI_SCROLLCARET);
+			Activate();
+		} break;
+		case FIND_RESULTS_WINDOW_QUITTING: {
+			fFindResultsWindow = nullptr;
+		} break;
 		case OPEN_TERMINAL: {
 			_OpenTerminal();
 		} break;
@@ -965,7 +1306,10 @@ void
 EditorWindow::WindowActivated(bool active)
 {
 	if(active == true) {
-		if(fActivatedGuard == false) {
+		if(fActivatedGuard == false && fRestoredFirstLine != -1) {
+			_RestoreFirstVisibleLine();
+			fActivatedGuard = true;
+		} else if(fActivatedGuard == false) {
 			// Ensure that caret will be visible after opening file in a new
 			// window GOTOPOS in OpenFile does not do that, because in that time
 			// Scintilla view does not have proper dimensions, and the control
@@ -1039,6 +1383,8 @@ EditorWindow::MenusBeginning()
 		fWindowsMenu->SetTargetForItems(be_app);
 	}
 
+	_PopulateLocalHistoryMenu();
+
 	if(fReadWriteMenuItem != nullptr) {
 		if(fOpenedFilePath == nullptr || fOpenedFileModificationTime == -1) {
 			fReadWriteMenuItem->SetEnabled(false);
@@ -1101,6 +1447,76 @@ EditorWindow::_PopulateOpenRecentMenu(BMenu* menu)
 }
 
 
+void
+EditorWindow::_PopulateLocalHistoryMenu()
+{
+	fLocalHistoryMenu->RemoveItems(0, fLocalHistoryMenu->CountItems(), true);
+
+	std::vector<LocalHistory::Revision> revisions;
+	// the saver may be writing the history
+	if(fOpenedFilePath != nullptr && fDocumentLoader == nullptr
+			&& fDocumentSaver == nullptr)
+		revisions = LocalHistory(_LocalHistoryPath()).Revisions(fOpenedFilePath->Path());
+	if(revisions.empty()) {
+		BMenuItem* empty = new BMenuItem(B_TRANSLATE("<empty>"),
+			new BMessage(MAINMENU_FILE_LOCAL_HISTORY));
+		empty->SetEnabled(false);
+		fLocalHistoryMenu->AddItem(empty);
+		return;
+	}
+
+	BDateTimeFormat format;
+	// newest first
+	for(auto it = revisions.rbegin(); it != revisions.rend(); it++) {
+		BString time;
+		format.Format(time, it->time, B_SHORT_DATE_FORMAT, B_MEDIUM_TIME_FORMAT);
+		char size[B_PATH_NAME_LENGTH];
+		string_for_size(it->size, size, sizeof(size));
+		BString label;
+		label.SetToFormat("%s (%s)", time.String(), size);
+		BMessage* message = new BMessage(MAINMENU_FILE_LOCAL_HISTORY);
+		message->AddInt32("revision", it->index);
+		fLocalHistoryMenu->AddItem(new BMenuItem(label.String(), message));
+	}
+}
+
+
+/**
+ * Replaces the text with a saved revision. This is a regular edit, so it can
+ * be undone and the file is not changed until it is saved.
+ */
+void
+EditorWindow::_RestoreRevision(int32 index)
+{
+	if(fOpenedFilePath == nullptr || fDocumentLoader != nullptr)
+		return;
+
+	std::string contents;
+	if(LocalHistory(_LocalHistoryPath()).Restore(fOpenedFilePath->Path(),
+			index, contents) != B_OK) {
+		OKAlert(B_TRANSLATE("Local history"), B_TRANSLATE("An error occurred "
+			"while attempting to restore this revision."), B_STOP_ALERT);
+		return;
+	}
+
+	const Sci_Position caret = fEditor->SendMessage(SCI_GETCURRENTPOS);
+	Scintilla::UndoAction action(fEditor);
+	fEditor->SendMessage(SCI_TARGETWHOLEDOCUMENT);
+	fEditor->SendMessage(SCI_REPLACETARGET, contents.size(),
+		reinterpret_cast<sptr_t>(contents.data()));
+	fEditor->SendMessage(SCI_GOTOPOS, caret);
+}
+
+
+BPath
+EditorWindow::_LocalHistoryPath()
+{
+	BPath path(fPreferences->fSettingsPath);
+	path.Append("history");
+	return path;
+}
+
+
 void
 EditorWindow::_PopulateLanguageMenu()
 {
@@ -1150,6 +1566,8 @@ EditorWindow::_ReloadFile(entry_ref* ref)
 
 	if(ref == nullptr) {
 		// reload file from current location
+		if(_ReloadChanges() == true)
+			return;
 		entry_ref e;
 		BEntry entry(fOpenedFilePath->Path());
 		entry.GetRef(&e);
@@ -1167,88 +1585,1121 @@ EditorWindow::_ReloadFile(entry_ref* ref)
 }
 
 
-void
-EditorWindow::_SetLanguage(std::string lang)
+/**
+ * Brings the document up to date with the file by replacing only the lines
+ * which differ, as a single undo action. Unlike opening the file again this
+ * keeps the undo history, and bookmarks and folds outside of the changes,
+ * while only the changed lines need styling.
+ * Returns false if the file should be opened again instead: it is big,
+ * compressed, binary, in another encoding now, or changed too much.
+ */
+bool
+EditorWindow::_ReloadChanges()
 {
-	fCurrentLanguage = lang;
-	const auto mapping = Languages::ApplyLanguage(fEditor, lang.c_str());
-
-	BFont font;
-	font.SetFamilyAndStyle(fPreferences->fFontFamily.c_str(), nullptr);
-	font.SetSize(fPreferences->fFontSize);
-	BFont *fontPtr = (fPreferences->fUseCustomFont ? &font : nullptr);
-	Styler::ApplyGlobal(fEditor, fPreferences->fStyle.c_str(), fontPtr);
-	Styler::ApplyLanguage(fEditor, mapping);
-
-	fEditor->SetType(Languages::GetMenuItemName(lang));
+	if(fDocumentLoader != nullptr || fHexView->HasFile()
+			|| fPagedMapping != nullptr || fCompression != Compression::NONE
+			|| fEditor->SendMessage(SCI_GETDOCUMENTOPTIONS) != SC_DOCUMENTOPTION_DEFAULT)
+		return false;
+
+	File file(fOpenedFilePath->Path(), B_READ_ONLY);
+	off_t size;
+	if(file.InitCheck() != B_OK || file.GetSize(&size) != B_OK
+			|| size >= kBackgroundLoadSize || file.LooksBinary())
+		return false;
+
+	FileMapping mapping(fOpenedFilePath->Path());
+	std::vector<char> buffer;
+	std::string_view data;
+	if(mapping.InitCheck() == B_OK) {
+		data = std::string_view(mapping.Data(), mapping.Size());
+	} else {
+		buffer = file.Read();
+		data = std::string_view(buffer.data(), buffer.size() - 1);
+	}
+	if(DetectEncoding(data.data(), data.size()) != fEncoding)
+		return false;
+	Hasher hasher;
+	hasher.Update(data);
+	std::string decoded;
+	if(fEncoding == TextEncoding::UTF8_BOM && data.size() >= 3) {
+		data.remove_prefix(3);
+	} else if(fEncoding != TextEncoding::UTF8) {
+		TextDecoder decoder(fEncoding);
+		decoder.Decode(data, decoded);
+		decoder.Finish(decoded);
+		data = decoded;
+	}
 
-	fMainMenu->FindItem(EDIT_COMMENTLINE)->SetEnabled(fEditor->CanCommentLine());
-	fMainMenu->FindItem(EDIT_COMMENTBLOCK)->SetEnabled(fEditor->CanCommentBlock());
-	fMainMenu->FindItem(MAINMENU_FILE_OPEN_CORRESPONDING)->SetEnabled(lang == "c" || lang == "cpp");
+	const char* text = reinterpret_cast<const char*>(
+		fEditor->SendMessage(SCI_GETCHARACTERPOINTER));
+	const auto hunks = DiffLines(
+		std::string_view(text, fEditor->SendMessage(SCI_GETLENGTH)), data);
+	if(!hunks)
+		return false;
 
-	fContextMenu->FindItem(EDIT_COMMENTLINE)->SetEnabled(fEditor->CanCommentLine());
-	fContextMenu->FindItem(EDIT_COMMENTBLOCK)->SetEnabled(fEditor->CanCommentBlock());
+	// the journal starts again from the new contents of the file
+	fJournal.Stop();
+	fEditor->SetReadOnly(false);
+	{
+		Scintilla::UndoAction action(fEditor);
+		// from the end, so that earlier offsets stay valid
+		for(auto it = hunks->rbegin(); it != hunks->rend(); it++) {
+			fEditor->SendMessage(SCI_SETTARGETRANGE, it->oldOffset,
+				it->oldOffset + it->oldLength);
+			fEditor->SendMessage(SCI_REPLACETARGET, it->newLength,
+				reinterpret_cast<sptr_t>(data.data() + it->newOffset));
+		}
+	}
+	fEditor->SendMessage(SCI_SETSAVEPOINT);
 
-	// folding margin state can change depending on the language used
-	fEditor->SetFoldMarginEnabled(fPreferences->fFoldMargin);
+	fReadOnly = !File::CanWrite(&file);
+	fEditor->SetReadOnly(fReadOnly);
+	file.GetModificationTime(&fOpenedFileModificationTime);
+	_SetFollowOffset(&file);
+	fFileHasher = hasher;
+	fModifiedOutside = false;
+	fLineEndings = LineEndingCounter();
+	fLineEndings.Update(data);
+	RefreshTitle();
+	_StartJournal();
+	return true;
 }
 
 
+/**
+ * Handles changes to the opened file made by other applications, with
+ * a single stat. The volume is only looked up when the file moves to
+ * another one.
+ * Notification about modification is sent when window is activated.
+ */
 void
-EditorWindow::_SetLanguageByFilename(const char* filename)
+EditorWindow::_StatChanged()
 {
-	std::string lang;
-	// try to match whole filename first, this is needed for e.g. CMake
-	bool found = Languages::GetLanguageForExtension(filename, lang);
-	if(found == false) {
-		const std::string extension = GetFileExtension(filename);
-		if(!extension.empty())
-			Languages::GetLanguageForExtension(extension.c_str(), lang);
+	if(fOpenedFilePath == nullptr)
+		return;
+
+	BEntry entry(fOpenedFilePath->Path());
+	struct stat st;
+	if(entry.GetStat(&st) != B_OK)
+		return;
+	// the modification time has a resolution of a second, an append in the
+	// same second as the last one followed only shows in the size
+	const bool appended = fFollow == true && st.st_size != fFollowOffset;
+	if(st.st_mtime > fOpenedFileModificationTime || appended == true) {
+		fOpenedFileModificationTime = std::max(fOpenedFileModificationTime,
+			st.st_mtime);
+		if((fFollow == false || _FollowFile() == false)
+				&& _FileChanged() == true)
+			fModifiedOutside = true;
 	}
-	_SetLanguage(lang);
+	// the size might have changed, map the file again
+	if(fHexView->HasFile())
+		fHexView->SetFile(fOpenedFilePath->Path());
+	if(fPagedMapping != nullptr) {
+		const uint64 topLine = fPageFirstLine + fEditor->SendMessage(
+			SCI_DOCLINEFROMVISIBLE, fEditor->SendMessage(SCI_GETFIRSTVISIBLELINE));
+		_RemapPaged(topLine);
+	}
+
+	if(fVolumeDevice != st.st_dev) {
+		fVolumeDevice = st.st_dev;
+		fVolumeReadOnly = BVolume(st.st_dev).IsReadOnly();
+	}
+	const bool readOnly = fVolumeReadOnly
+		|| (st.st_mode & (S_IWUSR | S_IWGRP | S_IWOTH)) == 0;
+	if(readOnly != fReadOnly) {
+		fReadOnly = readOnly;
+		fEditor->SetReadOnly(fReadOnly || fPagedMapping != nullptr);
+		RefreshTitle();
+	}
+}
+
+
+/**
+ * Tells whether the contents of the file differ from what was last loaded
+ * or saved, by hashing it. A touch, or a tool writing the same contents
+ * again, does not count as a change. Files above kMaxHashedFileSize are not
+ * hashed and always count as changed.
+ */
+bool
+EditorWindow::_FileChanged()
+{
+	if(!fFileHasher || fOpenedFilePath == nullptr)
+		return true;
+
+	File file(fOpenedFilePath->Path(), B_READ_ONLY);
+	off_t size;
+	if(file.InitCheck() != B_OK || file.GetSize(&size) != B_OK
+			|| static_cast<uint64>(size) != fFileHasher->Length()
+			|| size > kMaxHashedFileSize)
+		return true;
+
+	Hasher hasher;
+	std::vector<char> buffer(std::min<off_t>(size, DocumentLoader::kChunkSize));
+	ssize_t bytesRead;
+	while((bytesRead = file.Read(buffer.data(), buffer.size())) > 0)
+		hasher.Update(buffer.data(), bytesRead);
+	if(bytesRead < 0)
+		return true;
+	return hasher.Length() != fFileHasher->Length()
+		|| hasher.Final() != fFileHasher->Final();
+}
+
+
+/**
+ * Tells whether saving spans to path would write exactly what the file
+ * holds already, as last loaded or saved by this window.
+ * Only plain UTF-8 up to kMaxHashedFileSize is checked: compressing,
+ * converting or hashing more of the document just to find out would take
+ * about as long as the save itself.
+ */
+bool
+EditorWindow::_FileHolds(const std::string& path,
+	const std::array<std::string_view, 2>& spans)
+{
+	if(!fFileHasher || fOpenedFilePath == nullptr
+			|| path != fOpenedFilePath->Path() || fModifiedOutside == true
+			|| fCompression != Compression::NONE
+			|| (fEncoding != TextEncoding::UTF8
+				&& fEncoding != TextEncoding::UTF8_BOM))
+		return false;
+
+	const uint64 length = spans[0].size() + spans[1].size()
+		+ (fEncoding == TextEncoding::UTF8_BOM ? 3 : 0);
+	struct stat st;
+	if(length != fFileHasher->Length() || length > kMaxHashedFileSize
+			|| BEntry(path.c_str()).GetStat(&st) != B_OK
+			|| st.st_mtime != fOpenedFileModificationTime
+			|| static_cast<uint64>(st.st_size) != fFileHasher->Length())
+		return false;
+
+	Hasher hasher;
+	return WriteText(nullptr, spans, fEncoding, fCompression, &hasher) == B_OK
+		&& hasher.Length() == fFileHasher->Length()
+		&& hasher.Final() == fFileHasher->Final();
 }
 
 
+/**
+ * Remembers how much of file the document holds, the point from which
+ * following the file continues.
+ */
 void
-EditorWindow::_OpenCorrespondingFile(const BPath &file, const std::string lang)
+EditorWindow::_SetFollowOffset(BFile* file)
 {
-	if(lang != "c" && lang != "cpp")
-		return;
+	if(file->GetSize(&fFollowOffset) != B_OK)
+		fFollowOffset = 0;
+	fAppendDecoder.reset();
+}
 
-	const std::vector<std::string> extensionsToTryC{"h", "hh", "hxx", "hpp"};
-	const std::vector<std::string> extensionsToTryH{"c", "cc", "cxx", "cpp"};
-	const std::vector<std::string>* extensionsToTry = &extensionsToTryC;
-	if(GetFileExtension(file.Leaf())[0] == 'h') {
-		extensionsToTry = &extensionsToTryH;
+
+/**
+ * Appends what was written to the end of the file since it was last read,
+ * reading only the new bytes. If the caret was at the end of the document it
+ * stays there, so the view scrolls with the file like tail -f does.
+ * A file which got shorter, e.g. a rotated log, is reloaded instead.
+ * Returns false if the file can't be followed: the document has unsaved
+ * changes, or is compressed or shown in the hex view.
+ */
+bool
+EditorWindow::_FollowFile()
+{
+	if(fModified == true || fDocumentLoader != nullptr || fHexView->HasFile()
+			|| fPagedMapping != nullptr || fCompression != Compression::NONE)
+		return false;
+
+	File file(fOpenedFilePath->Path(), B_READ_ONLY);
+	off_t size;
+	if(file.InitCheck() != B_OK || file.GetSize(&size) != B_OK)
+		return false;
+	if(size < fFollowOffset) {
+		_ReloadFile();
+		return true;
 	}
-	BPath parent;
-	if(file.GetParent(&parent) == B_OK) {
-		const BDirectory parentDir(parent.Path());
+	// same size, but it may have been rewritten
+	if(size == fFollowOffset)
+		return _FileChanged() == false;
+
+	const Sci_Position length = fEditor->SendMessage(SCI_GETLENGTH);
+	const bool atEnd = fEditor->SendMessage(SCI_GETCURRENTPOS) == length
+		&& fEditor->SendMessage(SCI_GETANCHOR) == length;
+	if(fEncoding != TextEncoding::UTF8 && fEncoding != TextEncoding::UTF8_BOM
+			&& fAppendDecoder == nullptr)
+		fAppendDecoder = std::make_unique<TextDecoder>(fEncoding);
+
+	// the appended text is already saved, there is nothing to undo or recover
+	fJournal.Stop();
+	fEditor->SetReadOnly(false);
+	fEditor->SendMessage(SCI_SETUNDOCOLLECTION, false);
+	std::vector<char> buffer(std::min<off_t>(size - fFollowOffset,
+		DocumentLoader::kChunkSize));
+	while(fFollowOffset < size) {
+		ssize_t bytesRead = file.ReadAt(fFollowOffset, buffer.data(),
+			std::min<off_t>(size - fFollowOffset, buffer.size()));
+		if(bytesRead <= 0)
+			break;
+		fFollowOffset += bytesRead;
+		std::string_view data(buffer.data(), bytesRead);
+		if(fFileHasher)
+			fFileHasher->Update(data);
+		_AppendData(data);
+	}
+	fEditor->SendMessage(SCI_SETUNDOCOLLECTION, true);
+	fEditor->SendMessage(SCI_SETSAVEPOINT);
+	fEditor->SetReadOnly(fReadOnly);
+	_StartJournal();
 
-		const std::string filename = GetFileName(file.Leaf());
-		for(auto &ext : *extensionsToTry) {
-			BEntry fileToTry(&parentDir, (filename + '.' + ext).c_str());
-			if(fileToTry.Exists()) {
-				BMessage openFile(B_REFS_RECEIVED);
-				entry_ref ref;
-				if(fileToTry.GetRef(&ref) == B_OK) {
-					openFile.AddRef("refs", &ref);
-					openFile.AddPointer("window", this);
-					be_app->PostMessage(&openFile);
-					return;
-				}
-			}
-		}
-		OKAlert(B_TRANSLATE("Open partner file"),
-			B_TRANSLATE("Partner file not found."), B_STOP_ALERT);
+	if(atEnd == true)
+		fEditor->SendMessage(SCI_DOCUMENTEND);
+	return true;
+}
+
+
+/**
+ * Appends data, in the encoding of the document, to its end. Characters
+ * split between calls are put together by fAppendDecoder.
+ */
+void
+EditorWindow::_AppendData(std::string_view data)
+{
+	std::string decoded;
+	if(fAppendDecoder != nullptr) {
+		fAppendDecoder->Decode(data, decoded);
+		data = decoded;
 	}
+	fLineEndings.Update(data);
+	fEditor->SendMessage(SCI_APPENDTEXT, data.size(),
+		reinterpret_cast<sptr_t>(data.data()));
 }
 
 
+/**
+ * Appends a piece of standard input streamed by another Koder process,
+ * outside of the undo history. Until the user makes changes the document
+ * stays unmodified, so that it can be closed without a prompt, like a pager.
+ * The encoding is detected from the first piece. Pieces arriving after the
+ * window opened a file are dropped.
+ */
 void
-EditorWindow::_LoadEditorconfig()
+EditorWindow::_AppendStdin(std::string_view data)
 {
-	if(fOpenedFilePath == nullptr) return;
+	if(fReadingStdin == false)
+		return;
+	if(fHeldStdin == false) {
+		fHeldStdin = true;
+		fJournal.Stop();
+		fEncoding = DetectEncoding(data.data(), data.size(), false);
+		fEditor->SetEncoding(EncodingName(fEncoding));
+		fLineEndings = LineEndingCounter();
+		if(fEncoding != TextEncoding::UTF8)
+			fAppendDecoder = std::make_unique<TextDecoder>(fEncoding);
+	}
+
+	const Sci_Position length = fEditor->SendMessage(SCI_GETLENGTH);
+	const bool atEnd = fEditor->SendMessage(SCI_GETCURRENTPOS) == length
+		&& fEditor->SendMessage(SCI_GETANCHOR) == length;
+	const bool modified = fEditor->SendMessage(SCI_GETMODIFY);
+	fEditor->SendMessage(SCI_SETUNDOCOLLECTION, false);
+	_AppendData(data);
+	fEditor->SendMessage(SCI_SETUNDOCOLLECTION, true);
+	if(modified == false)
+		fEditor->SendMessage(SCI_SETSAVEPOINT);
+	if(atEnd == true)
+		fEditor->SendMessage(SCI_DOCUMENTEND);
+}
+
+
+/**
+ * Called when standard input ends. The journal starts from the whole text,
+ * which exists nowhere else.
+ */
+void
+EditorWindow::_FinishStdin()
+{
+	if(fReadingStdin == false)
+		return;
+	if(fAppendDecoder != nullptr) {
+		std::string decoded;
+		fAppendDecoder->Finish(decoded);
+		fAppendDecoder.reset();
+		_AppendStdin(decoded);
+	}
+	fReadingStdin = false;
+	if(fHeldStdin == false)
+		return;
+
+	_StartJournal();
+	if(fEditor->SendMessage(SCI_GETLENGTH) > 0)
+		fJournal.Compact(fEditor->TextSpans());
+	int eolMode = SC_EOL_LF;
+	switch(fLineEndings.Dominant()) {
+		case LineEndingCounter::CRLF:	eolMode = SC_EOL_CRLF; break;
+		case LineEndingCounter::CR:		eolMode = SC_EOL_CR; break;
+		default: break;
+	}
+	fEditor->SetEOLMode(eolMode, fLineEndings.Mixed());
+}
+
+
+/**
+ * Switches between the editor and the hex view of a binary file.
+ */
+void
+EditorWindow::_ShowHexView(bool show)
+{
+	if(show == false) {
+		if(fHexView->HasFile() == false)
+			return;
+		fHexView->Unset();
+		fHexScrollView->Hide();
+		fEditor->Show();
+		fEditor->SendMessage(SCI_GRABFOCUS);
+		return;
+	}
+	if(fEditor->IsHidden(fEditor) == false)
+		fEditor->Hide();
+	if(fHexScrollView->IsHidden(fHexScrollView) == true)
+		fHexScrollView->Show();
+	fHexView->MakeFocus(true);
+}
+
+
+/**
+ * Files bigger than this are shown a page at a time instead of being loaded.
+ * Scintilla needs several times the size of a file in memory, for styles,
+ * line starts and undo, so a quarter of the memory is what could be loaded.
+ */
+off_t
+EditorWindow::_PagedViewSize()
+{
+	system_info info;
+	if(get_system_info(&info) != B_OK)
+		return kPagedViewMinSize;
+	return std::max<off_t>(static_cast<off_t>(info.max_pages) * B_PAGE_SIZE / 4,
+		kPagedViewMinSize);
+}
+
+
+/**
+ * Opens the file as a read-only view of kPageSize bytes, moved along the
+ * mapped file as it is scrolled. Lines are indexed in the background to
+ * find pages for going to a line.
+ * Only UTF-8 is paged, so that positions in a page are the offsets in the
+ * file from its start: decoding other encodings changes the length of the
+ * text, and UTF-16 can't be split into pages on line feed bytes.
+ */
+status_t
+EditorWindow::_OpenPaged(Sci_Position line)
+{
+	auto mapping = std::make_unique<FileMapping>(fOpenedFilePath->Path());
+	status_t status = mapping->InitCheck();
+	if(status != B_OK)
+		return status;
+	const TextEncoding encoding = DetectEncoding(mapping->Data(),
+		std::min<size_t>(mapping->Size(), kBackgroundLoadPreviewSize), false);
+	if(encoding != TextEncoding::UTF8 && encoding != TextEncoding::UTF8_BOM)
+		return B_NOT_SUPPORTED;
+	auto indexer = std::make_unique<LineIndexer>(fOpenedFilePath->Path(),
+		BMessenger(this));
+	if((status = indexer->Start()) != B_OK)
+		return status;
+
+	fPagedMapping = std::move(mapping);
+	fLineIndexer = std::move(indexer);
+	fEncoding = encoding;
+	fLineEndings = LineEndingCounter();
+	fModifiedOutside = false;
+	fEditor->NewDocument(SC_DOCUMENTOPTION_DEFAULT);
+	fEditor->SetLargeFileMode(true);
+	fEditor->SetProgress(0.0f, true);
+	fEditor->SetEncoding(EncodingName(fEncoding));
+	_LoadPage(_PagedTextStart(), 0);
+	fEditor->SetBookmarks({});
+	_SetLanguageByFilename(fOpenedFilePath->Leaf());
+	_SyncWithPreferences();
+	if(line > 0)
+		_GoToPagedLine(line - 1);
+	return B_OK;
+}
+
+
+void
+EditorWindow::_ClosePaged()
+{
+	if(fPagedMapping == nullptr)
+		return;
+	fLineIndexer.reset();
+	fPagedMapping.reset();
+	fPageStart = fPageEnd = fPageFirstLine = 0;
+	fPendingLine = -1;
+	fEditor->SetProgress(-1.0f);
+	fEditor->SetFirstLineNumber(-1);
+}
+
+
+/**
+ * Maps the paged file again if its size changed. A file which got shorter,
+ * e.g. a rotated log, is opened again at line, as the page and the line
+ * index may lie past its new end, where reading the old mapping faults.
+ * Returns false if the file was opened again.
+ */
+bool
+EditorWindow::_RemapPaged(uint64 line)
+{
+	struct stat st;
+	if(stat(fOpenedFilePath->Path(), &st) != 0
+			|| static_cast<uint64>(st.st_size) == fPagedMapping->Size())
+		return true;
+	if(static_cast<uint64>(st.st_size) > fPagedMapping->Size()) {
+		auto mapping = std::make_unique<FileMapping>(fOpenedFilePath->Path());
+		if(mapping->InitCheck() == B_OK)
+			fPagedMapping = std::move(mapping);
+		return true;
+	}
+	entry_ref ref;
+	BEntry(fOpenedFilePath->Path()).GetRef(&ref);
+	OpenFile(&ref, line + 1);
+	return false;
+}
+
+
+/**
+ * Returns the offset of the text in the paged file, after the byte order
+ * mark if there is one.
+ */
+uint64
+EditorWindow::_PagedTextStart() const
+{
+	return fEncoding == TextEncoding::UTF8_BOM ? 3 : 0;
+}
+
+
+/**
+ * Returns the start of the line holding offset. A line longer than
+ * kMaxPagedLineLength is cut at offset instead.
+ */
+uint64
+EditorWindow::_PageLineStart(uint64 offset)
+{
+	const char* data = fPagedMapping->Data();
+	const uint64 textStart = _PagedTextStart();
+	offset = std::max(offset, textStart);
+	const uint64 limit = offset > textStart + kMaxPagedLineLength
+		? offset - kMaxPagedLineLength : textStart;
+	for(uint64 i = offset; i > limit; i--) {
+		if(data[i - 1] == '\n')
+			return i;
+	}
+	return limit == textStart ? textStart : offset;
+}
+
+
+/**
+ * Returns the start of the first line at or after offset, or the end of the
+ * file. A line longer than kMaxPagedLineLength is cut at offset instead.
+ */
+uint64
+EditorWindow::_PageLineEnd(uint64 offset)
+{
+	const char* data = fPagedMapping->Data();
+	const uint64 size = fPagedMapping->Size();
+	if(offset == 0 || offset >= size || data[offset - 1] == '\n')
+		return std::min(offset, size);
+	const void* newline = memchr(data + offset, '\n',
+		std::min(size - offset, kMaxPagedLineLength));
+	if(newline == nullptr)
+		return offset + kMaxPagedLineLength < size ? offset : size;
+	return static_cast<const char*>(newline) - data + 1;
+}
+
+
+/**
+ * Replaces the text with the lines from start, which is the beginning of
+ * line firstLine, up to about kPageSize bytes.
+ */
+void
+EditorWindow::_LoadPage(uint64 start, uint64 firstLine)
+{
+	const uint64 end = _PageLineEnd(std::min<uint64>(start + kPageSize,
+		fPagedMapping->Size()));
+	fPageStart = start;
+	fPageEnd = end;
+	fPageFirstLine = firstLine;
+
+	fEditor->SetReadOnly(false);
+	fEditor->LoadText(fPagedMapping->Data() + start, end - start);
+	fEditor->SendMessage(SCI_SETSAVEPOINT);
+	fEditor->SendMessage(SCI_EMPTYUNDOBUFFER);
+	fEditor->SetReadOnly(true);
+	fEditor->SetFirstLineNumber(firstLine);
+}
+
+
+/**
+ * Loads the page around offset, the start of line, and scrolls it to the
+ * top of the view. The selection is kept if it is still in the page.
+ */
+void
+EditorWindow::_ShowPageAt(uint64 offset, uint64 line)
+{
+	const uint64 caret = fPageStart + fEditor->SendMessage(SCI_GETCURRENTPOS);
+	const uint64 anchor = fPageStart + fEditor->SendMessage(SCI_GETANCHOR);
+
+	const char* data = fPagedMapping->Data();
+	offset = std::max(offset, _PagedTextStart());
+	const uint64 start = _PageLineStart(offset > kPageSize / 2
+		? offset - kPageSize / 2 : 0);
+	const uint64 firstLine = line - std::count(data + start, data + offset, '\n');
+	_LoadPage(start, firstLine);
+
+	const Sci_Position topLine = line - firstLine;
+	if(std::min(caret, anchor) >= fPageStart && std::max(caret, anchor) <= fPageEnd)
+		fEditor->SendMessage(SCI_SETSEL, anchor - fPageStart, caret - fPageStart);
+	else
+		fEditor->SendMessage(SCI_GOTOLINE, topLine);
+	fEditor->SendMessage(SCI_SETFIRSTVISIBLELINE,
+		fEditor->SendMessage(SCI_VISIBLEFROMDOCLINE, topLine));
+}
+
+
+/**
+ * Moves the page along when the view gets within a quarter of a page from
+ * its start or end, keeping the same lines in view.
+ */
+void
+EditorWindow::_ScrollPage()
+{
+	if(fPagedMapping == nullptr)
+		return;
+
+	const Sci_Position firstLine = fEditor->SendMessage(SCI_DOCLINEFROMVISIBLE,
+		fEditor->SendMessage(SCI_GETFIRSTVISIBLELINE));
+	const Sci_Position lastLine = std::min<Sci_Position>(
+		firstLine + fEditor->SendMessage(SCI_LINESONSCREEN),
+		fEditor->SendMessage(SCI_GETLINECOUNT) - 1);
+	const uint64 top = fPageStart
+		+ fEditor->SendMessage(SCI_POSITIONFROMLINE, firstLine);
+	const uint64 bottom = fPageStart
+		+ fEditor->SendMessage(SCI_POSITIONFROMLINE, lastLine);
+	const uint64 margin = kPageSize / 4;
+	if((fPageStart > _PagedTextStart() && top < fPageStart + margin)
+			|| (fPageEnd < fPagedMapping->Size() && bottom + margin > fPageEnd)) {
+		// the file may have shrunk before its change was noticed
+		if(_RemapPaged(fPageFirstLine + firstLine) == true)
+			_ShowPageAt(top, fPageFirstLine + firstLine);
+	}
+}
+
+
+/**
+ * Moves the caret to line, loading the page it is in if needed. Lines past
+ * the part of the file indexed so far are gone to when the indexer gets
+ * there.
+ */
+void
+EditorWindow::_GoToPagedLine(uint64 line)
+{
+	const uint64 lineCount = fEditor->SendMessage(SCI_GETLINECOUNT);
+	// the last line of a page is continued by the next one, unless it is
+	// the last line of the file
+	const uint64 pageLines = fPageEnd < fPagedMapping->Size()
+		? lineCount - 1 : lineCount;
+	if(line < fPageFirstLine || line - fPageFirstLine >= pageLines) {
+		if(_RemapPaged(line) == false)
+			return;
+		LinePosition position;
+		if(fLineIndexer == nullptr || fLineIndexer->Locate(line, position) == false) {
+			fPendingLine = line;
+			return;
+		}
+		// at most a stride of lines to walk from the indexed one
+		const char* data = fPagedMapping->Data();
+		const uint64 size = fPagedMapping->Size();
+		uint64 offset = position.offset;
+		uint64 current = position.line;
+		for(; current < line && offset < size; current++) {
+			const void* newline = memchr(data + offset, '\n', size - offset);
+			if(newline == nullptr)
+				break;
+			offset = static_cast<const char*>(newline) - data + 1;
+		}
+		line = current;
+		_ShowPageAt(offset, line);
+	}
+	fPendingLine = -1;
+	fEditor->SendMessage(SCI_ENSUREVISIBLEENFORCEPOLICY, line - fPageFirstLine);
+	fEditor->SendMessage(SCI_GOTOLINE, line - fPageFirstLine);
+}
+
+
+/**
+ * Goes to the line asked for while it was not indexed yet, once it is.
+ */
+void
+EditorWindow::_IndexingProgress()
+{
+	if(fPendingLine < 0 || fLineIndexer == nullptr)
+		return;
+	LinePosition position;
+	if(fLineIndexer->Locate(fPendingLine, position) == true)
+		_GoToPagedLine(fPendingLine);
+}
+
+
+/**
+ * Files above the size set in preferences are opened in large file mode,
+ * with a document that can exceed 2 GB and, optionally, holds no styles.
+ */
+int
+EditorWindow::_DocumentOptions(off_t size)
+{
+	if(fPreferences->fLargeFileThreshold == 0
+			|| size < static_cast<off_t>(fPreferences->fLargeFileThreshold) * 1024 * 1024)
+		return SC_DOCUMENTOPTION_DEFAULT;
+	int options = SC_DOCUMENTOPTION_TEXT_LARGE;
+	if(fPreferences->fLargeFileDisableStyling)
+		options |= SC_DOCUMENTOPTION_STYLES_NONE;
+	return options;
+}
+
+
+/**
+ * Replaces the text with data in fEncoding. UTF-8 is passed to Scintilla as
+ * is, other encodings are converted in chunks.
+ */
+void
+EditorWindow::_LoadText(const char* data, size_t size)
+{
+	fEditor->SetEncoding(EncodingName(fEncoding));
+	if(fEncoding == TextEncoding::UTF8) {
+		fEditor->LoadText(data, size);
+		return;
+	}
+	if(fEncoding == TextEncoding::UTF8_BOM && size >= 3) {
+		fEditor->LoadText(data + 3, size - 3);
+		return;
+	}
+
+	fEditor->LoadText(nullptr, 0);
+	TextDecoder decoder(fEncoding);
+	std::string decoded;
+	for(size_t offset = 0; offset < size; offset += DocumentLoader::kChunkSize) {
+		decoded.clear();
+		decoder.Decode(std::string_view(data + offset,
+			std::min(size - offset, DocumentLoader::kChunkSize)), decoded);
+		fEditor->SendMessage(SCI_APPENDTEXT, decoded.size(),
+			reinterpret_cast<sptr_t>(decoded.data()));
+	}
+	decoded.clear();
+	decoder.Finish(decoded);
+	fEditor->SendMessage(SCI_APPENDTEXT, decoded.size(),
+		reinterpret_cast<sptr_t>(decoded.data()));
+}
+
+
+/**
+ * Checks whether the text can be saved in the encoding of the file. If not,
+ * offers to save it as UTF-8 instead. Returns false if saving was cancelled.
+ */
+bool
+EditorWindow::_EnsureEncodable()
+{
+	for(const auto& span : fEditor->TextSpans()) {
+		if(CanEncode(fEncoding, span))
+			continue;
+		BString message(B_TRANSLATE("The text contains characters which cannot "
+			"be saved in %encoding%. Do you want to save it as UTF-8 instead?"));
+		message.ReplaceAll("%encoding%", EncodingName(fEncoding));
+		BAlert* alert = new BAlert(B_TRANSLATE("Encoding"), message.String(),
+			B_TRANSLATE("Cancel"), B_TRANSLATE("Save as UTF-8"), nullptr,
+			B_WIDTH_AS_USUAL, B_EVEN_SPACING, B_WARNING_ALERT);
+		alert->SetShortcut(0, B_ESCAPE);
+		if(alert->Go() == 0)
+			return false;
+		fEncoding = TextEncoding::UTF8;
+		fEditor->SetEncoding(EncodingName(fEncoding));
+		return true;
+	}
+	return true;
+}
+
+
+/**
+ * Starts loading the file on a worker thread. Until it is done the editor
+ * shows the beginning of the file and is read-only.
+ */
+status_t
+EditorWindow::_LoadInBackground(File& file, int documentOptions,
+	Sci_Position line, Sci_Position column)
+{
+	// the encoding is guessed from the beginning of the file
+	std::vector<char> buffer(kBackgroundLoadPreviewSize);
+	ssize_t bytesRead = std::max<ssize_t>(
+		file.ReadAt(0, buffer.data(), buffer.size()), 0);
+	std::string preview(buffer.data(), bytesRead);
+	if(fCompression != Compression::NONE) {
+		// decompress only as much as fits in the preview
+		Decompressor decompressor(fCompression);
+		preview.clear();
+		const size_t pieceSize = 4096;
+		for(ssize_t offset = 0; offset < bytesRead
+				&& preview.size() < kBackgroundLoadPreviewSize; offset += pieceSize) {
+			if(decompressor.Decompress(std::string_view(buffer.data() + offset,
+					std::min<size_t>(pieceSize, bytesRead - offset)), preview) == false)
+				break;
+		}
+		if(preview.size() > kBackgroundLoadPreviewSize)
+			preview.resize(kBackgroundLoadPreviewSize);
+	}
+	fEncoding = DetectEncoding(preview.data(), preview.size(), false);
+
+	fDocumentLoader.reset(new DocumentLoader(fEditor, fOpenedFilePath->Path(),
+		BMessenger(this), documentOptions, fEncoding, fCompression));
+	status_t status = fDocumentLoader->Start();
+	if(status != B_OK) {
+		fDocumentLoader.reset();
+		return status;
+	}
+	fLoadingLine = line;
+	fLoadingColumn = column;
+
+	_LoadText(preview.data(), preview.size());
+	fEditor->SendMessage(SCI_SETSAVEPOINT);
+	fEditor->SendMessage(SCI_EMPTYUNDOBUFFER);
+	fEditor->SetReadOnly(true);
+	fEditor->SetProgress(0.0f);
+	return B_OK;
+}
+
+
+void
+EditorWindow::_LoadingFinished(status_t status)
+{
+	if(fDocumentLoader == nullptr)
+		return;
+
+	void* document = fDocumentLoader->TakeDocument();
+	if(status != B_OK || document == nullptr) {
+		if(document != nullptr)
+			fEditor->SendMessage(SCI_RELEASEDOCUMENT, 0, (sptr_t) document);
+		OKAlert(B_TRANSLATE("Open error"), B_TRANSLATE("An error occurred "
+			"while attempting to open the file."), B_STOP_ALERT);
+		// with the loader still set, so that the preview is not left behind
+		// to be saved over the file
+		_CancelLoading();
+		return;
+	}
+	fLineEndings = fDocumentLoader->LineEndings();
+	fFileHasher = fDocumentLoader->FileHasher();
+	fDocumentLoader.reset();
+	fEditor->SetProgress(-1.0f);
+
+	fEditor->SetReadOnly(false);
+	fEditor->SendMessage(SCI_SETDOCPOINTER, 0, (sptr_t) document);
+	fEditor->SendMessage(SCI_RELEASEDOCUMENT, 0, (sptr_t) document);
+	_FinishOpenFile(fLoadingLine, fLoadingColumn);
+}
+
+
+/**
+ * Stops loading the file in the background, if there is one. The window goes
+ * back to an empty, untitled document.
+ */
+void
+EditorWindow::_CancelLoading()
+{
+	if(fDocumentLoader == nullptr)
+		return;
+
+	fDocumentLoader.reset();
+	fEditor->SetProgress(-1.0f);
+	_CloseDocument();
+}
+
+
+/**
+ * Replaces the document with an empty, untitled one.
+ */
+void
+EditorWindow::_CloseDocument()
+{
+	fEditor->SetReadOnly(false);
+	fEditor->SetLargeFileMode(false);
+	fEditor->LoadText(nullptr, 0);
+	fEditor->SendMessage(SCI_SETSAVEPOINT);
+	fEditor->SendMessage(SCI_EMPTYUNDOBUFFER);
+
+	if(fOpenedFilePath != nullptr) {
+		BEntry open(fOpenedFilePath->Path());
+		File::Monitor(&open, false, this);
+		delete fOpenedFilePath;
+		fOpenedFilePath = nullptr;
+	}
+	fOpenedFileModificationTime = -1;
+	fReadOnly = false;
+	fCompression = Compression::NONE;
+	fFileHasher.reset();
+	fEditor->SetRef(entry_ref());
+	RefreshTitle();
+
+	_StartJournal();
+	if(!fPendingJournal.empty())
+		_ReplayJournal();
+}
+
+
+void
+EditorWindow::_FinishOpenFile(Sci_Position line, Sci_Position column)
+{
+	BEntry entry(fOpenedFilePath->Path());
+	File file(&entry, B_READ_ONLY);
+
+	fModifiedOutside = false;
+	_SetFollowOffset(&file);
+
+	fEditor->SendMessage(SCI_SETSAVEPOINT);
+	fEditor->SendMessage(SCI_EMPTYUNDOBUFFER);
+
+	FileState state;
+	fFileStateStore.Read(fOpenedFilePath->Path(), state);
+	if(line != -1) {
+		Sci_Position gotoPos = fEditor->SendMessage(SCI_POSITIONFROMLINE, line - 1);
+		if(column != -1) {
+			gotoPos += column;
+		}
+		fEditor->SendMessage(SCI_GOTOPOS, gotoPos, 0);
+	} else
+		fEditor->SendMessage(SCI_SETSEL, state.anchor, state.caret);
+	fEditor->SetBookmarks(std::vector<int64>(state.bookmarks.begin(),
+		state.bookmarks.end()));
+	fOpenedFileMimeType.SetTo(file.ReadMimeType().c_str());
+
+	_SetLanguageByFilename(fOpenedFilePath->Leaf());
+	fEditor->SetFolds(std::vector<int64>(state.folds.begin(),
+		state.folds.end()));
+	// with no line on record keep the caret in view instead
+	if(line == -1 && state.firstVisibleLine > 0) {
+		// the view has no size until the window is shown for the first time
+		fRestoredFirstLine = state.firstVisibleLine;
+		if(fActivatedGuard == true)
+			_RestoreFirstVisibleLine();
+	}
+
+	fEditor->SetReadOnly(fReadOnly);
+
+	entry_ref ref;
+	entry.GetRef(&ref);
+	fEditor->SetRef(ref);
+
+	be_roster->AddToRecentDocuments(&ref, gAppMime);
+
+	RefreshTitle();
+
+	// load .editorconfig and apply settings
+	_SyncWithPreferences();
+
+	// .editorconfig wins over line endings found in the file
+	if(!fFilePreferences.fEOLMode) {
+		int eolMode = SC_EOL_LF;
+		switch(fLineEndings.Dominant()) {
+			case LineEndingCounter::CRLF:	eolMode = SC_EOL_CRLF; break;
+			case LineEndingCounter::CR:		eolMode = SC_EOL_CR; break;
+			default: break;
+		}
+		fEditor->SetEOLMode(eolMode, fLineEndings.Mixed());
+	} else
+		fEditor->SetEOLMode(*fFilePreferences.fEOLMode, fLineEndings.Mixed());
+
+	_StartJournal();
+	if(!fPendingJournal.empty())
+		_ReplayJournal();
+}
+
+
+/**
+ * Scrolls to the first line visible when the file was last closed. It is
+ * stored as a document line, collapsed folds above it move it up the view.
+ */
+void
+EditorWindow::_RestoreFirstVisibleLine()
+{
+	fEditor->SendMessage(SCI_SETFIRSTVISIBLELINE,
+		fEditor->SendMessage(SCI_VISIBLEFROMDOCLINE, fRestoredFirstLine));
+	fRestoredFirstLine = -1;
+}
+
+
+/**
+ * Starts a new journal for the document, which is now identical to the
+ * opened file.
+ */
+void
+EditorWindow::_StartJournal()
+{
+	if(fOpenedFilePath == nullptr) {
+		fJournal.Start(nullptr, -1, -1);
+		return;
+	}
+
+	BEntry entry(fOpenedFilePath->Path());
+	off_t size;
+	time_t modificationTime = -1;
+	if(entry.GetSize(&size) != B_OK)
+		size = -1;
+	entry.GetModificationTime(&modificationTime);
+	fJournal.Start(fOpenedFilePath->Path(), size, modificationTime);
+}
+
+
+/**
+ * Applies changes from fPendingJournal to the document in a single undo
+ * action. Changes made to a file only apply if it has not been modified since.
+ * The recovered text goes into the journal of this window and the old one is
+ * removed.
+ */
+void
+EditorWindow::_ReplayJournal()
+{
+	const std::string journalPath = fPendingJournal;
+	fPendingJournal.clear();
+
+	RecoveryJournal::Info info;
+	status_t status = RecoveryJournal::ReadInfo(journalPath.c_str(), info);
+	if(status == B_OK && info.fileBase == true) {
+		BEntry entry(info.path.c_str());
+		off_t size = -1;
+		time_t modificationTime = -1;
+		entry.GetSize(&size);
+		entry.GetModificationTime(&modificationTime);
+		if(fOpenedFilePath == nullptr || info.path != fOpenedFilePath->Path()
+				|| size != info.size || modificationTime != info.modificationTime)
+			status = B_MISMATCHED_VALUES;
+	}
+	if(status == B_OK) {
+		fJournal.Stop();
+		Scintilla::UndoAction action(fEditor);
+		status = RecoveryJournal::Replay(journalPath.c_str(),
+			[this](const RecoveryJournal::Change& change) {
+				switch(change.operation) {
+					case RecoveryJournal::SNAPSHOT:
+						fEditor->SendMessage(SCI_TARGETWHOLEDOCUMENT);
+						fEditor->SendMessage(SCI_REPLACETARGET, change.text.size(),
+							reinterpret_cast<sptr_t>(change.text.data()));
+					break;
+					case RecoveryJournal::INSERTION:
+						fEditor->SendMessage(SCI_SETTARGETRANGE, change.position,
+							change.position);
+						fEditor->SendMessage(SCI_REPLACETARGET, change.text.size(),
+							reinterpret_cast<sptr_t>(change.text.data()));
+					break;
+					case RecoveryJournal::DELETION:
+						fEditor->SendMessage(SCI_DELETERANGE, change.position,
+							change.length);
+					break;
+				}
+			});
+	}
+	_StartJournal();
+
+	if(status != B_OK) {
+		BString message(B_TRANSLATE("Unsaved changes of %file% could not be "
+			"restored. The file might have been modified since."));
+		message.ReplaceAll("%file%", info.path.empty()
+			? B_TRANSLATE("Untitled") : info.path.c_str());
+		OKAlert(B_TRANSLATE("Recovery"), message.String(), B_STOP_ALERT);
+	} else {
+		// the journal of this window takes over
+		const auto spans = fEditor->TextSpans();
+		fJournal.Compact(spans);
+	}
+	BEntry(journalPath.c_str()).Remove();
+}
+
+
+void
+EditorWindow::_SetLanguage(std::string lang)
+{
+	fCurrentLanguage = lang;
+	const auto mapping = Languages::ApplyLanguage(fEditor, lang.c_str());
+
+	BFont font;
+	font.SetFamilyAndStyle(fPreferences->fFontFamily.c_str(), nullptr);
+	font.SetSize(fPreferences->fFontSize);
+	BFont *fontPtr = (fPreferences->fUseCustomFont ? &font : nullptr);
+	Styler::ApplyGlobal(fEditor, fPreferences->fStyle.c_str(), fontPtr);
+	Styler::ApplyLanguage(fEditor, mapping);
+
+	fEditor->SetType(Languages::GetMenuItemName(lang));
+
+	fMainMenu->FindItem(EDIT_COMMENTLINE)->SetEnabled(fEditor->CanCommentLine());
+	fMainMenu->FindItem(EDIT_COMMENTBLOCK)->SetEnabled(fEditor->CanCommentBlock());
+	fMainMenu->FindItem(MAINMENU_FILE_OPEN_CORRESPONDING)->SetEnabled(lang == "c" || lang == "cpp");
+
+	fContextMenu->FindItem(EDIT_COMMENTLINE)->SetEnabled(fEditor->CanCommentLine());
+	fContextMenu->FindItem(EDIT_COMMENTBLOCK)->SetEnabled(fEditor->CanCommentBlock());
+
+	// folding margin state can change depending on the language used
+	fEditor->SetFoldMarginEnabled(fPreferences->fFoldMargin);
+}
+
+
+void
+EditorWindow::_SetLanguageByFilename(const char* filename)
+{
+	std::string lang;
+	// foo.log.gz is treated as foo.log
+	const std::string name = StripCompressionExtension(filename);
+	// try to match whole filename first, this is needed for e.g. CMake
+	bool found = Languages::GetLanguageForExtension(name.c_str(), lang);
+	if(found == false) {
+		const std::string extension = GetFileExtension(name);
+		if(!extension.empty())
+			Languages::GetLanguageForExtension(extension.c_str(), lang);
+	}
+	_SetLanguage(lang);
+}
+
+
+void
+EditorWindow::_OpenCorrespondingFile(const BPath &file, const std::string lang)
+{
+	if(lang != "c" && lang != "cpp")
+		return;
+
+	const std::vector<std::string> extensionsToTryC{"h", "hh", "hxx", "hpp"};
+	const std::vector<std::string> extensionsToTryH{"c", "cc", "cxx", "cpp"};
+	const std::vector<std::string>* extensionsToTry = &extensionsToTryC;
+	if(GetFileExtension(file.Leaf())[0] == 'h') {
+		extensionsToTry = &extensionsToTryH;
+	}
+	BPath parent;
+	if(file.GetParent(&parent) == B_OK) {
+		const BDirectory parentDir(parent.Path());
+
+		const std::string filename = GetFileName(file.Leaf());
+		for(auto &ext : *extensionsToTry) {
+			BEntry fileToTry(&parentDir, (filename + '.' + ext).c_str());
+			if(fileToTry.Exists()) {
+				BMessage openFile(B_REFS_RECEIVED);
+				entry_ref ref;
+				if(fileToTry.GetRef(&ref) == B_OK) {
+					openFile.AddRef("refs", &ref);
+					openFile.AddPointer("window", this);
+					be_app->PostMessage(&openFile);
+					return;
+				}
+			}
+		}
+		OKAlert(B_TRANSLATE("Open partner file"),
+			B_TRANSLATE("Partner file not found."), B_STOP_ALERT);
+	}
+}
+
+
+void
+EditorWindow::_LoadEditorconfig()
+{
+	if(fOpenedFilePath == nullptr) return;
 
 	BPath editorconfig;
 	if(Editorconfig::Find(fOpenedFilePath, &editorconfig)) {
@@ -1356,7 +2807,8 @@ EditorWindow::_SyncWithPreferences()
 			fEditor->SendMessage(SCI_SETINDENTATIONGUIDES, 0, 0);
 		}
 
-		if(fPreferences->fWrapLines == true) {
+		// wrapping needs to lay out every line of the document
+		if(fPreferences->fWrapLines == true && !fEditor->LargeFileMode()) {
 			fEditor->SendMessage(SCI_SETWRAPMODE, SC_WRAP_WORD, 0);
 		} else {
 			fEditor->SendMessage(SCI_SETWRAPMODE, SC_WRAP_NONE, 0);
@@ -1368,6 +2820,8 @@ EditorWindow::_SyncWithPreferences()
 		fEditor->SetChangeMarginEnabled(fPreferences->fChangeMargin);
 		fEditor->SetBracesHighlightingEnabled(
 			fPreferences->fBracesHighlighting);
+		fEditor->SetOccurrencesHighlightingEnabled(
+			fPreferences->fHighlightOccurrences);
 		fEditor->SetTrailingWSHighlightingEnabled(
 			fPreferences->fHighlightTrailingWhitespace);
 
@@ -1562,6 +3016,99 @@ EditorWindow::_ShowInTracker()
 }
 
 
+/**
+ * Starts finding every match of the search in message on a worker thread and
+ * shows them in the results window as they come. The worker searches a copy
+ * of the document, or of the selection, so the editor stays responsive.
+ */
+void
+EditorWindow::_FindAll(BMessage* message)
+{
+	_StopFindAll();
+
+	auto spans = fEditor->TextSpans();
+	uint64 offset = 0;
+	uint64 firstLine = std::max<int64>(fEditor->FirstLineNumber(), 0);
+	if(message->GetBool("inSelection", false) == true) {
+		const Sci_Position start = fEditor->SendMessage(SCI_GETSELECTIONSTART);
+		const Sci_Position end = fEditor->SendMessage(SCI_GETSELECTIONEND);
+		// cut the selection out of the spans
+		Sci_Position spanStart = 0;
+		for(auto& span : spans) {
+			const Sci_Position spanEnd = spanStart + span.size();
+			const Sci_Position from = std::clamp(start, spanStart, spanEnd);
+			const Sci_Position to = std::clamp(end, spanStart, spanEnd);
+			span = span.substr(from - spanStart, to - from);
+			spanStart = spanEnd;
+		}
+		offset = start;
+		firstLine += fEditor->SendMessage(SCI_LINEFROMPOSITION, start);
+	}
+
+	auto finder = std::make_shared<MatchFinder>(
+		message->GetString("findText", ""),
+		message->GetBool("matchCase", false),
+		message->GetBool("matchWord", false),
+		message->GetBool("regex", false),
+		spans, offset, firstLine, fEditor->ChangeCount(), BMessenger(this));
+	if(finder->IsValid() == false) {
+		OKAlert(B_TRANSLATE("Find all"), B_TRANSLATE("The regular expression "
+			"is not valid."), B_STOP_ALERT);
+		return;
+	}
+	if(finder->Start() != B_OK) {
+		OKAlert(B_TRANSLATE("Find all"), B_TRANSLATE("Could not start "
+			"searching."), B_STOP_ALERT);
+		return;
+	}
+	fMatchFinder = finder;
+
+	if(fFindResultsWindow == nullptr)
+		fFindResultsWindow = new FindResultsWindow(this);
+	if(fFindResultsWindow->Lock()) {
+		fFindResultsWindow->SetFinder(fMatchFinder);
+		if(fFindResultsWindow->IsHidden())
+			fFindResultsWindow->Show();
+		fFindResultsWindow->Unlock();
+	}
+	_UpdateMatchStatus();
+}
+
+
+/**
+ * Cancels Find All and clears its results, as they no longer match the
+ * document or the search.
+ */
+void
+EditorWindow::_StopFindAll()
+{
+	if(fMatchFinder == nullptr)
+		return;
+	fMatchFinder->Cancel();
+	fMatchFinder.reset();
+	if(fFindResultsWindow != nullptr && fFindResultsWindow->Lock()) {
+		fFindResultsWindow->SetFinder(nullptr);
+		fFindResultsWindow->Unlock();
+	}
+	fEditor->SetMatchStatus(-1, -1, false);
+}
+
+
+/**
+ * Shows in the status view which of the Find All matches is selected.
+ */
+void
+EditorWindow::_UpdateMatchStatus()
+{
+	if(fMatchFinder == nullptr)
+		return;
+	const Sci_Position start = fEditor->SendMessage(SCI_GETSELECTIONSTART);
+	const Sci_Position end = fEditor->SendMessage(SCI_GETSELECTIONEND);
+	fEditor->SetMatchStatus(fMatchFinder->IndexOf(start, end),
+		fMatchFinder->CountMatches(), fMatchFinder->IsFinished());
+}
+
+
 /**
  * left parameter specifies whether savepoint was left or reached.
  */
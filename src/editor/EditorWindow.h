@@ -6,9 +6,11 @@
 #ifndef EDITORWINDOW_H
 #define EDITORWINDOW_H
 
+#include <array>
 #include <memory>
 #include <optional>
 #include <string>
+#include <string_view>
 
 #include <Catalog.h>
 #include <MimeType.h>
@@ -19,19 +21,35 @@
 
 #include <ScintillaView.h>
 
+#include "Compression.h"
+#include "Encoding.h"
+#include "FileStateStore.h"
+#include "Hash.h"
 #include "Languages.h"
+#include "LineEndings.h"
+#include "RecoveryJournal.h"
 
 
 struct entry_ref;
 class BFilePanel;
 class BMenu;
 class BMenuBar;
+class BMessageRunner;
 class BPath;
 class BPopUpMenu;
+class BScrollView;
 class BookmarksWindow;
+class DocumentLoader;
+class DocumentSaver;
 class Editor;
+class File;
+class FileMapping;
 class FindReplaceHandler;
+class FindResultsWindow;
 class GoToLineWindow;
+class HexView;
+class LineIndexer;
+class MatchFinder;
 class Preferences;
 class StatusView;
 class ToolBar;
@@ -48,6 +66,7 @@ enum {
 	MAINMENU_FILE_NEW					= 'mnew',
 	MAINMENU_FILE_OPEN					= 'mopn',
 	MAINMENU_FILE_RELOAD				= 'mrld',
+	MAINMENU_FILE_LOCAL_HISTORY			= 'mlhs',
 	MAINMENU_FILE_SAVE					= 'msav',
 	MAINMENU_FILE_SAVEAS				= 'msva',
 	MAINMENU_FILE_TOGGLE_READONLY		= 'mtgl',
@@ -72,6 +91,7 @@ enum {
 	MAINMENU_VIEW_SPECIAL_EOL			= 'vseo',
 	MAINMENU_VIEW_TOOLBAR				= 'vstl',
 	MAINMENU_VIEW_WRAPLINES				= 'mvwl',
+	MAINMENU_VIEW_FOLLOW				= 'mvfo',
 	MAINMENU_VIEW_EXPANDFOLDS			= 'mvef',
 	MAINMENU_VIEW_COLLAPSEFOLDS			= 'mvcf',
 	MAINMENU_VIEW_COLLAPSETOPFOLDS		= 'mvct',
@@ -100,6 +120,9 @@ enum {
 
 	FILE_OPEN							= 'flop',
 	FILE_SAVE							= 'flsv',
+	FILE_LOAD_CANCEL					= 'flcn',
+	FILE_STAT_CHANGED					= 'flsc',
+	JOURNAL_SYNC						= 'jrsy',
 
 	WINDOW_NEW							= 'ewnw',
 	WINDOW_CLOSE						= 'ewcl',
@@ -120,6 +143,8 @@ public:
 								Sci_Position column = -1);
 			void			RefreshTitle();
 			void			SaveFile(entry_ref* ref);
+			void			RecoverJournal(const char* journalPath);
+			void			ReadStdin() { fReadingStdin = true; }
 
 			bool			QuitRequested();
 			void			MessageReceived(BMessage* message);
@@ -156,10 +181,16 @@ private:
 			bool			fModifiedOutside;
 			bool			fModified;
 			bool			fReadOnly;
+			TextEncoding	fEncoding;
+			Compression		fCompression;
+			LineEndingCounter	fLineEndings;
 			Editor*			fEditor;
+			HexView*		fHexView;
+			BScrollView*	fHexScrollView;
 			BFilePanel*		fOpenPanel;
 			BFilePanel*		fSavePanel;
 			BMenu*			fOpenRecentMenu;
+			BMenu*			fLocalHistoryMenu;
 			BMenu*			fLanguageMenu;
 			BMenu*			fWindowsMenu;
 			BMenuItem*		fReadWriteMenuItem;
@@ -175,13 +206,93 @@ private:
 			BMessage*		fOnQuitReplyToMessage;
 
 			FindReplaceHandler*	fFindReplaceHandler;
+			// Find All searching in the background and its results
+			std::shared_ptr<MatchFinder>	fMatchFinder;
+			FindResultsWindow*	fFindResultsWindow;
+
+			std::unique_ptr<DocumentLoader>	fDocumentLoader;
+			std::unique_ptr<DocumentSaver>	fDocumentSaver;
+			uint64			fSaveChangeCount;
+			Sci_Position	fLoadingLine;
+			Sci_Position	fLoadingColumn;
+
+			RecoveryJournal	fJournal;
+			std::unique_ptr<BMessageRunner>	fJournalRunner;
+			std::string		fPendingJournal;
+
+			FileStateStore	fFileStateStore;
+
+			off_t			fFollowOffset;
+			bool			fFollow;
+			// a stream of standard input is attached to the window
+			bool			fReadingStdin;
+			// the text came from standard input and exists nowhere else
+			bool			fHeldStdin;
+			// decodes text appended to the document
+			std::unique_ptr<TextDecoder>	fAppendDecoder;
+
+			// the file as last loaded or saved
+			std::optional<Hasher>	fFileHasher;
+
+			std::unique_ptr<BMessageRunner>	fStatRunner;
+			dev_t			fVolumeDevice;
+			bool			fVolumeReadOnly;
+			Sci_Position	fRestoredFirstLine;
+
+			// files too big to load are shown a page at a time
+			std::unique_ptr<FileMapping>	fPagedMapping;
+			std::unique_ptr<LineIndexer>	fLineIndexer;
+			uint64			fPageStart;
+			uint64			fPageEnd;
+			uint64			fPageFirstLine;
+			// line to go to once the indexer gets there, -1 if none
+			int64			fPendingLine;
 
 	static	Preferences*	fPreferences;
 			FilePreferences	fFilePreferences;
 
 			void			_PopulateOpenRecentMenu(BMenu* menu);
 			void			_PopulateLanguageMenu();
+			void			_PopulateLocalHistoryMenu();
+			void			_RestoreRevision(int32 index);
+			BPath			_LocalHistoryPath();
 			void			_ReloadFile(entry_ref* ref = nullptr);
+			bool			_ReloadChanges();
+			void			_StatChanged();
+			bool			_FileChanged();
+			bool			_FileHolds(const std::string& path,
+								const std::array<std::string_view, 2>& spans);
+			void			_SetFollowOffset(BFile* file);
+			bool			_FollowFile();
+			void			_AppendData(std::string_view data);
+			void			_AppendStdin(std::string_view data);
+			void			_FinishStdin();
+			void			_ShowHexView(bool show);
+			off_t			_PagedViewSize();
+			status_t		_OpenPaged(Sci_Position line);
+			void			_ClosePaged();
+			bool			_RemapPaged(uint64 line);
+			uint64			_PagedTextStart() const;
+			uint64			_PageLineStart(uint64 offset);
+			uint64			_PageLineEnd(uint64 offset);
+			void			_LoadPage(uint64 start, uint64 firstLine);
+			void			_ShowPageAt(uint64 offset, uint64 line);
+			void			_ScrollPage();
+			void			_GoToPagedLine(uint64 line);
+			void			_IndexingProgress();
+			int				_DocumentOptions(off_t size);
+			void			_LoadText(const char* data, size_t size);
+			bool			_EnsureEncodable();
+			status_t		_LoadInBackground(File& file, int documentOptions,
+								Sci_Position line, Sci_Position column);
+			void			_LoadingFinished(status_t status);
+			void			_CancelLoading();
+			void			_CloseDocument();
+			void			_FinishOpenFile(Sci_Position line,
+								Sci_Position column);
+			void			_RestoreFirstVisibleLine();
+			void			_StartJournal();
+			void			_ReplayJournal();
 			void			_SetLanguage(std::string lang);
 			void			_SetLanguageByFilename(const char* filename);
 			void			_OpenCorrespondingFile(const BPath &file, const std::string lang);
@@ -193,8 +304,13 @@ private:
 			void			_ShowToolbarPopUp(BPopUpMenu* menu, BButton* button);
 			void			_ReloadAlert(const char* title, const char* message);
 			void			_Save();
+			void			_WaitForSave();
+			void			_SavingFinished(status_t status);
 			void			_OpenTerminal();
 			void			_ShowInTracker();
+			void			_FindAll(BMessage* message);
+			void			_StopFindAll();
+			void			_UpdateMatchStatus();
 
 			void			OnSavePoint(bool left);
 };
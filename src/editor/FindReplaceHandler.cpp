@@ -12,12 +12,103 @@
 #include <Messenger.h>
 #include <ScintillaView.h>
 
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+#include "Editor.h"
+#include "TextSearch.h"
+
 
 namespace Sci = Scintilla;
 using namespace Sci::Properties;
 
 
-FindReplaceHandler::FindReplaceHandler(BScintillaView* editor,
+namespace {
+
+/**
+ * Part of the replacement text: either literal text or, with group set,
+ * the text matched by that regex group (0 is the whole match).
+ */
+struct ReplacementPiece {
+	std::string	text;
+	int			group = -1;
+};
+
+
+/**
+ * Splits a regex replacement into pieces once, instead of for every match.
+ * Escapes are the same as in SCI_REPLACETARGETRE: \0 to \9 are groups,
+ * \a, \b, \f, \n, \r, \t, \v and \\ are control characters and
+ * a backslash, any other character after a backslash is kept with it.
+ */
+std::vector<ReplacementPiece>
+ParseReplacement(const std::string& replace, bool regex)
+{
+	std::vector<ReplacementPiece> pieces(1);
+	if(regex == false) {
+		pieces.back().text = replace;
+		return pieces;
+	}
+	for(size_t i = 0; i < replace.size(); i++) {
+		if(replace[i] != '\\' || i + 1 == replace.size()) {
+			pieces.back().text += replace[i];
+			continue;
+		}
+		const char escaped = replace[++i];
+		switch(escaped) {
+			case 'a': pieces.back().text += '\a'; break;
+			case 'b': pieces.back().text += '\b'; break;
+			case 'f': pieces.back().text += '\f'; break;
+			case 'n': pieces.back().text += '\n'; break;
+			case 'r': pieces.back().text += '\r'; break;
+			case 't': pieces.back().text += '\t'; break;
+			case 'v': pieces.back().text += '\v'; break;
+			case '\\': pieces.back().text += '\\'; break;
+			default:
+				if(escaped >= '0' && escaped <= '9') {
+					pieces.push_back({ "", escaped - '0' });
+					pieces.emplace_back();
+				} else {
+					pieces.back().text += '\\';
+					pieces.back().text += escaped;
+				}
+			break;
+		}
+	}
+	return pieces;
+}
+
+
+/**
+ * Appends the replacement of a match to out. Groups are taken from the
+ * regex match, which is empty for plain searches.
+ */
+void
+AppendReplacement(std::string& out, const std::vector<ReplacementPiece>& pieces,
+	std::string_view text, const RegexMatch& match)
+{
+	for(const auto& piece : pieces) {
+		if(piece.group == -1)
+			out += piece.text;
+		else
+			out += match.Group(text, piece.group);
+	}
+}
+
+
+std::string_view
+DocumentText(BScintillaView* editor)
+{
+	return std::string_view(
+		reinterpret_cast<const char*>(editor->SendMessage(SCI_GETCHARACTERPOINTER)),
+		editor->SendMessage(SCI_GETLENGTH));
+}
+
+}
+
+
+FindReplaceHandler::FindReplaceHandler(Editor* editor,
 	BHandler* replyHandler)
 	:
 	fEditor(editor),
@@ -25,7 +116,7 @@ FindReplaceHandler::FindReplaceHandler(BScintillaView* editor,
 	fSearchTarget(-1, -1),
 	fSearchLastResult(-1, -1),
 	fSearchLast(""),
-	fSearchLastFlags(0)
+	fIncrementalChangeCount(0)
 {
 	fIncrementalSearchFilter = new IncrementalSearchMessageFilter(this);
 }
@@ -53,17 +144,19 @@ FindReplaceHandler::MessageReceived(BMessage* message)
 			fIncrementalSearch = true;
 			fSavedSelection = { anchor, current };
 		}
-		Sci_Position start = std::min(anchor, current);
-		Sci_Position pos = _Find(fIncrementalSearchTerm, start, length, false, false, false);
-
-		if(pos == -1) {
-			pos = _Find(fIncrementalSearchTerm, 0, start, false, false, false);
+		// occurrences found before are of another text
+		if(fEditor->ChangeCount() != fIncrementalChangeCount) {
+			fIncrementalMatches.Reset();
+			fIncrementalChangeCount = fEditor->ChangeCount();
 		}
-
-		if(pos == -1) {
+		const Sci_Position start = std::min(anchor, current);
+		size_t matchStart, matchEnd;
+		if(fIncrementalMatches.Find(DocumentText(fEditor),
+				fIncrementalSearchTerm, start, matchStart, matchEnd) == false) {
 			Set<Selection>(fSavedSelection);
 		} else {
-			Set<Selection>(Get<SearchTarget>());
+			Set<Selection>({ static_cast<Sci_Position>(matchStart),
+				static_cast<Sci_Position>(matchEnd) });
 		}
 	};
 
@@ -74,14 +167,21 @@ FindReplaceHandler::MessageReceived(BMessage* message)
 			}
 			// fallthrough
 		case REPLACE: {
-			int replaceMsg = (info.regex ? SCI_REPLACETARGETRE : SCI_REPLACETARGET);
 			if(fSearchLastResult != Sci::Range{ -1, -1 }) {
 				// we need to search again, because whitespace highlighting messes with
 				// the results
-				Set<SearchFlags>(fSearchLastFlags);
-				Set<SearchTarget>(fSearchLastResult);
-				fEditor->SendMessage(SCI_SEARCHINTARGET, (uptr_t) fSearchLastInfo.find.size(), (sptr_t) fSearchLastInfo.find.c_str());
-				fEditor->SendMessage(replaceMsg, -1, (sptr_t) info.replace.c_str());
+				const Sci_Position pos = _Find(fSearchLastInfo.find,
+					fSearchLastResult.first, fSearchLastResult.second,
+					fSearchLastInfo.matchCase, fSearchLastInfo.matchWord,
+					fSearchLastInfo.regex);
+				if(pos != -1) {
+					std::string replacement;
+					AppendReplacement(replacement,
+						ParseReplacement(info.replace, fSearchLastInfo.regex),
+						DocumentText(fEditor), fRegexMatch);
+					fEditor->SendMessage(SCI_REPLACETARGET, replacement.size(),
+						(sptr_t) replacement.data());
+				}
 				Sci::Range target = Get<SearchTarget>();
 				if(fSearchLastInfo.backwards == true) {
 					std::swap(target.first, target.second);
@@ -158,22 +258,9 @@ FindReplaceHandler::MessageReceived(BMessage* message)
 			fSearchLastInfo = info;
 		} break;
 		case REPLACEALL: {
-			Sci::UndoAction action(fEditor);
-			int replaceMsg = (info.regex ? SCI_REPLACETARGETRE : SCI_REPLACETARGET);
-			int occurences = 0;
 			fEditor->SendMessage(info.inSelection ? SCI_TARGETFROMSELECTION : SCI_TARGETWHOLEDOCUMENT);
-			auto target = Get<SearchTarget>();
-			Sci_Position pos;
-			do {
-				pos = _Find(info.find, target.first, target.second,
-					info.matchCase, info.matchWord, info.regex);
-				if(pos != -1) {
-					fEditor->SendMessage(replaceMsg, -1, (sptr_t) info.replace.c_str());
-					target.first = Get<SearchTargetEnd>();
-					target.second = fEditor->SendMessage(SCI_GETLENGTH);
-					occurences++;
-				}
-			} while(pos != -1);
+			const auto target = Get<SearchTarget>();
+			const int32 occurences = _ReplaceAll(info, target.first, target.second);
 			if(fReplyHandler != nullptr) {
 				BMessage reply(REPLACEALL);
 				reply.AddInt32("replaced", occurences);
@@ -187,6 +274,10 @@ FindReplaceHandler::MessageReceived(BMessage* message)
 		} break;
 		case INCREMENTAL_SEARCH_BACKSPACE: {
 			if(!fIncrementalSearchTerm.empty()) {
+				// a whole character, its continuation bytes first
+				while((fIncrementalSearchTerm.back() & 0xC0) == 0x80
+						&& fIncrementalSearchTerm.size() > 1)
+					fIncrementalSearchTerm.pop_back();
 				fIncrementalSearchTerm.pop_back();
 				incrementalSearch();
 			}
@@ -194,6 +285,7 @@ FindReplaceHandler::MessageReceived(BMessage* message)
 		case INCREMENTAL_SEARCH_CANCEL: {
 			fIncrementalSearch = false;
 			fIncrementalSearchTerm = "";
+			fIncrementalMatches.Reset();
 			Set<Selection>(fSavedSelection);
 			Looper()->RemoveCommonFilter(fIncrementalSearchFilter);
 		} break;
@@ -203,6 +295,7 @@ FindReplaceHandler::MessageReceived(BMessage* message)
 			si.wrapAround = true;
 			si.find = fIncrementalSearchTerm;
 			fIncrementalSearchTerm = "";
+			fIncrementalMatches.Reset();
 			Looper()->RemoveCommonFilter(fIncrementalSearchFilter);
 		} break;
 	}
@@ -242,26 +335,136 @@ FindReplaceHandler::IncrementalSearchMessageFilter::Filter(BMessage* message, BH
 
 
 
+/**
+ * Searches from start to end, backwards if end is before start, and sets the
+ * search target to the match. Regexes and plain text which TextSearch finds
+ * on its own are matched like in Find All: regexes by Koder's own engine,
+ * which takes linear time whatever the pattern, plain text scanned in the
+ * document's buffer, many bytes at a time. Groups of the match are kept in
+ * fRegexMatch. Returns the start of the match or -1.
+ */
 Sci_Position
 FindReplaceHandler::_Find(std::string search, Sci_Position start,
 	Sci_Position end, bool matchCase, bool matchWord, bool regex)
 {
-	int searchFlags = 0;
-	if(matchCase == true)
-		searchFlags |= SCFIND_MATCHCASE;
-	if(matchWord == true)
-		searchFlags |= SCFIND_WHOLEWORD;
-	if(regex == true)
-		searchFlags |= SCFIND_REGEXP | SCFIND_CXX11REGEX;
-	Set<SearchFlags>(searchFlags);
-	fSearchLastFlags = searchFlags;
-
-	Set<SearchTarget>({start, end});
-
 	fSearchLast = search;
-	Sci_Position pos = fEditor->SendMessage(SCI_SEARCHINTARGET,
-		(uptr_t) search.size(), (sptr_t) search.c_str());
-	return pos;
+	fRegexMatch.groups.clear();
+	const TextSearch textSearch(search, matchCase, matchWord, regex);
+	if(regex == false && textSearch.IsLiteral() == false) {
+		// Scintilla folds case of any character and knows the word
+		// characters set by the lexer, Find All only approximates both,
+		// so these matches may have no index in the status
+		int searchFlags = 0;
+		if(matchCase == true)
+			searchFlags |= SCFIND_MATCHCASE;
+		if(matchWord == true)
+			searchFlags |= SCFIND_WHOLEWORD;
+		Set<SearchFlags>(searchFlags);
+		Set<SearchTarget>({start, end});
+		return fEditor->SendMessage(SCI_SEARCHINTARGET,
+			(uptr_t) search.size(), (sptr_t) search.c_str());
+	}
+	if(textSearch.IsValid() == false)
+		return -1;
+
+	const Sci_Position low = std::min(start, end);
+	const Sci_Position high = std::max(start, end);
+	// plain text is looked for only in the range, which leaves the gap of
+	// the buffer where it is; assertions of regexes look around it
+	std::string_view text;
+	Sci_Position offset = 0;
+	if(textSearch.IsLiteral() == true) {
+		text = std::string_view(reinterpret_cast<const char*>(
+			fEditor->SendMessage(SCI_GETRANGEPOINTER, low, high - low)), high - low);
+		offset = low;
+	} else
+		text = DocumentText(fEditor);
+	if(textSearch.Search(text, low - offset, high - offset, start > end,
+			fRegexMatch) == false) {
+		fRegexMatch.groups.clear();
+		return -1;
+	}
+	for(auto& group : fRegexMatch.groups) {
+		if(group.first != RegexMatch::npos) {
+			group.first += offset;
+			group.second += offset;
+		}
+	}
+	Set<SearchTarget>({ static_cast<Sci_Position>(fRegexMatch.Start()),
+		static_cast<Sci_Position>(fRegexMatch.End()) });
+	return fRegexMatch.Start();
+}
+
+
+/**
+ * Replaces every match between start and end in a single change. Matches
+ * are searched for in the unchanged document while the text from the first
+ * to the last one is rebuilt with replacements, which is then put in place
+ * of the old text at once. Replacing match by match would move the gap of
+ * the buffer and notify about the change every time.
+ * The selection is moved as if each match was replaced on its own.
+ * Returns the number of replaced matches.
+ */
+int32
+FindReplaceHandler::_ReplaceAll(const search_info& info, Sci_Position start,
+	Sci_Position end)
+{
+	const auto pieces = ParseReplacement(info.replace, info.regex);
+	const std::string_view text = DocumentText(fEditor);
+	const Sci_Position anchor = fEditor->SendMessage(SCI_GETANCHOR);
+	const Sci_Position current = fEditor->SendMessage(SCI_GETCURRENTPOS);
+	Sci_Position newAnchor = anchor;
+	Sci_Position newCurrent = current;
+
+	std::string replaced;
+	Sci_Position first = -1;
+	// end of the text already in replaced
+	Sci_Position copied = start;
+	// change in length so far
+	Sci_Position delta = 0;
+	int32 occurences = 0;
+	while(start <= end) {
+		const Sci_Position matchStart = _Find(info.find, start, end,
+			info.matchCase, info.matchWord, info.regex);
+		if(matchStart == -1)
+			break;
+		const Sci_Position matchEnd = Get<SearchTargetEnd>();
+		if(first == -1)
+			first = copied = matchStart;
+		replaced.append(text.substr(copied, matchStart - copied));
+
+		const size_t replacementStart = replaced.size();
+		AppendReplacement(replaced, pieces, text, fRegexMatch);
+		const Sci_Position deltaBefore = delta;
+		delta += static_cast<Sci_Position>(replaced.size() - replacementStart)
+			- (matchEnd - matchStart);
+		for(auto [position, mapped] : { std::pair(anchor, &newAnchor),
+				std::pair(current, &newCurrent) }) {
+			if(position >= matchEnd)
+				*mapped = position + delta;
+			else if(position > matchStart)
+				*mapped = matchStart + deltaBefore;
+		}
+		copied = matchEnd;
+		occurences++;
+
+		if(matchEnd > matchStart)
+			start = matchEnd;
+		else if(matchEnd < end)
+			// an empty match would be found again
+			start = fEditor->SendMessage(SCI_POSITIONAFTER, matchEnd);
+		else
+			break;
+	}
+	if(occurences == 0)
+		return 0;
+
+	Sci::UndoAction action(fEditor);
+	Set<SearchTarget>({ first, copied });
+	fEditor->SendMessage(SCI_REPLACETARGET, replaced.size(),
+		(sptr_t) replaced.data());
+	fEditor->SendMessage(SCI_SETSEL, newAnchor, newCurrent);
+	return occurences;
 }
 
 
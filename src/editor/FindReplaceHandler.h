@@ -12,10 +12,12 @@
 #include <Message.h>
 #include <MessageFilter.h>
 
+#include "NarrowingSearch.h"
+#include "Regex.h"
 #include "ScintillaUtils.h"
 
 
-class BScintillaView;
+class Editor;
 
 
 class FindReplaceHandler : public BHandler {
@@ -26,7 +28,7 @@ public:
 		REPLACEFIND	= 'fnrp',
 		REPLACEALL	= 'rpla',
 	};
-					FindReplaceHandler(BScintillaView* editor,
+					FindReplaceHandler(Editor* editor,
 						BHandler* replyHandler = nullptr);
 					~FindReplaceHandler();
 	virtual void	MessageReceived(BMessage* message);
@@ -79,6 +81,8 @@ private:
 	Sci_Position	_Find(std::string search, Sci_Position start,
 							Sci_Position end, bool matchCase, bool matchWord,
 							bool regex);
+	int32			_ReplaceAll(const search_info& info, Sci_Position start,
+						Sci_Position end);
 	search_info		_UnpackSearchMessage(BMessage& message);
 
 	template<typename T>
@@ -86,18 +90,23 @@ private:
 	template<typename T>
 	void				Set(typename T::type value) { T::Set(fEditor, value); }
 
-	BScintillaView*	fEditor;
+	Editor*		fEditor;
 	BHandler*		fReplyHandler;
 
 	Scintilla::Range	fSearchTarget;
 	Scintilla::Range	fSearchLastResult;
 	std::string			fSearchLast;
-	int					fSearchLastFlags;
 	bool				fNewSearch;
 	search_info			fSearchLastInfo;
+	// groups of the last regex match
+	RegexMatch			fRegexMatch;
 
 	bool				fIncrementalSearch;
 	std::string			fIncrementalSearchTerm;
+	// occurrences of the terms typed so far
+	NarrowingSearch		fIncrementalMatches;
+	// Editor::ChangeCount() the occurrences were found at
+	uint64				fIncrementalChangeCount;
 	Scintilla::Range	fSavedSelection;
 	BMessageFilter*		fIncrementalSearchFilter;
 };
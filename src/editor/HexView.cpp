@@ -0,0 +1,250 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include "HexView.h"
+
+#include <File.h>
+#include <ScrollBar.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+
+namespace {
+
+const int64 kBytesPerRow = 16;
+const float kInset = 4.0f;
+const char kHexDigits[] = "0123456789abcdef";
+// longest row: 16 digit offset, hex and ASCII columns, spacing
+const size_t kMaxRowLength = 128;
+
+}
+
+
+HexView::HexView()
+	:
+	BView("hexView", B_WILL_DRAW | B_FRAME_EVENTS | B_NAVIGABLE),
+	fSize(0),
+	fTopRow(0),
+	fOffsetDigits(8),
+	fSettingScrollBar(false)
+{
+	SetFont(be_fixed_font);
+	font_height height;
+	GetFontHeight(&height);
+	fRowHeight = ceilf(height.ascent + height.descent + height.leading);
+	fAscent = ceilf(height.ascent);
+}
+
+
+HexView::~HexView()
+{
+}
+
+
+/**
+ * Shows the file at path. The position is kept, so that a file which has
+ * changed can be opened again without jumping to the start.
+ */
+status_t
+HexView::SetFile(const char* path)
+{
+	auto file = std::make_unique<BFile>(path, B_READ_ONLY);
+	status_t status = file->InitCheck();
+	off_t size;
+	if(status != B_OK || (status = file->GetSize(&size)) != B_OK)
+		return status;
+	fFile = std::move(file);
+	fSize = size;
+
+	fOffsetDigits = 8;
+	while(fOffsetDigits < 16
+			&& (static_cast<uint64>(size) >> (fOffsetDigits * 4)) != 0)
+		fOffsetDigits += 2;
+
+	_UpdateScrollBar();
+	Invalidate();
+	return B_OK;
+}
+
+
+void
+HexView::Unset()
+{
+	fFile.reset();
+	fSize = 0;
+	fTopRow = 0;
+	_UpdateScrollBar();
+	Invalidate();
+}
+
+
+void
+HexView::AttachedToWindow()
+{
+	SetViewUIColor(B_DOCUMENT_BACKGROUND_COLOR);
+	SetLowUIColor(B_DOCUMENT_BACKGROUND_COLOR);
+	SetHighUIColor(B_DOCUMENT_TEXT_COLOR);
+	_UpdateScrollBar();
+}
+
+
+void
+HexView::Draw(BRect updateRect)
+{
+	if(fFile == nullptr)
+		return;
+
+	const int64 first = fTopRow + static_cast<int64>(updateRect.top / fRowHeight);
+	const int64 last = std::min(_RowCount() - 1,
+		fTopRow + static_cast<int64>(updateRect.bottom / fRowHeight));
+	if(last < first)
+		return;
+	// a file truncated since it was opened just reads short
+	std::vector<uint8> bytes((last - first + 1) * kBytesPerRow);
+	const ssize_t bytesRead = std::max<ssize_t>(fFile->ReadAt(
+		first * kBytesPerRow, bytes.data(), bytes.size()), 0);
+	char line[kMaxRowLength];
+	for(int64 row = first; row <= last; row++) {
+		const size_t index = (row - first) * kBytesPerRow;
+		const size_t count = std::min<ssize_t>(kBytesPerRow,
+			std::max<ssize_t>(bytesRead - index, 0));
+		_FormatRow(row * kBytesPerRow, bytes.data() + index, count, line);
+		DrawString(line, BPoint(kInset, (row - fTopRow) * fRowHeight + fAscent));
+	}
+}
+
+
+void
+HexView::FrameResized(float width, float height)
+{
+	BView::FrameResized(width, height);
+	_UpdateScrollBar();
+}
+
+
+void
+HexView::KeyDown(const char* bytes, int32 numBytes)
+{
+	const int64 page = std::max<int64>(_VisibleRows() - 1, 1);
+	switch(bytes[0]) {
+		case B_UP_ARROW:	_ScrollToRow(fTopRow - 1); break;
+		case B_DOWN_ARROW:	_ScrollToRow(fTopRow + 1); break;
+		case B_PAGE_UP:		_ScrollToRow(fTopRow - page); break;
+		case B_PAGE_DOWN:	_ScrollToRow(fTopRow + page); break;
+		case B_HOME:		_ScrollToRow(0); break;
+		case B_END:			_ScrollToRow(_RowCount()); break;
+		default:
+			BView::KeyDown(bytes, numBytes);
+		break;
+	}
+}
+
+
+void
+HexView::MouseDown(BPoint where)
+{
+	MakeFocus(true);
+	BView::MouseDown(where);
+}
+
+
+/**
+ * Called by the scroll bar, where.y is the first visible row.
+ */
+void
+HexView::ScrollTo(BPoint where)
+{
+	if(fSettingScrollBar == true)
+		return;
+	_ScrollToRow(llroundf(where.y));
+}
+
+
+int64
+HexView::_RowCount() const
+{
+	return (fSize + kBytesPerRow - 1) / kBytesPerRow;
+}
+
+
+int64
+HexView::_VisibleRows() const
+{
+	return static_cast<int64>(Bounds().Height() / fRowHeight);
+}
+
+
+void
+HexView::_ScrollToRow(int64 row)
+{
+	row = std::clamp<int64>(row, 0,
+		std::max<int64>(_RowCount() - _VisibleRows(), 0));
+	if(row == fTopRow)
+		return;
+	fTopRow = row;
+	Invalidate();
+
+	// a float can't hold every row of a big file, don't let the rounded
+	// value come back through ScrollTo()
+	BScrollBar* scrollBar = ScrollBar(B_VERTICAL);
+	if(scrollBar != nullptr) {
+		fSettingScrollBar = true;
+		scrollBar->SetValue(fTopRow);
+		fSettingScrollBar = false;
+	}
+}
+
+
+void
+HexView::_UpdateScrollBar()
+{
+	const int64 rows = _RowCount();
+	const int64 visible = _VisibleRows();
+	const int64 maxRow = std::max<int64>(rows - visible, 0);
+	fTopRow = std::min(fTopRow, maxRow);
+
+	BScrollBar* scrollBar = ScrollBar(B_VERTICAL);
+	if(scrollBar == nullptr)
+		return;
+	fSettingScrollBar = true;
+	scrollBar->SetRange(0, maxRow);
+	scrollBar->SetSteps(1, std::max<int64>(visible - 1, 1));
+	scrollBar->SetProportion(rows > 0
+		? std::min(1.0f, static_cast<float>(visible) / rows) : 1.0f);
+	scrollBar->SetValue(fTopRow);
+	fSettingScrollBar = false;
+}
+
+
+/**
+ * Formats the row at offset from its count bytes, fewer than kBytesPerRow
+ * at the end of the file.
+ */
+void
+HexView::_FormatRow(uint64 offset, const uint8* bytes, size_t count,
+	char* line) const
+{
+	char* out = line + sprintf(line, "%0*" B_PRIx64 "  ", fOffsetDigits, offset);
+	for(int64 i = 0; i < kBytesPerRow; i++) {
+		if(i == kBytesPerRow / 2)
+			*out++ = ' ';
+		if(static_cast<size_t>(i) < count) {
+			*out++ = kHexDigits[bytes[i] >> 4];
+			*out++ = kHexDigits[bytes[i] & 0xF];
+		} else {
+			*out++ = ' ';
+			*out++ = ' ';
+		}
+		*out++ = ' ';
+	}
+	*out++ = ' ';
+	for(size_t i = 0; i < count; i++)
+		*out++ = (bytes[i] >= 0x20 && bytes[i] < 0x7F) ? bytes[i] : '.';
+	*out = '\0';
+}
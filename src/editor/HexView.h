@@ -0,0 +1,62 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#ifndef HEXVIEW_H
+#define HEXVIEW_H
+
+
+#include <memory>
+
+#include <View.h>
+
+
+class BFile;
+
+
+/**
+ * HexView shows a file as rows of 16 bytes: the offset, the bytes in hex and
+ * as ASCII. Only visible rows are read and drawn, so showing a file costs the
+ * same whatever its size. They are read rather than mapped, as other
+ * programs may truncate the file, e.g. rebuild a binary, and touching
+ * a mapping past its end faults.
+ * The scroll bar works in rows instead of pixels, which it could not
+ * represent for big files.
+ */
+class HexView : public BView {
+public:
+							HexView();
+							~HexView();
+
+			status_t		SetFile(const char* path);
+			void			Unset();
+			bool			HasFile() const { return fFile != nullptr; }
+
+	virtual	void			AttachedToWindow();
+	virtual	void			Draw(BRect updateRect);
+	virtual	void			FrameResized(float width, float height);
+	virtual	void			KeyDown(const char* bytes, int32 numBytes);
+	virtual	void			MouseDown(BPoint where);
+	using BView::ScrollTo;
+	virtual	void			ScrollTo(BPoint where);
+
+private:
+			int64			_RowCount() const;
+			int64			_VisibleRows() const;
+			void			_ScrollToRow(int64 row);
+			void			_UpdateScrollBar();
+			void			_FormatRow(uint64 offset, const uint8* bytes,
+								size_t count, char* line) const;
+
+			std::unique_ptr<BFile>	fFile;
+			off_t			fSize;
+			int64			fTopRow;
+			int32			fOffsetDigits;
+			float			fRowHeight;
+			float			fAscent;
+			bool			fSettingScrollBar;
+};
+
+
+#endif // HEXVIEW_H
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include "LineIndexer.h"
+
+#include <Autolock.h>
+#include <File.h>
+#include <Message.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "DocumentLoader.h"
+
+
+LineIndexer::LineIndexer(const char* path, BMessenger target)
+	:
+	fPath(path),
+	fTarget(target),
+	fLock("line indexer"),
+	fFinished(false),
+	fThread(-1),
+	fCancelled(false)
+{
+}
+
+
+LineIndexer::~LineIndexer()
+{
+	Cancel();
+	if(fThread >= 0) {
+		status_t result;
+		wait_for_thread(fThread, &result);
+	}
+}
+
+
+status_t
+LineIndexer::Start()
+{
+	fThread = spawn_thread(_IndexThread, "line indexer",
+		B_LOW_PRIORITY, this);
+	if(fThread < 0)
+		return fThread;
+	return resume_thread(fThread);
+}
+
+
+void
+LineIndexer::Cancel()
+{
+	fCancelled = true;
+}
+
+
+/**
+ * Finds the indexed line closest to line, but not after it. Returns false
+ * if the indexer has not reached the start of line yet. Once the whole file
+ * is indexed, lines past its end are found as the last line.
+ */
+bool
+LineIndexer::Locate(uint64 line, LinePosition& position)
+{
+	BAutolock lock(fLock);
+	if(line >= fIndex.LineCount() && fFinished == false)
+		return false;
+	position = fIndex.Locate(line);
+	return true;
+}
+
+
+/* static */ status_t
+LineIndexer::_IndexThread(void* data)
+{
+	LineIndexer* self = static_cast<LineIndexer*>(data);
+	status_t status = self->_Index();
+	if(self->fCancelled == false) {
+		BMessage finished(INDEXER_FINISHED);
+		finished.AddInt32("status", status);
+		self->fTarget.SendMessage(&finished);
+	}
+	return status;
+}
+
+
+/**
+ * The file is read instead of mapped, so that going through all of it does
+ * not leave it in the address space of the window.
+ */
+status_t
+LineIndexer::_Index()
+{
+	BFile file(fPath.c_str(), B_READ_ONLY);
+	off_t size;
+	status_t status = file.InitCheck();
+	if(status != B_OK || (status = file.GetSize(&size)) != B_OK)
+		return status;
+
+	std::vector<char> buffer(DocumentLoader::kChunkSize);
+	off_t total = 0;
+	int32 lastPercent = -1;
+	while(fCancelled == false) {
+		ssize_t bytesRead = file.Read(buffer.data(), buffer.size());
+		if(bytesRead < 0)
+			return bytesRead;
+		if(bytesRead == 0)
+			break;
+		{
+			BAutolock lock(fLock);
+			fIndex.Update(std::string_view(buffer.data(), bytesRead));
+		}
+		total += bytesRead;
+
+		// don't flood the window with messages
+		int32 percent = size > 0 ? total * 100 / size : 100;
+		if(percent != lastPercent) {
+			BMessage progress(INDEXER_PROGRESS);
+			progress.AddFloat("progress", std::min(percent, (int32) 100) / 100.0f);
+			fTarget.SendMessage(&progress);
+			lastPercent = percent;
+		}
+	}
+	if(fCancelled == true)
+		return B_CANCELED;
+
+	BAutolock lock(fLock);
+	fFinished = true;
+	return B_OK;
+}
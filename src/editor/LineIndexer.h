@@ -0,0 +1,58 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#ifndef LINEINDEXER_H
+#define LINEINDEXER_H
+
+
+#include <atomic>
+#include <string>
+
+#include <Locker.h>
+#include <Messenger.h>
+#include <OS.h>
+
+#include "LineIndex.h"
+
+
+enum {
+	INDEXER_PROGRESS	= 'ixpr',
+	INDEXER_FINISHED	= 'ixfn'
+};
+
+
+/**
+ * LineIndexer builds a LineIndex of a file on a worker thread. Progress is
+ * reported to the target as INDEXER_PROGRESS messages with a "progress"
+ * float, completion as INDEXER_FINISHED with a "status" int32.
+ * The index can be queried while it is being built, lines which have not
+ * been reached yet are not found.
+ */
+class LineIndexer {
+public:
+						LineIndexer(const char* path, BMessenger target);
+						~LineIndexer();
+
+	status_t			Start();
+	void				Cancel();
+
+	bool				Locate(uint64 line, LinePosition& position);
+
+private:
+	static	status_t	_IndexThread(void* data);
+			status_t	_Index();
+
+	std::string			fPath;
+	BMessenger			fTarget;
+
+	BLocker				fLock;
+	LineIndex			fIndex;
+	bool				fFinished;
+	thread_id			fThread;
+	std::atomic<bool>	fCancelled;
+};
+
+
+#endif // LINEINDEXER_H
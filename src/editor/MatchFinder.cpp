@@ -0,0 +1,222 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include "MatchFinder.h"
+
+#include <Autolock.h>
+#include <Message.h>
+
+#include <algorithm>
+
+
+namespace {
+
+const size_t kBatchSize = 1024;
+// between progress messages, so that the window is not flooded
+const bigtime_t kProgressInterval = 100000;
+// of the line shown around a match
+const size_t kPreviewBefore = 40;
+const size_t kPreviewAfter = 200;
+
+}
+
+
+MatchFinder::MatchFinder(const std::string& pattern, bool matchCase,
+	bool matchWord, bool regex, const std::array<std::string_view, 2>& spans,
+	uint64 offset, uint64 firstLine, uint64 changeCount, BMessenger target)
+	:
+	fPattern(pattern),
+	fMatchCase(matchCase),
+	fMatchWord(matchWord),
+	fRegex(regex),
+	fSearch(pattern, matchCase, matchWord, regex),
+	fOffset(offset),
+	fFirstLine(firstLine),
+	fChangeCount(changeCount),
+	fTarget(target),
+	fLock("match finder"),
+	fFinished(false),
+	fThread(-1),
+	fCancelled(false)
+{
+	fText.reserve(spans[0].size() + spans[1].size());
+	fText.append(spans[0]);
+	fText.append(spans[1]);
+}
+
+
+MatchFinder::~MatchFinder()
+{
+	// the thread holds a reference until it is done, so it is only left to
+	// return, unless the finder is destroyed by the thread itself
+	if(fThread >= 0 && fThread != find_thread(nullptr)) {
+		status_t result;
+		wait_for_thread(fThread, &result);
+	}
+}
+
+
+/**
+ * Starts the search. The finder must be owned by a shared_ptr, the thread
+ * keeps it alive until it is done, so that letting go of a finder which is
+ * still searching never waits for it.
+ */
+status_t
+MatchFinder::Start()
+{
+	auto self = new std::shared_ptr<MatchFinder>(shared_from_this());
+	fThread = spawn_thread(_FindThread, "match finder",
+		B_LOW_PRIORITY, self);
+	if(fThread < 0) {
+		delete self;
+		return fThread;
+	}
+	return resume_thread(fThread);
+}
+
+
+void
+MatchFinder::Cancel()
+{
+	fCancelled = true;
+}
+
+
+bool
+MatchFinder::SearchesFor(const std::string& pattern, bool matchCase,
+	bool matchWord, bool regex) const
+{
+	return fPattern == pattern && fMatchCase == matchCase
+		&& fMatchWord == matchWord && fRegex == regex;
+}
+
+
+size_t
+MatchFinder::CountMatches()
+{
+	BAutolock lock(fLock);
+	return fMatches.size();
+}
+
+
+bool
+MatchFinder::IsFinished()
+{
+	BAutolock lock(fLock);
+	return fFinished;
+}
+
+
+bool
+MatchFinder::MatchAt(size_t index, TextMatch& match)
+{
+	BAutolock lock(fLock);
+	if(index >= fMatches.size())
+		return false;
+	match = fMatches[index];
+	return true;
+}
+
+
+/**
+ * Returns the index of the match from start to end, or -1 if there is none.
+ */
+ssize_t
+MatchFinder::IndexOf(uint64 start, uint64 end)
+{
+	BAutolock lock(fLock);
+	auto it = std::lower_bound(fMatches.begin(), fMatches.end(), start,
+		[](const TextMatch& match, uint64 start) { return match.start < start; });
+	if(it == fMatches.end() || it->start != start || it->end != end)
+		return -1;
+	return it - fMatches.begin();
+}
+
+
+/**
+ * Returns the line of match, shortened around it if it is long. matchStart
+ * and matchEnd are set to where the match is in the returned text. Tabs
+ * and control characters are shown as spaces.
+ */
+std::string
+MatchFinder::Preview(const TextMatch& match, size_t& matchStart,
+	size_t& matchEnd) const
+{
+	const size_t start = match.start - fOffset;
+	const size_t end = std::min<size_t>(match.end - fOffset, fText.size());
+	size_t lineStart = start;
+	while(lineStart > 0 && start - lineStart < kPreviewBefore
+			&& fText[lineStart - 1] != '\n' && fText[lineStart - 1] != '\r')
+		lineStart--;
+	// don't start in the middle of a character
+	while(lineStart < start && (fText[lineStart] & 0xC0) == 0x80)
+		lineStart++;
+	size_t lineEnd = start;
+	while(lineEnd < fText.size() && lineEnd - start < kPreviewAfter
+			&& fText[lineEnd] != '\n' && fText[lineEnd] != '\r')
+		lineEnd++;
+	while(lineEnd > start && lineEnd < fText.size() && (fText[lineEnd] & 0xC0) == 0x80)
+		lineEnd--;
+
+	std::string preview = fText.substr(lineStart, lineEnd - lineStart);
+	for(char& c : preview) {
+		if(static_cast<unsigned char>(c) < ' ')
+			c = ' ';
+	}
+	matchStart = start - lineStart;
+	// matches can span lines
+	matchEnd = std::min(end, lineEnd) - lineStart;
+	return preview;
+}
+
+
+/* static */ status_t
+MatchFinder::_FindThread(void* data)
+{
+	std::shared_ptr<MatchFinder>* reference
+		= static_cast<std::shared_ptr<MatchFinder>*>(data);
+	std::shared_ptr<MatchFinder> self = std::move(*reference);
+	delete reference;
+	self->_Find();
+	if(self->fCancelled == false) {
+		BMessage finished(FINDER_FINISHED);
+		finished.AddInt64("count", self->CountMatches());
+		finished.AddPointer("finder", self.get());
+		self->fTarget.SendMessage(&finished);
+	}
+	return B_OK;
+}
+
+
+void
+MatchFinder::_Find()
+{
+	bigtime_t lastProgress = system_time();
+	fSearch.FindAll(fText, kBatchSize, [&](const std::vector<TextMatch>& batch) {
+		if(fCancelled == true)
+			return false;
+		size_t count;
+		{
+			BAutolock lock(fLock);
+			for(const TextMatch& match : batch) {
+				fMatches.push_back({ match.start + fOffset, match.end + fOffset,
+					match.line + fFirstLine });
+			}
+			count = fMatches.size();
+		}
+		if(system_time() - lastProgress >= kProgressInterval) {
+			BMessage progress(FINDER_PROGRESS);
+			progress.AddInt64("count", count);
+			progress.AddPointer("finder", this);
+			fTarget.SendMessage(&progress);
+			lastProgress = system_time();
+		}
+		return true;
+	}, [this]() { return fCancelled == true; });
+
+	BAutolock lock(fLock);
+	fFinished = true;
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#ifndef MATCHFINDER_H
+#define MATCHFINDER_H
+
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <Locker.h>
+#include <Messenger.h>
+#include <OS.h>
+
+#include "TextSearch.h"
+
+
+enum {
+	FINDER_PROGRESS		= 'fdpr',
+	FINDER_FINISHED		= 'fdfn'
+};
+
+
+/**
+ * MatchFinder finds every match of a search in a copy of the document on a
+ * worker thread, so that the document can be edited meanwhile. Matches are
+ * added in batches and can be read while the search goes on. New matches
+ * are reported to the target as FINDER_PROGRESS, the end of the search as
+ * FINDER_FINISHED, both with a "count" int64 and the finder as "finder".
+ * Positions and lines are those of the document at the time of the copy,
+ * the copy can start at offset, on line firstLine.
+ */
+class MatchFinder : public std::enable_shared_from_this<MatchFinder> {
+public:
+						MatchFinder(const std::string& pattern, bool matchCase,
+							bool matchWord, bool regex,
+							const std::array<std::string_view, 2>& spans,
+							uint64 offset, uint64 firstLine, uint64 changeCount,
+							BMessenger target);
+						~MatchFinder();
+
+	bool				IsValid() const { return fSearch.IsValid(); }
+	status_t			Start();
+	void				Cancel();
+
+	bool				SearchesFor(const std::string& pattern, bool matchCase,
+							bool matchWord, bool regex) const;
+	// change count of the document the copy was taken from
+	uint64				ChangeCount() const { return fChangeCount; }
+
+	size_t				CountMatches();
+	bool				IsFinished();
+	bool				MatchAt(size_t index, TextMatch& match);
+	ssize_t				IndexOf(uint64 start, uint64 end);
+	std::string			Preview(const TextMatch& match, size_t& matchStart,
+							size_t& matchEnd) const;
+
+private:
+	static	status_t	_FindThread(void* data);
+			void		_Find();
+
+	std::string			fPattern;
+	bool				fMatchCase;
+	bool				fMatchWord;
+	bool				fRegex;
+	TextSearch			fSearch;
+	std::string			fText;
+	uint64				fOffset;
+	uint64				fFirstLine;
+	uint64				fChangeCount;
+	BMessenger			fTarget;
+
+	BLocker				fLock;
+	std::vector<TextMatch>	fMatches;
+	bool				fFinished;
+	thread_id			fThread;
+	std::atomic<bool>	fCancelled;
+};
+
+
+#endif // MATCHFINDER_H
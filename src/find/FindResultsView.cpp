@@ -0,0 +1,265 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include "FindResultsView.h"
+
+#include <ControlLook.h>
+#include <Looper.h>
+#include <Message.h>
+#include <ScrollBar.h>
+#include <String.h>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+#include "FindResultsWindow.h"
+#include "MatchFinder.h"
+
+
+FindResultsView::FindResultsView(const char* name, BMessenger target)
+	:
+	BView(name, B_WILL_DRAW | B_FRAME_EVENTS | B_NAVIGABLE
+		| B_FULL_UPDATE_ON_RESIZE),
+	fTarget(target),
+	fCount(0),
+	fSelected(-1),
+	fRowHeight(0),
+	fBaseline(0)
+{
+	SetViewUIColor(B_LIST_BACKGROUND_COLOR);
+	SetLowUIColor(B_LIST_BACKGROUND_COLOR);
+	SetHighUIColor(B_LIST_ITEM_TEXT_COLOR);
+
+	font_height fontHeight;
+	GetFontHeight(&fontHeight);
+	fBaseline = ceilf(fontHeight.ascent);
+	fRowHeight = fBaseline + ceilf(fontHeight.descent + fontHeight.leading) + 2;
+}
+
+
+FindResultsView::~FindResultsView()
+{
+}
+
+
+void
+FindResultsView::AttachedToWindow()
+{
+	BView::AttachedToWindow();
+	_UpdateScrollBar();
+}
+
+
+/**
+ * Only the rows in updateRect are looked up in the finder.
+ */
+void
+FindResultsView::Draw(BRect updateRect)
+{
+	if(fFinder == nullptr || fCount == 0)
+		return;
+
+	const int64 first = std::max<int64>(floorf(updateRect.top / fRowHeight), 0);
+	const int64 last = std::min<int64>(floorf(updateRect.bottom / fRowHeight),
+		fCount - 1);
+	const float spacing = be_control_look->DefaultLabelSpacing();
+	// wide enough for the line numbers of all visible rows
+	TextMatch lastMatch;
+	float numberWidth = 0;
+	if(fFinder->MatchAt(last, lastMatch)) {
+		BString number;
+		number << lastMatch.line + 1;
+		numberWidth = StringWidth(number.String()) + spacing * 2;
+	}
+
+	const rgb_color matchColor = tint_color(ui_color(B_LIST_BACKGROUND_COLOR),
+		B_DARKEN_2_TINT);
+	for(int64 i = first; i <= last; i++) {
+		TextMatch match;
+		if(fFinder->MatchAt(i, match) == false)
+			break;
+		BRect frame = _RowFrame(i);
+		if(i == fSelected) {
+			SetLowUIColor(B_LIST_SELECTED_BACKGROUND_COLOR);
+			SetHighUIColor(B_LIST_SELECTED_ITEM_TEXT_COLOR);
+		} else {
+			SetLowUIColor(B_LIST_BACKGROUND_COLOR);
+			SetHighUIColor(B_LIST_ITEM_TEXT_COLOR);
+		}
+		FillRect(frame, B_SOLID_LOW);
+
+		const float y = frame.top + fBaseline + 1;
+		BString number;
+		number << match.line + 1;
+		DrawString(number.String(),
+			BPoint(numberWidth - spacing - StringWidth(number.String()), y));
+
+		size_t matchStart, matchEnd;
+		const std::string preview = fFinder->Preview(match, matchStart, matchEnd);
+		const std::string before = preview.substr(0, matchStart);
+		const std::string found = preview.substr(matchStart, matchEnd - matchStart);
+		const std::string after = preview.substr(matchEnd);
+		float x = numberWidth + spacing;
+		DrawString(before.c_str(), BPoint(x, y));
+		x += StringWidth(before.c_str());
+		const float foundWidth = StringWidth(found.c_str());
+		if(i != fSelected) {
+			SetLowColor(matchColor);
+			FillRect(BRect(x, frame.top, x + foundWidth, frame.bottom), B_SOLID_LOW);
+		}
+		DrawString(found.c_str(), BPoint(x, y));
+		SetLowUIColor(i == fSelected ? B_LIST_SELECTED_BACKGROUND_COLOR
+			: B_LIST_BACKGROUND_COLOR);
+		DrawString(after.c_str(), BPoint(x + foundWidth, y));
+	}
+	SetLowUIColor(B_LIST_BACKGROUND_COLOR);
+	SetHighUIColor(B_LIST_ITEM_TEXT_COLOR);
+}
+
+
+void
+FindResultsView::FrameResized(float width, float height)
+{
+	BView::FrameResized(width, height);
+	_UpdateScrollBar();
+}
+
+
+void
+FindResultsView::KeyDown(const char* bytes, int32 numBytes)
+{
+	const int64 page = std::max<int64>(Bounds().Height() / fRowHeight, 1);
+	switch(bytes[0]) {
+		case B_UP_ARROW:
+			_Select(std::max<int64>(fSelected - 1, 0));
+		break;
+		case B_DOWN_ARROW:
+			_Select(fSelected + 1);
+		break;
+		case B_PAGE_UP:
+			_Select(std::max<int64>(fSelected - page, 0));
+		break;
+		case B_PAGE_DOWN:
+			_Select(fSelected + page);
+		break;
+		case B_HOME:
+			_Select(0);
+		break;
+		case B_END:
+			_Select(fCount - 1);
+		break;
+		case B_RETURN:
+		case B_SPACE:
+			_Invoke();
+		break;
+		default:
+			BView::KeyDown(bytes, numBytes);
+		break;
+	}
+}
+
+
+void
+FindResultsView::MouseDown(BPoint where)
+{
+	MakeFocus(true);
+	const int64 index = floorf(where.y / fRowHeight);
+	if(index < 0 || index >= fCount)
+		return;
+	_Select(index);
+	int32 clicks = 0;
+	BMessage* message = Looper()->CurrentMessage();
+	if(message != nullptr && message->FindInt32("clicks", &clicks) == B_OK
+			&& clicks > 1)
+		_Invoke();
+}
+
+
+void
+FindResultsView::SetFinder(std::shared_ptr<MatchFinder> finder)
+{
+	fFinder = finder;
+	fSelected = -1;
+	fCount = 0;
+	ScrollTo(0, 0);
+	Refresh();
+	Invalidate();
+}
+
+
+void
+FindResultsView::Refresh()
+{
+	const int64 count = fFinder != nullptr ? fFinder->CountMatches() : 0;
+	if(count == fCount)
+		return;
+	// rows which were empty before
+	BRect frame = Bounds();
+	frame.top = std::max(frame.top, fCount * fRowHeight);
+	fCount = count;
+	_UpdateScrollBar();
+	if(frame.IsValid())
+		Invalidate(frame);
+}
+
+
+void
+FindResultsView::_UpdateScrollBar()
+{
+	BScrollBar* scrollBar = ScrollBar(B_VERTICAL);
+	if(scrollBar == nullptr)
+		return;
+	const float height = Bounds().Height();
+	const float total = fCount * fRowHeight;
+	scrollBar->SetRange(0, std::max(total - height, 0.0f));
+	scrollBar->SetProportion(total > 0 ? std::min(height / total, 1.0f) : 1.0f);
+	scrollBar->SetSteps(fRowHeight, std::max(height - fRowHeight, fRowHeight));
+}
+
+
+BRect
+FindResultsView::_RowFrame(int64 index) const
+{
+	BRect frame = Bounds();
+	frame.top = index * fRowHeight;
+	frame.bottom = frame.top + fRowHeight - 1;
+	return frame;
+}
+
+
+void
+FindResultsView::_Select(int64 index)
+{
+	if(fCount == 0)
+		return;
+	index = std::min(index, fCount - 1);
+	if(fSelected >= 0)
+		Invalidate(_RowFrame(fSelected));
+	fSelected = index;
+	const BRect frame = _RowFrame(index);
+	Invalidate(frame);
+
+	// keep the selected row in view
+	const BRect bounds = Bounds();
+	if(frame.top < bounds.top)
+		ScrollTo(0, frame.top);
+	else if(frame.bottom > bounds.bottom)
+		ScrollTo(0, frame.bottom - bounds.Height());
+}
+
+
+void
+FindResultsView::_Invoke()
+{
+	TextMatch match;
+	if(fFinder == nullptr || fFinder->MatchAt(fSelected, match) == false)
+		return;
+	BMessage message(FIND_RESULT_SELECTED);
+	message.AddInt64("start", match.start);
+	message.AddInt64("end", match.end);
+	fTarget.SendMessage(&message);
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef FINDRESULTSVIEW_H
+#define FINDRESULTSVIEW_H
+
+
+#include <memory>
+
+#include <Messenger.h>
+#include <View.h>
+
+
+class MatchFinder;
+
+
+/**
+ * FindResultsView lists the matches of a MatchFinder, one per row with the
+ * line it is on. Rows are drawn straight from the finder when they are
+ * scrolled into view, so the list costs the same with a hundred matches as
+ * with millions. Invoking a row sends FIND_RESULT_SELECTED to the target.
+ */
+class FindResultsView : public BView {
+public:
+					FindResultsView(const char* name, BMessenger target);
+					~FindResultsView();
+
+	virtual	void	AttachedToWindow();
+	virtual	void	Draw(BRect updateRect);
+	virtual	void	FrameResized(float width, float height);
+	virtual	void	KeyDown(const char* bytes, int32 numBytes);
+	virtual	void	MouseDown(BPoint where);
+
+			void	SetFinder(std::shared_ptr<MatchFinder> finder);
+			// the finder has found more matches
+			void	Refresh();
+
+private:
+			void	_UpdateScrollBar();
+			BRect	_RowFrame(int64 index) const;
+			void	_Select(int64 index);
+			void	_Invoke();
+
+	std::shared_ptr<MatchFinder>	fFinder;
+	BMessenger		fTarget;
+	int64			fCount;
+	int64			fSelected;
+	float			fRowHeight;
+	float			fBaseline;
+};
+
+
+#endif // FINDRESULTSVIEW_H
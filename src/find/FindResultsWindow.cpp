@@ -0,0 +1,86 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include "FindResultsWindow.h"
+
+#include <Catalog.h>
+#include <GroupLayout.h>
+#include <ScrollView.h>
+
+#include "FindResultsView.h"
+#include "MatchFinder.h"
+
+
+#undef B_TRANSLATION_CONTEXT
+#define B_TRANSLATION_CONTEXT "FindResultsWindow"
+
+
+FindResultsWindow::FindResultsWindow(BWindow* owner)
+	:
+	BWindow(BRect(0, 0, 0, 0), B_TRANSLATE("Find results"),
+		B_FLOATING_WINDOW_LOOK, B_FLOATING_SUBSET_WINDOW_FEEL, 0),
+	fOwner(owner)
+{
+	AddToSubset(owner);
+
+	owner->StartWatching(this, FIND_RESULTS_CHANGED);
+
+	fView = new FindResultsView("find results", fOwner);
+	BScrollView* scroller = new BScrollView("find results scroller", fView, 0,
+		false, true, B_NO_BORDER);
+
+	BGroupLayout* layout = new BGroupLayout(B_VERTICAL, 0);
+	SetLayout(layout);
+	layout->AddView(scroller);
+	layout->SetInsets(0.f, 0.f, -1.0f, 0.f);
+
+	BRect frame = owner->Frame();
+	BRect decorFrame = owner->DecoratorFrame();
+	float frameThickness = frame.left - decorFrame.left;
+	MoveTo(frame.left, frame.bottom + frameThickness * 2
+		+ (frame.top - decorFrame.top));
+	ResizeTo(frame.Width(), frame.Height() / 3);
+}
+
+
+FindResultsWindow::~FindResultsWindow()
+{
+}
+
+
+void
+FindResultsWindow::MessageReceived(BMessage* message)
+{
+	switch(message->what) {
+		case B_OBSERVER_NOTICE_CHANGE: {
+			int32 what = message->GetInt32("be:observe_change_what", 0);
+			if(what == FIND_RESULTS_CHANGED)
+				fView->Refresh();
+		} break;
+		default:
+			BWindow::MessageReceived(message);
+		break;
+	}
+}
+
+
+void
+FindResultsWindow::Quit()
+{
+	fOwner.SendMessage(FIND_RESULTS_WINDOW_QUITTING);
+
+	BWindow::Quit();
+}
+
+
+/**
+ * Shows the matches of finder, or nothing if it is nullptr.
+ */
+void
+FindResultsWindow::SetFinder(std::shared_ptr<MatchFinder> finder)
+{
+	fView->SetFinder(finder);
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+#ifndef FINDRESULTSWINDOW_H
+#define FINDRESULTSWINDOW_H
+
+
+#include <memory>
+
+#include <Messenger.h>
+#include <Window.h>
+
+
+class FindResultsView;
+class MatchFinder;
+
+
+enum {
+	FIND_RESULTS_CHANGED		= 'frch',
+	FIND_RESULT_SELECTED		= 'frsl',
+	FIND_RESULTS_WINDOW_QUITTING	= 'frqt'
+};
+
+
+/**
+ * FindResultsWindow shows the matches found by Find All next to the owner.
+ * The owner sets the finder with the window locked and sends
+ * FIND_RESULTS_CHANGED notices when it finds more.
+ */
+class FindResultsWindow : public BWindow {
+public:
+					FindResultsWindow(BWindow* owner);
+					~FindResultsWindow();
+
+	void			MessageReceived(BMessage* message);
+	void			Quit();
+
+	void			SetFinder(std::shared_ptr<MatchFinder> finder);
+
+private:
+	FindResultsView*	fView;
+	BMessenger			fOwner;
+};
+
+
+#endif // FINDRESULTSWINDOW_H
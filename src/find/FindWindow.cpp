@@ -94,7 +94,8 @@ FindWindow::MessageReceived(BMessage* message)
 				fFlagsChanged = false;
 			}
 		} break;
-		case FINDWINDOW_BOOKMARKALL: {
+		case FINDWINDOW_BOOKMARKALL:
+		case FINDWINDOW_FINDALL: {
 			std::string findText(fFindTC->TextLength(), '\0');
 			fFindTC->GetText(0, findText.size() + 1, &findText[0]);
 			if(findText.empty() == true) {
@@ -220,6 +221,8 @@ FindWindow::_InitInterface()
 	fReplaceAllButton->SetExplicitMaxSize(BSize(B_SIZE_UNLIMITED, B_SIZE_UNSET));
 	fBookmarkAllButton = new BButton(B_TRANSLATE("Bookmark all"), new BMessage((uint32) FINDWINDOW_BOOKMARKALL));
 	fBookmarkAllButton->SetExplicitMaxSize(BSize(B_SIZE_UNLIMITED, B_SIZE_UNSET));
+	fFindAllButton = new BButton(B_TRANSLATE("Find all"), new BMessage((uint32) FINDWINDOW_FINDALL));
+	fFindAllButton->SetExplicitMaxSize(BSize(B_SIZE_UNLIMITED, B_SIZE_UNSET));
 
 	fMatchCaseCB = new BCheckBox("matchCase", B_TRANSLATE("Match case"), new BMessage((uint32) Actions::MATCH_CASE));
 	fMatchWordCB = new BCheckBox("matchWord", B_TRANSLATE("Match entire words"), new BMessage((uint32) Actions::MATCH_WORD));
@@ -244,6 +247,7 @@ FindWindow::_InitInterface()
 				.Add(fReplaceFindButton)
 				.Add(fReplaceAllButton)
 				.Add(fBookmarkAllButton)
+				.Add(fFindAllButton)
 				.AddGlue()
 			.End()
 		.End()
@@ -31,6 +31,7 @@ enum {
 	FINDWINDOW_REPLACEFIND	= 'fwrf',
 	FINDWINDOW_REPLACEALL	= 'fwra',
 	FINDWINDOW_BOOKMARKALL	= 'fwba',
+	FINDWINDOW_FINDALL		= 'fwfa',
 	FINDWINDOW_QUITTING		= 'FWQU'
 };
 
@@ -78,6 +79,7 @@ private:
 	BButton*		fReplaceFindButton;
 	BButton*		fReplaceAllButton;
 	BButton*		fBookmarkAllButton;
+	BButton*		fFindAllButton;
 
 	BCheckBox*		fMatchCaseCB;
 	BCheckBox*		fMatchWordCB;
@@ -8,17 +8,26 @@
 #include <Roster.h>
 
 #include <array>
+#include <cerrno>
+#include <cstring>
 #include <iostream>
+#include <vector>
 #include <getopt.h>
+#include <unistd.h>
 
 #include "Utils.h"
 
 
+// read() returns what the producer has written so far, up to this much
+const size_t kStdinChunkSize = 64 * 1024;
+
+
 void
 _PrintUsage(std::ostream& outStream)
 {
 	outStream <<
 		"Usage: Koder [options] file...\n"
+		"A file named - reads standard input into a new window as it arrives.\n"
 		"Options:\n"
 		"  -h, --help\t\tPrints this message.\n"
 		"  -w, --wait\t\tWait for the window to quit before returning.\n"
@@ -27,6 +36,54 @@ _PrintUsage(std::ostream& outStream)
 }
 
 
+/**
+ * Asks app for a new window and sends standard input to it piece by piece.
+ * Every piece waits for a reply before the next one is read, so only one is
+ * in memory at a time and a fast producer is slowed down to what the window
+ * can take. With waitForExit returns once the window is closed.
+ * Closing the window before the end of the input, like quitting a pager,
+ * is not an error, the rest of the input is not read.
+ */
+status_t
+_StreamStdin(BMessenger app, bool waitForExit)
+{
+	BMessage request(WINDOW_NEW_FOR_STDIN);
+	BMessage reply;
+	BMessenger window;
+	status_t status = app.SendMessage(&request, &reply);
+	if(status != B_OK
+			|| (status = reply.FindMessenger("window", &window)) != B_OK)
+		return status;
+
+	std::vector<char> buffer(kStdinChunkSize);
+	ssize_t bytesRead;
+	while((bytesRead = read(STDIN_FILENO, buffer.data(), buffer.size())) != 0) {
+		if(bytesRead < 0) {
+			if(errno == EINTR)
+				continue;
+			return errno;
+		}
+		BMessage data(STDIN_DATA);
+		data.AddData("data", B_RAW_TYPE, buffer.data(), bytesRead);
+		// fails once the window is closed
+		if((status = window.SendMessage(&data, &reply)) != B_OK)
+			return status == B_BAD_PORT_ID ? B_OK : status;
+	}
+
+	BMessage finished(STDIN_FINISHED);
+	finished.AddBool("wait", waitForExit);
+	status = window.SendMessage(&finished, &reply);
+	return status == B_BAD_PORT_ID ? B_OK : status;
+}
+
+
+status_t
+_StdinThread(void* data)
+{
+	return _StreamStdin(*static_cast<BMessenger*>(data), false);
+}
+
+
 int
 main(int argc, char** argv)
 {
@@ -61,7 +118,13 @@ main(int argc, char** argv)
 	BMessage windowMessage
 		(waitForExit == true ? (system_message_code) WINDOW_NEW_WITH_QUIT_REPLY : B_REFS_RECEIVED);
 
+	bool readStdin = false;
 	while(optind < argc) {
+		if(strcmp(argv[optind], "-") == 0) {
+			readStdin = true;
+			optind++;
+			continue;
+		}
 		int32 line, column;
 		BPath filePath(ParseFileArgument(argv[optind++], &line, &column).c_str(), nullptr, true);
 		if(filePath.InitCheck() != B_OK) {
@@ -100,7 +163,12 @@ main(int argc, char** argv)
 	// make sure we're targetting a different team with a BApplication and not this one
 	if(messenger.IsValid() == true && messenger.IsTargetLocal() == false) {
 		BMessage reply;
-		messenger.SendMessage(&windowMessage, &reply);
+		if(readStdin == false || windowMessage.HasRef("refs"))
+			messenger.SendMessage(&windowMessage, &reply);
+		if(readStdin == true && _StreamStdin(messenger, waitForExit) != B_OK) {
+			std::cerr << "Error: Unable to send standard input to Koder.\n";
+			return 1;
+		}
 	} else {
 		App* app = new App();
 		app->Init();
@@ -108,6 +176,15 @@ main(int argc, char** argv)
 		if(windowMessage.IsEmpty() == false) {
 			app->RefsReceived(&windowMessage);
 		}
+		// the application answers once it runs
+		BMessenger appMessenger(app);
+		if(readStdin == true) {
+			// the window for standard input takes the place of the empty one
+			BMessage suppressMessage(SUPPRESS_INITIAL_WINDOW);
+			app->MessageReceived(&suppressMessage);
+			resume_thread(spawn_thread(_StdinThread, "stdin reader",
+				B_NORMAL_PRIORITY, &appMessenger));
+		}
 		app->Run();
 		delete app;
 	}
@@ -160,6 +160,11 @@ AppPreferencesWindow::MessageReceived(BMessage* message)
 			fPreferences->fBracesHighlighting = IsChecked(fBracesHighlightingCB);
 			_PreferencesModified();
 		} break;
+		case Actions::HIGHLIGHT_OCCURRENCES: {
+			fPreferences->fHighlightOccurrences =
+				IsChecked(fHighlightOccurrencesCB);
+			_PreferencesModified();
+		} break;
 		case Actions::CURSOR_WIDTH: {
 			fPreferences->fCursorWidth = std::stoi(fCursorWidthMF->Menu()->FindMarked()->Label());
 			_PreferencesModified();
@@ -200,6 +205,22 @@ AppPreferencesWindow::MessageReceived(BMessage* message)
 				IsChecked(fAppendNLAtTheEndCB);
 			_PreferencesModified();
 		} break;
+		case Actions::ATOMIC_SAVE: {
+			fPreferences->fAtomicSave = IsChecked(fAtomicSaveCB);
+			_PreferencesModified();
+		} break;
+		case Actions::LOCAL_HISTORY: {
+			fPreferences->fLocalHistory = IsChecked(fLocalHistoryCB);
+			_PreferencesModified();
+		} break;
+		case Actions::LARGE_FILE_THRESHOLD: {
+			fPreferences->fLargeFileThreshold = fLargeFileThresholdSpinner->Value();
+			_PreferencesModified();
+		} break;
+		case Actions::LARGE_FILE_STYLING: {
+			fPreferences->fLargeFileDisableStyling = IsChecked(fLargeFileStylingCB);
+			_PreferencesModified();
+		} break;
 		case Actions::USE_CUSTOM_FONT: {
 			bool use = IsChecked(fUseCustomFontCB);
 			fPreferences->fUseCustomFont = use;
@@ -345,6 +366,7 @@ AppPreferencesWindow::_InitInterface()
 	fIndentGuidesBox->SetLabel(fIndentGuidesShowCB);
 
 	fBracesHighlightingCB = new BCheckBox("bracesHighlighting", B_TRANSLATE("Highlight braces"), new BMessage((uint32) Actions::BRACES_HIGHLIGHTING));
+	fHighlightOccurrencesCB = new BCheckBox("highlightOccurrences", B_TRANSLATE("Highlight occurrences"), new BMessage((uint32) Actions::HIGHLIGHT_OCCURRENCES));
 
 	BPopUpMenu* cursorMenu = new BPopUpMenu("cursorMenu");
 	auto menuBuilder = BLayoutBuilder::Menu<>(cursorMenu);
@@ -367,6 +389,11 @@ AppPreferencesWindow::_InitInterface()
 	fUseEditorconfigCB  = new BCheckBox("useEditorconfig", B_TRANSLATE("Use .editorconfig if possible"), new BMessage((uint32) Actions::USE_EDITORCONFIG));
 	fAlwaysOpenInNewWindowCB  = new BCheckBox("alwaysOpenInNewWindow", B_TRANSLATE("Always open files in new window"), new BMessage((uint32) Actions::ALWAYS_OPEN_IN_NEW_WINDOW));
 	fAppendNLAtTheEndCB  = new BCheckBox("appendNLAtTheEnd", B_TRANSLATE("Ensure empty last line on save"), new BMessage((uint32) Actions::APPEND_NL_AT_THE_END));
+	fAtomicSaveCB = new BCheckBox("atomicSave", B_TRANSLATE("Save safely through a temporary file"), new BMessage((uint32) Actions::ATOMIC_SAVE));
+	fLocalHistoryCB = new BCheckBox("localHistory", B_TRANSLATE("Keep local history of saved files"), new BMessage((uint32) Actions::LOCAL_HISTORY));
+	fLargeFileThresholdSpinner = new BSpinner("largeFileThreshold", B_TRANSLATE("Large file mode above (MiB, 0 = off):"), new BMessage((uint32) Actions::LARGE_FILE_THRESHOLD));
+	fLargeFileThresholdSpinner->SetRange(0, 1048576);
+	fLargeFileStylingCB = new BCheckBox("largeFileStyling", B_TRANSLATE("No syntax highlighting in large files"), new BMessage((uint32) Actions::LARGE_FILE_STYLING));
 
 	fUseCustomFontCB = new BCheckBox("customFont", B_TRANSLATE("Use custom font"), new BMessage((uint32) Actions::USE_CUSTOM_FONT));
 	fFontMenu = new BPopUpMenu("font");
@@ -395,6 +422,7 @@ AppPreferencesWindow::_InitInterface()
 		.Add(fCompactLangMenuCB)
 		.Add(fFullPathInTitleCB)
 		.Add(fBracesHighlightingCB)
+		.Add(fHighlightOccurrencesCB)
 		.Add(fCursorWidthMF)
 		.Add(fToolbarBox)
 		.AddStrut(B_USE_HALF_ITEM_SPACING)
@@ -423,9 +451,13 @@ AppPreferencesWindow::_InitInterface()
 	BLayoutBuilder::Group<>(fBehaviorBox, B_VERTICAL, 0)
 		.AddStrut(B_USE_ITEM_SPACING)
 		.Add(fAppendNLAtTheEndCB)
+		.Add(fAtomicSaveCB)
+		.Add(fLocalHistoryCB)
 		.Add(fAlwaysOpenInNewWindowCB)
 		.Add(fAttachNewWindowsCB)
 		.Add(fUseEditorconfigCB)
+		.Add(fLargeFileThresholdSpinner)
+		.Add(fLargeFileStylingCB)
 		.SetInsets(B_USE_ITEM_INSETS);
 
 	BLayoutBuilder::Group<>(this, B_VERTICAL, B_USE_DEFAULT_SPACING)
@@ -514,12 +546,19 @@ AppPreferencesWindow::_SyncPreferences(Preferences* preferences)
 	}
 
 	SetChecked(fBracesHighlightingCB, preferences->fBracesHighlighting);
+	SetChecked(fHighlightOccurrencesCB, preferences->fHighlightOccurrences);
 	SetChecked(fAttachNewWindowsCB, preferences->fOpenWindowsInStack);
 	SetChecked(fHighlightTrailingWSCB, preferences->fHighlightTrailingWhitespace);
 	SetChecked(fTrimTrailingWSOnSaveCB, preferences->fTrimTrailingWhitespaceOnSave);
 	SetChecked(fUseEditorconfigCB, preferences->fUseEditorconfig);
 	SetChecked(fAlwaysOpenInNewWindowCB, preferences->fAlwaysOpenInNewWindow);
 	SetChecked(fAppendNLAtTheEndCB, preferences->fAppendNLAtTheEndIfNotPresent);
+	SetChecked(fAtomicSaveCB, preferences->fAtomicSave);
+	SetChecked(fLocalHistoryCB, preferences->fLocalHistory);
+	fLargeFileThresholdSpinner->SetMessage(nullptr);
+	fLargeFileThresholdSpinner->SetValue(preferences->fLargeFileThreshold);
+	fLargeFileThresholdSpinner->SetMessage(new BMessage((uint32) Actions::LARGE_FILE_THRESHOLD));
+	SetChecked(fLargeFileStylingCB, preferences->fLargeFileDisableStyling);
 }
 
 
@@ -66,6 +66,7 @@ private:
 		INDENTGUIDES_BOTH		= 'igbo',
 
 		BRACES_HIGHLIGHTING		= 'bhlt',
+		HIGHLIGHT_OCCURRENCES	= 'hloc',
 
 		EDITOR_STYLE			= 'styl',
 
@@ -75,6 +76,10 @@ private:
 
 		USE_EDITORCONFIG		= 'uecf',
 		APPEND_NL_AT_THE_END	= 'apae',
+		ATOMIC_SAVE				= 'atsv',
+		LOCAL_HISTORY			= 'lhst',
+		LARGE_FILE_THRESHOLD	= 'lfth',
+		LARGE_FILE_STYLING		= 'lfst',
 		ALWAYS_OPEN_IN_NEW_WINDOW='aonw',
 		USE_CUSTOM_FONT			= 'ucfn',
 		FONT_CHANGED			= 'fnch',
@@ -138,6 +143,7 @@ private:
 	BRadioButton*	fIndentGuidesLookBothRadio;
 
 	BCheckBox*		fBracesHighlightingCB;
+	BCheckBox*		fHighlightOccurrencesCB;
 	BMenuField*		fCursorWidthMF;
 
 	BPopUpMenu*		fEditorStyleMenu;
@@ -150,6 +156,10 @@ private:
 	BCheckBox*		fUseEditorconfigCB;
 	BCheckBox*		fAlwaysOpenInNewWindowCB;
 	BCheckBox*		fAppendNLAtTheEndCB;
+	BCheckBox*		fAtomicSaveCB;
+	BCheckBox*		fLocalHistoryCB;
+	BSpinner*		fLargeFileThresholdSpinner;
+	BCheckBox*		fLargeFileStylingCB;
 
 	BBox*			fFontBox;
 	BCheckBox*		fUseCustomFontCB;
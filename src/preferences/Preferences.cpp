@@ -103,6 +103,7 @@ Preferences::Load(const char* filename)
 	fLineLimitColumn = storage.GetUInt32("lineLimitColumn", 80);
 	fWrapLines = storage.GetBool("wrapLines", false);
 	fBracesHighlighting = storage.GetBool("bracesHighlighting", true);
+	fHighlightOccurrences = storage.GetBool("highlightOccurrences", true);
 	fCursorWidth = storage.GetUInt8("cursorWidth", 1);
 	fFullPathInTitle = storage.GetBool("fullPathInTitle", true);
 	fCompactLangMenu = storage.GetBool("compactLangMenu", true);
@@ -111,6 +112,10 @@ Preferences::Load(const char* filename)
 	fHighlightTrailingWhitespace = storage.GetBool("highlightTrailingWhitespace", false);
 	fTrimTrailingWhitespaceOnSave = storage.GetBool("trimTrailingWhitespaceOnSave", false);
 	fAppendNLAtTheEndIfNotPresent = storage.GetBool("appendNLAtTheEndIfNotPresent", true);
+	fAtomicSave = storage.GetBool("atomicSave", true);
+	fLocalHistory = storage.GetBool("localHistory", true);
+	fLargeFileThreshold = storage.GetUInt32("largeFileThreshold", 64); // MB
+	fLargeFileDisableStyling = storage.GetBool("largeFileDisableStyling", false);
 	fStyle = storage.GetString("style", "default");
 	fWindowRect = storage.GetRect("windowRect", BRect(50, 50, 450, 450));
 	fUseEditorconfig = storage.GetBool("useEditorconfig", true);
@@ -148,6 +153,7 @@ Preferences::Save(const char* filename)
 	storage.AddUInt32("lineLimitColumn", fLineLimitColumn);
 	storage.AddBool("wrapLines", fWrapLines);
 	storage.AddBool("bracesHighlighting", fBracesHighlighting);
+	storage.AddBool("highlightOccurrences", fHighlightOccurrences);
 	storage.AddUInt8("cursorWidth", fCursorWidth);
 	storage.AddBool("fullPathInTitle", fFullPathInTitle);
 	storage.AddBool("compactLangMenu", fCompactLangMenu);
@@ -156,6 +162,10 @@ Preferences::Save(const char* filename)
 	storage.AddBool("highlightTrailingWhitespace", fHighlightTrailingWhitespace);
 	storage.AddBool("trimTrailingWhitespaceOnSave", fTrimTrailingWhitespaceOnSave);
 	storage.AddBool("appendNLAtTheEndIfNotPresent", fAppendNLAtTheEndIfNotPresent);
+	storage.AddBool("atomicSave", fAtomicSave);
+	storage.AddBool("localHistory", fLocalHistory);
+	storage.AddUInt32("largeFileThreshold", fLargeFileThreshold);
+	storage.AddBool("largeFileDisableStyling", fLargeFileDisableStyling);
 	storage.AddString("style", fStyle.c_str());
 	storage.AddRect("windowRect", fWindowRect);
 	storage.AddMessage("findWindowState", &fFindWindowState);
@@ -193,6 +203,7 @@ Preferences::operator =(Preferences& p)
 	fLineLimitColumn = p.fLineLimitColumn;
 	fWrapLines = p.fWrapLines;
 	fBracesHighlighting = p.fBracesHighlighting;
+	fHighlightOccurrences = p.fHighlightOccurrences;
 	fCursorWidth = p.fCursorWidth;
 	fFullPathInTitle = p.fFullPathInTitle;
 	fCompactLangMenu = p.fCompactLangMenu;
@@ -201,6 +212,10 @@ Preferences::operator =(Preferences& p)
 	fHighlightTrailingWhitespace = p.fHighlightTrailingWhitespace;
 	fTrimTrailingWhitespaceOnSave = p.fTrimTrailingWhitespaceOnSave;
 	fAppendNLAtTheEndIfNotPresent = p.fAppendNLAtTheEndIfNotPresent;
+	fAtomicSave = p.fAtomicSave;
+	fLocalHistory = p.fLocalHistory;
+	fLargeFileThreshold = p.fLargeFileThreshold;
+	fLargeFileDisableStyling = p.fLargeFileDisableStyling;
 	fStyle = p.fStyle;
 	fWindowRect = p.fWindowRect;
 	fFindWindowState = p.fFindWindowState;
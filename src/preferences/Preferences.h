@@ -48,6 +48,7 @@ public:
 	uint32			fLineLimitColumn;
 	bool			fWrapLines;
 	bool			fBracesHighlighting;
+	bool			fHighlightOccurrences;
 	uint8			fCursorWidth;
 	bool			fFullPathInTitle;
 	bool			fCompactLangMenu;
@@ -56,6 +57,10 @@ public:
 	bool			fHighlightTrailingWhitespace;
 	bool			fTrimTrailingWhitespaceOnSave;
 	bool			fAppendNLAtTheEndIfNotPresent;
+	bool			fAtomicSave;
+	bool			fLocalHistory;
+	uint32			fLargeFileThreshold;
+	bool			fLargeFileDisableStyling;
 	bool			fUseEditorconfig;
 	bool			fAlwaysOpenInNewWindow;
 	bool			fUseCustomFont;
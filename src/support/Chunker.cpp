@@ -0,0 +1,85 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include "Chunker.h"
+
+#include <array>
+#include <bit>
+
+
+namespace {
+
+constexpr std::array<uint64_t, 256>
+MakeGearTable()
+{
+	// splitmix64, any fixed pseudo-random table will do
+	std::array<uint64_t, 256> table{};
+	uint64_t state = 0x9e3779b97f4a7c15ULL;
+	for(auto& value : table) {
+		state += 0x9e3779b97f4a7c15ULL;
+		uint64_t z = state;
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+		value = z ^ (z >> 31);
+	}
+	return table;
+}
+
+constexpr std::array<uint64_t, 256> kGear = MakeGearTable();
+
+}
+
+
+Chunker::Chunker(size_t minSize, size_t averageSize, size_t maxSize)
+	:
+	fMinSize(minSize),
+	fMaxSize(maxSize),
+	fHash(0),
+	fChunkSize(0)
+{
+	// the top bits of the gear hash depend on the most bytes, so test those
+	const int bits = std::bit_width(averageSize) - 1;
+	fMask = ((uint64_t(1) << bits) - 1) << (64 - bits);
+}
+
+
+void
+Chunker::Update(std::string_view data, const Callback& callback)
+{
+	size_t start = 0;
+	for(size_t i = 0; i < data.size(); i++) {
+		fHash = (fHash << 1) + kGear[static_cast<uint8_t>(data[i])];
+		fChunkSize++;
+		if(fChunkSize < fMinSize)
+			continue;
+		if((fHash & fMask) != 0 && fChunkSize < fMaxSize)
+			continue;
+
+		std::string_view tail = data.substr(start, i + 1 - start);
+		if(fPending.empty()) {
+			callback(tail);
+		} else {
+			fPending.append(tail);
+			callback(fPending);
+			fPending.clear();
+		}
+		start = i + 1;
+		fHash = 0;
+		fChunkSize = 0;
+	}
+	fPending.append(data.substr(start));
+}
+
+
+void
+Chunker::Finish(const Callback& callback)
+{
+	if(!fPending.empty())
+		callback(fPending);
+	fPending.clear();
+	fHash = 0;
+	fChunkSize = 0;
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#ifndef CHUNKER_H
+#define CHUNKER_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+
+
+/**
+ * Chunker splits a stream of bytes into content-defined chunks using a gear
+ * rolling hash. Boundaries depend only on the bytes just before them, so an
+ * edit in one place changes at most a chunk or two and the rest of the file
+ * splits exactly like before.
+ * Chunks lying entirely within one Update() call are passed as views into the
+ * caller's data; only a chunk spanning several calls is copied.
+ */
+class Chunker {
+public:
+	using Callback = std::function<void(std::string_view chunk)>;
+
+	Chunker(size_t minSize = 2 * 1024, size_t averageSize = 8 * 1024,
+		size_t maxSize = 64 * 1024);
+
+	void		Update(std::string_view data, const Callback& callback);
+	void		Finish(const Callback& callback);
+
+private:
+	size_t		fMinSize;
+	size_t		fMaxSize;
+	uint64_t	fMask;
+	uint64_t	fHash;
+	size_t		fChunkSize;
+	std::string	fPending;
+};
+
+
+#endif // CHUNKER_H
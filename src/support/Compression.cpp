@@ -0,0 +1,393 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include "Compression.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <strings.h>
+
+#include <lzma.h>
+#include <zlib.h>
+#include <zstd.h>
+
+
+namespace {
+
+const size_t kBufferSize = 64 * 1024;
+// zlib counts input in unsigned int
+const size_t kMaxZlibInput = UINT_MAX;
+
+const unsigned char kGzipMagic[] = { 0x1F, 0x8B };
+const unsigned char kZstdMagic[] = { 0x28, 0xB5, 0x2F, 0xFD };
+const unsigned char kXzMagic[] = { 0xFD, '7', 'z', 'X', 'Z', 0x00 };
+
+const struct {
+	const char*	extension;
+	Compression	compression;
+} kExtensions[] = {
+	{ ".gz", Compression::GZIP },
+	{ ".zst", Compression::ZSTD },
+	{ ".xz", Compression::XZ }
+};
+
+
+template<size_t N>
+bool
+StartsWith(const char* data, size_t size, const unsigned char (&magic)[N])
+{
+	return size >= N && memcmp(data, magic, N) == 0;
+}
+
+}
+
+
+/**
+ * Streaming state of one of the formats, in one direction. Process() consumes
+ * all of input and appends what it produces to output. Passing finish = true
+ * ends the stream.
+ */
+class CompressionCodec {
+public:
+	virtual			~CompressionCodec() {}
+
+	virtual	bool	Process(std::string_view input, std::string& output,
+						bool finish) = 0;
+};
+
+
+namespace {
+
+class GzipCodec : public CompressionCodec {
+public:
+	GzipCodec(bool compress)
+		:
+		fCompress(compress),
+		fEnded(false)
+	{
+		memset(&fStream, 0, sizeof(fStream));
+		// +16 writes a gzip header, +32 detects gzip or zlib header
+		int result = fCompress
+			? deflateInit2(&fStream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+				15 + 16, 8, Z_DEFAULT_STRATEGY)
+			: inflateInit2(&fStream, 15 + 32);
+		fValid = result == Z_OK;
+	}
+
+	~GzipCodec()
+	{
+		if(fValid == false)
+			return;
+		if(fCompress)
+			deflateEnd(&fStream);
+		else
+			inflateEnd(&fStream);
+	}
+
+	bool Process(std::string_view input, std::string& output, bool finish)
+	{
+		if(fValid == false)
+			return false;
+		do {
+			const size_t length = std::min(input.size(), kMaxZlibInput);
+			bool result = fCompress
+				? _Deflate(input.substr(0, length), output,
+					finish && length == input.size())
+				: _Inflate(input.substr(0, length), output);
+			if(result == false)
+				return false;
+			input.remove_prefix(length);
+		} while(!input.empty());
+		return fCompress || finish == false || fEnded;
+	}
+
+private:
+	bool _Deflate(std::string_view input, std::string& output, bool finish)
+	{
+		char buffer[kBufferSize];
+		fStream.next_in = (Bytef*) input.data();
+		fStream.avail_in = input.size();
+		do {
+			fStream.next_out = (Bytef*) buffer;
+			fStream.avail_out = sizeof(buffer);
+			if(deflate(&fStream, finish ? Z_FINISH : Z_NO_FLUSH) == Z_STREAM_ERROR)
+				return false;
+			output.append(buffer, sizeof(buffer) - fStream.avail_out);
+		} while(fStream.avail_out == 0);
+		return true;
+	}
+
+	bool _Inflate(std::string_view input, std::string& output)
+	{
+		char buffer[kBufferSize];
+		fStream.next_in = (Bytef*) input.data();
+		fStream.avail_in = input.size();
+		while(true) {
+			if(fEnded == true && fStream.avail_in > 0) {
+				// another stream follows
+				inflateReset(&fStream);
+				fEnded = false;
+			}
+			fStream.next_out = (Bytef*) buffer;
+			fStream.avail_out = sizeof(buffer);
+			int result = inflate(&fStream, Z_NO_FLUSH);
+			output.append(buffer, sizeof(buffer) - fStream.avail_out);
+			if(result == Z_STREAM_END) {
+				fEnded = true;
+				if(fStream.avail_in == 0)
+					return true;
+				continue;
+			}
+			// Z_BUF_ERROR means no progress is possible without more input
+			if(result == Z_BUF_ERROR)
+				return true;
+			if(result != Z_OK)
+				return false;
+			if(fStream.avail_in == 0 && fStream.avail_out != 0)
+				return true;
+		}
+	}
+
+	z_stream	fStream;
+	bool		fCompress;
+	bool		fValid;
+	bool		fEnded;
+};
+
+
+class ZstdCodec : public CompressionCodec {
+public:
+	ZstdCodec(bool compress)
+		:
+		fCompressStream(compress ? ZSTD_createCStream() : nullptr),
+		fDecompressStream(compress ? nullptr : ZSTD_createDStream()),
+		fEnded(false)
+	{
+	}
+
+	~ZstdCodec()
+	{
+		ZSTD_freeCStream(fCompressStream);
+		ZSTD_freeDStream(fDecompressStream);
+	}
+
+	bool Process(std::string_view input, std::string& output, bool finish)
+	{
+		if(fCompressStream != nullptr)
+			return _Compress(input, output, finish);
+		if(fDecompressStream != nullptr)
+			return _Decompress(input, output, finish);
+		return false;
+	}
+
+private:
+	bool _Compress(std::string_view input, std::string& output, bool finish)
+	{
+		char buffer[kBufferSize];
+		ZSTD_inBuffer in = { input.data(), input.size(), 0 };
+		while(true) {
+			ZSTD_outBuffer out = { buffer, sizeof(buffer), 0 };
+			size_t remaining = ZSTD_compressStream2(fCompressStream, &out, &in,
+				finish ? ZSTD_e_end : ZSTD_e_continue);
+			if(ZSTD_isError(remaining))
+				return false;
+			output.append(buffer, out.pos);
+			if(finish ? remaining == 0 : in.pos == in.size)
+				return true;
+		}
+	}
+
+	bool _Decompress(std::string_view input, std::string& output, bool finish)
+	{
+		// without new input the decoder would expect another frame
+		if(input.empty())
+			return finish == false || fEnded;
+
+		char buffer[kBufferSize];
+		ZSTD_inBuffer in = { input.data(), input.size(), 0 };
+		while(true) {
+			ZSTD_outBuffer out = { buffer, sizeof(buffer), 0 };
+			size_t result = ZSTD_decompressStream(fDecompressStream, &out, &in);
+			if(ZSTD_isError(result))
+				return false;
+			output.append(buffer, out.pos);
+			// 0 means a frame has just been completed
+			fEnded = result == 0;
+			if(in.pos == in.size && out.pos < out.size)
+				break;
+		}
+		return finish == false || fEnded;
+	}
+
+	ZSTD_CStream*	fCompressStream;
+	ZSTD_DStream*	fDecompressStream;
+	bool			fEnded;
+};
+
+
+class XzCodec : public CompressionCodec {
+public:
+	XzCodec(bool compress)
+		:
+		fStream(LZMA_STREAM_INIT)
+	{
+		lzma_ret result = compress
+			? lzma_easy_encoder(&fStream, LZMA_PRESET_DEFAULT, LZMA_CHECK_CRC64)
+			: lzma_stream_decoder(&fStream, UINT64_MAX, LZMA_CONCATENATED);
+		fValid = result == LZMA_OK;
+	}
+
+	~XzCodec()
+	{
+		lzma_end(&fStream);
+	}
+
+	bool Process(std::string_view input, std::string& output, bool finish)
+	{
+		if(fValid == false)
+			return false;
+
+		char buffer[kBufferSize];
+		fStream.next_in = reinterpret_cast<const uint8_t*>(input.data());
+		fStream.avail_in = input.size();
+		while(true) {
+			fStream.next_out = reinterpret_cast<uint8_t*>(buffer);
+			fStream.avail_out = sizeof(buffer);
+			lzma_ret result = lzma_code(&fStream, finish ? LZMA_FINISH : LZMA_RUN);
+			output.append(buffer, sizeof(buffer) - fStream.avail_out);
+			if(result == LZMA_STREAM_END)
+				return true;
+			// LZMA_BUF_ERROR here means the data ended too early
+			if(result != LZMA_OK)
+				return false;
+			if(finish == false && fStream.avail_in == 0 && fStream.avail_out != 0)
+				return true;
+		}
+	}
+
+private:
+	lzma_stream		fStream;
+	bool			fValid;
+};
+
+
+std::unique_ptr<CompressionCodec>
+CreateCodec(Compression compression, bool compress)
+{
+	switch(compression) {
+		case Compression::GZIP:
+			return std::make_unique<GzipCodec>(compress);
+		case Compression::ZSTD:
+			return std::make_unique<ZstdCodec>(compress);
+		case Compression::XZ:
+			return std::make_unique<XzCodec>(compress);
+		default:
+			return nullptr;
+	}
+}
+
+}
+
+
+Compression
+DetectCompression(const char* data, size_t size)
+{
+	if(StartsWith(data, size, kGzipMagic))
+		return Compression::GZIP;
+	if(StartsWith(data, size, kZstdMagic))
+		return Compression::ZSTD;
+	if(StartsWith(data, size, kXzMagic))
+		return Compression::XZ;
+	return Compression::NONE;
+}
+
+
+Compression
+CompressionForFilename(const std::string& filename)
+{
+	for(const auto& entry : kExtensions) {
+		const size_t length = strlen(entry.extension);
+		if(filename.size() > length
+				&& strcasecmp(filename.c_str() + filename.size() - length,
+					entry.extension) == 0)
+			return entry.compression;
+	}
+	return Compression::NONE;
+}
+
+
+std::string
+StripCompressionExtension(const std::string& filename)
+{
+	if(CompressionForFilename(filename) == Compression::NONE)
+		return filename;
+	return filename.substr(0, filename.rfind('.'));
+}
+
+
+Decompressor::Decompressor(Compression compression)
+	:
+	fCodec(CreateCodec(compression, false))
+{
+}
+
+
+Decompressor::~Decompressor()
+{
+}
+
+
+bool
+Decompressor::Decompress(std::string_view input, std::string& output)
+{
+	if(fCodec == nullptr) {
+		output.append(input);
+		return true;
+	}
+	return fCodec->Process(input, output, false);
+}
+
+
+bool
+Decompressor::Finish(std::string& output)
+{
+	if(fCodec == nullptr)
+		return true;
+	return fCodec->Process(std::string_view(), output, true);
+}
+
+
+Compressor::Compressor(Compression compression)
+	:
+	fCodec(CreateCodec(compression, true))
+{
+}
+
+
+Compressor::~Compressor()
+{
+}
+
+
+bool
+Compressor::Compress(std::string_view input, std::string& output)
+{
+	if(fCodec == nullptr) {
+		output.append(input);
+		return true;
+	}
+	return fCodec->Process(input, output, false);
+}
+
+
+bool
+Compressor::Finish(std::string& output)
+{
+	if(fCodec == nullptr)
+		return true;
+	return fCodec->Process(std::string_view(), output, true);
+}
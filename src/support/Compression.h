@@ -0,0 +1,89 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+
+/**
+ * Compressed formats Koder can read and write. Files are decompressed while
+ * loading and compressed again on save, the editor only sees plain text.
+ */
+enum class Compression : uint8_t {
+	NONE,
+	GZIP,
+	ZSTD,
+	XZ
+};
+
+
+// enough bytes of the file to recognize any of the formats
+const size_t	kCompressionMagicSize = 6;
+
+/**
+ * Recognizes the format of data from the magic bytes it starts with.
+ */
+Compression		DetectCompression(const char* data, size_t size);
+
+/**
+ * Returns the format implied by the extension of filename (.gz, .zst, .xz).
+ */
+Compression		CompressionForFilename(const std::string& filename);
+
+/**
+ * Returns filename without the extension of a compressed format, so that
+ * e.g. foo.log.gz can be treated as foo.log.
+ */
+std::string		StripCompressionExtension(const std::string& filename);
+
+
+class CompressionCodec;
+
+
+/**
+ * Decompressor decompresses data given in pieces split at arbitrary points.
+ * Several compressed streams following one another (e.g. files joined with
+ * cat) are decompressed as one. With Compression::NONE data is copied as is.
+ * Decompress() returns false if the data is corrupted, Finish() if it ends
+ * in the middle of a stream.
+ */
+class Decompressor {
+public:
+	Decompressor(Compression compression);
+	~Decompressor();
+
+	bool			Decompress(std::string_view input, std::string& output);
+	bool			Finish(std::string& output);
+
+private:
+	std::unique_ptr<CompressionCodec>	fCodec;
+};
+
+
+/**
+ * Compressor compresses data given in pieces into a single stream, which is
+ * complete after Finish(). With Compression::NONE data is copied as is.
+ */
+class Compressor {
+public:
+	Compressor(Compression compression);
+	~Compressor();
+
+	bool			Compress(std::string_view input, std::string& output);
+	bool			Finish(std::string& output);
+
+private:
+	std::unique_ptr<CompressionCodec>	fCodec;
+};
+
+
+#endif // COMPRESSION_H
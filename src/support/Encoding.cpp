@@ -0,0 +1,454 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include "Encoding.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+namespace {
+
+const uint32_t kReplacementCharacter = 0xFFFD;
+// how much of the file is looked at when checking for UTF-16 without BOM
+const size_t kUTF16SampleSize = 4096;
+// text with more than one control character in this many is taken for binary
+const size_t kBinaryControlRatio = 10;
+
+
+/**
+ * Reads one UTF-8 sequence. Returns its length and sets codePoint if it is
+ * valid, 0 if it is valid so far but cut off by the end of data and -1 if it
+ * is malformed (overlong, surrogate, above U+10FFFF, ...).
+ */
+int
+ReadUTF8(const uint8_t* data, size_t size, uint32_t& codePoint)
+{
+	const uint8_t lead = data[0];
+	if(lead < 0x80) {
+		codePoint = lead;
+		return 1;
+	}
+	int length;
+	uint8_t low = 0x80, high = 0xBF;
+	if(lead >= 0xC2 && lead <= 0xDF) {
+		length = 2;
+		codePoint = lead & 0x1F;
+	} else if(lead >= 0xE0 && lead <= 0xEF) {
+		length = 3;
+		codePoint = lead & 0x0F;
+		if(lead == 0xE0)
+			low = 0xA0;
+		else if(lead == 0xED)
+			high = 0x9F;
+	} else if(lead >= 0xF0 && lead <= 0xF4) {
+		length = 4;
+		codePoint = lead & 0x07;
+		if(lead == 0xF0)
+			low = 0x90;
+		else if(lead == 0xF4)
+			high = 0x8F;
+	} else
+		return -1;
+
+	for(int i = 1; i < length; i++) {
+		if(static_cast<size_t>(i) >= size)
+			return 0;
+		const uint8_t byte = data[i];
+		if(byte < low || byte > high)
+			return -1;
+		low = 0x80;
+		high = 0xBF;
+		codePoint = (codePoint << 6) | (byte & 0x3F);
+	}
+	return length;
+}
+
+
+/**
+ * Returns the number of ASCII bytes at the start of data.
+ */
+size_t
+SkipASCII(const uint8_t* data, size_t size)
+{
+	size_t i = 0;
+#if defined(__SSE2__)
+	for(; i + 16 <= size; i += 16) {
+		const __m128i block = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(data + i));
+		if(_mm_movemask_epi8(block) != 0)
+			break;
+	}
+#endif
+	for(; i + 8 <= size; i += 8) {
+		uint64_t block;
+		memcpy(&block, data + i, sizeof(block));
+		if((block & 0x8080808080808080ULL) != 0)
+			break;
+	}
+	while(i < size && data[i] < 0x80)
+		i++;
+	return i;
+}
+
+
+void
+AppendUTF8(std::string& output, uint32_t codePoint)
+{
+	if(codePoint < 0x80) {
+		output += static_cast<char>(codePoint);
+	} else if(codePoint < 0x800) {
+		output += static_cast<char>(0xC0 | (codePoint >> 6));
+		output += static_cast<char>(0x80 | (codePoint & 0x3F));
+	} else if(codePoint < 0x10000) {
+		output += static_cast<char>(0xE0 | (codePoint >> 12));
+		output += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+		output += static_cast<char>(0x80 | (codePoint & 0x3F));
+	} else {
+		output += static_cast<char>(0xF0 | (codePoint >> 18));
+		output += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+		output += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+		output += static_cast<char>(0x80 | (codePoint & 0x3F));
+	}
+}
+
+
+void
+AppendUTF16(std::string& output, uint16_t unit, bool littleEndian)
+{
+	const char low = static_cast<char>(unit & 0xFF);
+	const char high = static_cast<char>(unit >> 8);
+	if(littleEndian) {
+		output += low;
+		output += high;
+	} else {
+		output += high;
+		output += low;
+	}
+}
+
+}
+
+
+const char*
+EncodingName(TextEncoding encoding)
+{
+	switch(encoding) {
+		case TextEncoding::UTF8:		return "UTF-8";
+		case TextEncoding::UTF8_BOM:	return "UTF-8 BOM";
+		case TextEncoding::UTF16_LE:	return "UTF-16 LE";
+		case TextEncoding::UTF16_BE:	return "UTF-16 BE";
+		case TextEncoding::LATIN1:		return "ISO-8859-1";
+	}
+	return "";
+}
+
+
+size_t
+ValidUTF8Prefix(const char* data, size_t size)
+{
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+	size_t i = 0;
+	while(i < size) {
+		if(bytes[i] < 0x80) {
+			i += SkipASCII(bytes + i, size - i);
+			continue;
+		}
+		uint32_t codePoint;
+		const int length = ReadUTF8(bytes + i, size - i, codePoint);
+		if(length <= 0)
+			break;
+		i += length;
+	}
+	return i;
+}
+
+
+TextEncoding
+DetectEncoding(const char* data, size_t size, bool complete)
+{
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+	if(size >= 3 && bytes[0] == 0xEF && bytes[1] == 0xBB && bytes[2] == 0xBF)
+		return TextEncoding::UTF8_BOM;
+	if(size >= 2 && bytes[0] == 0xFF && bytes[1] == 0xFE)
+		return TextEncoding::UTF16_LE;
+	if(size >= 2 && bytes[0] == 0xFE && bytes[1] == 0xFF)
+		return TextEncoding::UTF16_BE;
+
+	// NUL is valid UTF-8, so check for UTF-16 first
+	const size_t sample = std::min(size, kUTF16SampleSize) & ~size_t(1);
+	if(sample >= 4) {
+		size_t evenZeros = 0, oddZeros = 0;
+		for(size_t i = 0; i < sample; i += 2) {
+			evenZeros += bytes[i] == 0;
+			oddZeros += bytes[i + 1] == 0;
+		}
+		const size_t units = sample / 2;
+		if(oddZeros * 10 >= units * 7 && evenZeros * 20 <= units)
+			return TextEncoding::UTF16_LE;
+		if(evenZeros * 10 >= units * 7 && oddZeros * 20 <= units)
+			return TextEncoding::UTF16_BE;
+	}
+
+	const size_t valid = ValidUTF8Prefix(data, size);
+	if(valid == size)
+		return TextEncoding::UTF8;
+	uint32_t codePoint;
+	if(!complete && ReadUTF8(bytes + valid, size - valid, codePoint) == 0)
+		return TextEncoding::UTF8;
+	return TextEncoding::LATIN1;
+}
+
+
+bool
+LooksBinary(const char* data, size_t size)
+{
+	const TextEncoding encoding = DetectEncoding(data, size, false);
+	if(encoding == TextEncoding::UTF16_LE || encoding == TextEncoding::UTF16_BE)
+		return false;
+	if(memchr(data, 0, size) != nullptr)
+		return true;
+
+	// C1 controls are rare in Latin-1 text, in UTF-8 they are continuation bytes
+	const bool latin1 = encoding == TextEncoding::LATIN1;
+	size_t controls = 0;
+	for(size_t i = 0; i < size; i++) {
+		const uint8_t byte = static_cast<uint8_t>(data[i]);
+		if((byte < 0x20 && strchr("\t\n\v\f\r\b\x1B", byte) == nullptr)
+				|| byte == 0x7F || (latin1 && byte >= 0x80 && byte < 0xA0))
+			controls++;
+	}
+	return controls * kBinaryControlRatio > size;
+}
+
+
+bool
+CanEncode(TextEncoding encoding, std::string_view utf8)
+{
+	if(encoding != TextEncoding::LATIN1)
+		return true;
+	// characters above U+00FF start with a byte above 0xC3
+	return std::none_of(utf8.begin(), utf8.end(), [](char c) {
+		const uint8_t byte = static_cast<uint8_t>(c);
+		return byte >= 0xC4 && byte <= 0xF4;
+	});
+}
+
+
+TextDecoder::TextDecoder(TextEncoding encoding)
+	:
+	fEncoding(encoding),
+	fStart(true),
+	fHighSurrogate(0)
+{
+}
+
+
+void
+TextDecoder::Decode(std::string_view input, std::string& output)
+{
+	switch(fEncoding) {
+		case TextEncoding::UTF8:
+		case TextEncoding::UTF8_BOM: {
+			if(fStart) {
+				// wait for enough bytes to recognize the BOM
+				fPending.append(input);
+				if(fPending.size() < 3)
+					return;
+				fStart = false;
+				std::string_view pending(fPending);
+				if(pending.substr(0, 3) == "\xEF\xBB\xBF")
+					pending.remove_prefix(3);
+				output.append(pending);
+				fPending.clear();
+			} else
+				output.append(input);
+		} break;
+		case TextEncoding::LATIN1: {
+			fStart = false;
+			output.reserve(output.size() + input.size());
+			for(const char c : input)
+				AppendUTF8(output, static_cast<uint8_t>(c));
+		} break;
+		case TextEncoding::UTF16_LE:
+		case TextEncoding::UTF16_BE:
+			_DecodeUTF16(input, output);
+		break;
+	}
+}
+
+
+void
+TextDecoder::Finish(std::string& output)
+{
+	if(fEncoding == TextEncoding::UTF8 || fEncoding == TextEncoding::UTF8_BOM) {
+		output.append(fPending);
+	} else if(!fPending.empty() || fHighSurrogate != 0) {
+		AppendUTF8(output, kReplacementCharacter);
+	}
+	fPending.clear();
+	fHighSurrogate = 0;
+}
+
+
+void
+TextDecoder::_DecodeUTF16(std::string_view input, std::string& output)
+{
+	const bool littleEndian = fEncoding == TextEncoding::UTF16_LE;
+	const auto unitFrom = [littleEndian](char first, char second) {
+		const uint32_t a = static_cast<uint8_t>(first);
+		const uint32_t b = static_cast<uint8_t>(second);
+		return littleEndian ? (a | b << 8) : (a << 8 | b);
+	};
+
+	output.reserve(output.size() + input.size() / 2 * 3);
+	size_t i = 0;
+	while(true) {
+		uint32_t unit;
+		if(!fPending.empty()) {
+			// one byte left over from the previous piece
+			if(i >= input.size())
+				break;
+			unit = unitFrom(fPending[0], input[i]);
+			fPending.clear();
+			i++;
+		} else {
+			if(i + 2 > input.size()) {
+				if(i < input.size())
+					fPending.assign(1, input[i]);
+				break;
+			}
+			unit = unitFrom(input[i], input[i + 1]);
+			i += 2;
+		}
+
+		if(fStart) {
+			fStart = false;
+			if(unit == 0xFEFF)
+				continue;
+		}
+		if(fHighSurrogate != 0) {
+			if(unit >= 0xDC00 && unit <= 0xDFFF) {
+				AppendUTF8(output, 0x10000 + ((fHighSurrogate - 0xD800) << 10)
+					+ (unit - 0xDC00));
+				fHighSurrogate = 0;
+				continue;
+			}
+			AppendUTF8(output, kReplacementCharacter);
+			fHighSurrogate = 0;
+		}
+		if(unit >= 0xD800 && unit <= 0xDBFF)
+			fHighSurrogate = unit;
+		else if(unit >= 0xDC00 && unit <= 0xDFFF)
+			AppendUTF8(output, kReplacementCharacter);
+		else
+			AppendUTF8(output, unit);
+	}
+}
+
+
+TextEncoder::TextEncoder(TextEncoding encoding)
+	:
+	fEncoding(encoding),
+	fStart(true)
+{
+}
+
+
+void
+TextEncoder::Encode(std::string_view input, std::string& output)
+{
+	if(fStart) {
+		fStart = false;
+		switch(fEncoding) {
+			case TextEncoding::UTF8_BOM:	output.append("\xEF\xBB\xBF"); break;
+			case TextEncoding::UTF16_LE:	output.append("\xFF\xFE"); break;
+			case TextEncoding::UTF16_BE:	output.append("\xFE\xFF"); break;
+			default: break;
+		}
+	}
+	if(fEncoding == TextEncoding::UTF8 || fEncoding == TextEncoding::UTF8_BOM) {
+		output.append(input);
+		return;
+	}
+
+	// complete a sequence cut off at the end of the previous piece
+	while(!fPending.empty() && !input.empty()) {
+		fPending += input.front();
+		input.remove_prefix(1);
+		uint32_t codePoint;
+		const int length = ReadUTF8(
+			reinterpret_cast<const uint8_t*>(fPending.data()), fPending.size(),
+			codePoint);
+		if(length > 0) {
+			_Put(codePoint, output);
+			fPending.clear();
+		} else if(length < 0) {
+			_Put(kReplacementCharacter, output);
+			// the byte which broke the sequence may start a new one
+			input = std::string_view(input.data() - 1, input.size() + 1);
+			fPending.clear();
+		}
+	}
+
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(input.data());
+	size_t i = 0;
+	while(i < input.size()) {
+		uint32_t codePoint;
+		const int length = ReadUTF8(bytes + i, input.size() - i, codePoint);
+		if(length == 0) {
+			fPending.assign(input.substr(i));
+			break;
+		}
+		if(length < 0) {
+			_Put(kReplacementCharacter, output);
+			i++;
+		} else {
+			_Put(codePoint, output);
+			i += length;
+		}
+	}
+}
+
+
+void
+TextEncoder::Finish(std::string& output)
+{
+	if(fStart)
+		Encode(std::string_view(), output);
+	if(!fPending.empty())
+		_Put(kReplacementCharacter, output);
+	fPending.clear();
+}
+
+
+void
+TextEncoder::_Put(uint32_t codePoint, std::string& output)
+{
+	switch(fEncoding) {
+		case TextEncoding::LATIN1:
+			output += codePoint <= 0xFF ? static_cast<char>(codePoint) : '?';
+		break;
+		case TextEncoding::UTF16_LE:
+		case TextEncoding::UTF16_BE: {
+			const bool littleEndian = fEncoding == TextEncoding::UTF16_LE;
+			if(codePoint < 0x10000) {
+				AppendUTF16(output, codePoint, littleEndian);
+			} else {
+				codePoint -= 0x10000;
+				AppendUTF16(output, 0xD800 + (codePoint >> 10), littleEndian);
+				AppendUTF16(output, 0xDC00 + (codePoint & 0x3FF), littleEndian);
+			}
+		} break;
+		default:
+			AppendUTF8(output, codePoint);
+		break;
+	}
+}
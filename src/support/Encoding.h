@@ -0,0 +1,105 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#ifndef ENCODING_H
+#define ENCODING_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+
+/**
+ * Encodings Koder can read and write. Text is always edited as UTF-8 and
+ * converted from and to the encoding of the file on load and save.
+ */
+enum class TextEncoding : uint8_t {
+	UTF8,
+	UTF8_BOM,
+	UTF16_LE,
+	UTF16_BE,
+	LATIN1
+};
+
+
+const char*		EncodingName(TextEncoding encoding);
+
+/**
+ * Returns the length of the longest prefix of data that is valid UTF-8.
+ * Runs of ASCII are skipped 16 (SSE2) or 8 bytes at a time.
+ */
+size_t			ValidUTF8Prefix(const char* data, size_t size);
+
+/**
+ * Guesses the encoding of data from its byte order mark. Without one, data
+ * is UTF-8 if it is valid, UTF-16 if it looks like mostly ASCII text
+ * with every other byte being NUL, Latin-1 otherwise.
+ * If data is only the beginning of a file pass complete = false, so that
+ * a character cut in half at the end is not taken for invalid UTF-8.
+ */
+TextEncoding	DetectEncoding(const char* data, size_t size,
+					bool complete = true);
+
+/**
+ * Guesses whether data, usually the beginning of a file, is not text at all.
+ * It is if it contains NUL bytes (and is not UTF-16) or too many control
+ * characters.
+ */
+bool			LooksBinary(const char* data, size_t size);
+
+/**
+ * Returns false if utf8 contains characters which cannot be represented
+ * in encoding. Text can be checked in arbitrary pieces.
+ */
+bool			CanEncode(TextEncoding encoding, std::string_view utf8);
+
+
+/**
+ * TextDecoder converts text in a given encoding to UTF-8, in pieces split at
+ * arbitrary points. A byte order mark at the start is dropped. Malformed
+ * input is replaced with U+FFFD.
+ */
+class TextDecoder {
+public:
+	TextDecoder(TextEncoding encoding);
+
+	void			Decode(std::string_view input, std::string& output);
+	void			Finish(std::string& output);
+
+private:
+	void			_DecodeUTF16(std::string_view input, std::string& output);
+
+	TextEncoding	fEncoding;
+	bool			fStart;
+	std::string		fPending;
+	uint32_t		fHighSurrogate;
+};
+
+
+/**
+ * TextEncoder converts UTF-8 text to a given encoding, in pieces split at
+ * arbitrary points. A byte order mark is written first for encodings which
+ * had one. Characters which cannot be encoded are replaced with '?' (Latin-1)
+ * or U+FFFD (invalid UTF-8).
+ */
+class TextEncoder {
+public:
+	TextEncoder(TextEncoding encoding);
+
+	void			Encode(std::string_view input, std::string& output);
+	void			Finish(std::string& output);
+
+private:
+	void			_Put(uint32_t codePoint, std::string& output);
+
+	TextEncoding	fEncoding;
+	bool			fStart;
+	std::string		fPending;
+};
+
+
+#endif // ENCODING_H
@@ -8,19 +8,40 @@
 
 #include <CopyEngine.h>
 #include <EntryOperationEngineBase.h>
+#include <Entry.h>
 #include <NodeInfo.h>
 #include <NodeMonitor.h>
+#include <OS.h>
+#include <Path.h>
+#include <String.h>
 #include <Volume.h>
 #include <kernel/fs_attr.h>
 
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
 #include <vector>
 #include <string>
 
+#include "Encoding.h"
+#include "FileState.h"
+
 
 namespace {
 
-const std::string kCaretPositionAttribute = "be:caret_position";
-const std::string kBookmarksAttribute = "koder:bookmarks";
+const char* kStateAttribute = "koder:state";
+// read by other applications too, still written next to the state
+const char* kCaretPositionAttribute = "be:caret_position";
+// used before the state was kept in one attribute
+const char* kBookmarksAttribute = "koder:bookmarks";
+// far more than folds and bookmarks of any real file take
+const size_t kMaxStateSize = 64 * 1024;
+// how much of the file is looked at to tell binary files from text
+const size_t kBinarySniffSize = 8192;
 
 }
 
@@ -49,40 +70,51 @@ File::File(const char* path, uint32 openMode)
 }
 
 
+/**
+ * Reads the whole file into a NUL terminated buffer. The terminator is not
+ * part of the contents, so the file is buffer.size() - 1 bytes long and may
+ * contain NUL bytes itself.
+ */
 std::vector<char>
 File::Read()
 {
 	off_t size;
 	GetSize(&size);
 	std::vector<char> buffer(size + 1);
-	BFile::Read(buffer.data(), buffer.size());
-	buffer[size] = 0;
+	ssize_t bytesRead = BFile::Read(buffer.data(), size);
+	buffer.resize(std::max<ssize_t>(bytesRead, 0) + 1);
+	buffer.back() = 0;
 	return buffer;
 }
 
 
-void
-File::Write(std::vector<char> &buffer)
-{
-	BFile::Write(buffer.data(), buffer.size() - 1);
-}
-
-
-void
-File::WriteCaretPosition(int32 caretPos)
+/**
+ * Looks at the beginning of the file to tell whether it is binary.
+ */
+bool
+File::LooksBinary()
 {
-	BFile::WriteAttr(kCaretPositionAttribute.c_str(), B_INT32_TYPE, 0,
-		&caretPos, sizeof(int32));
+	char buffer[kBinarySniffSize];
+	ssize_t bytesRead = ReadAt(0, buffer, sizeof(buffer));
+	return bytesRead > 0 && ::LooksBinary(buffer, bytesRead);
 }
 
 
-int32
-File::ReadCaretPosition()
+/**
+ * Writes all of data at the current position, retrying after short writes.
+ */
+status_t
+File::Write(std::string_view data)
 {
-	int32 caretPos = 0;
-	BFile::ReadAttr(kCaretPositionAttribute.c_str(), B_INT32_TYPE, 0,
-		&caretPos, sizeof(int32));
-	return caretPos;
+	while(!data.empty()) {
+		ssize_t written = BFile::Write(data.data(), data.size());
+		if(written < 0)
+			return written;
+		if(written == 0)
+			return B_IO_ERROR;
+		data.remove_prefix(written);
+	}
+	return B_OK;
 }
 
 
@@ -104,30 +136,69 @@ File::ReadMimeType()
 }
 
 
-void
-File::WriteBookmarks(BMessage bookmarks)
+/**
+ * Reads the editor state with a single attribute read. Files which were last
+ * closed by an older version have only the caret position and bookmarks in
+ * separate attributes, those are used if the state is missing.
+ */
+status_t
+File::ReadState(FileState& state)
 {
-	BMallocIO mallocIO;
-	bookmarks.Flatten(&mallocIO);
-	BFile::WriteAttr(kBookmarksAttribute.c_str(), B_MESSAGE_TYPE, 0,
-		mallocIO.Buffer(), mallocIO.BufferLength());
+	std::string buffer(kMaxStateSize, '\0');
+	ssize_t bytesRead = ReadAttr(kStateAttribute, B_RAW_TYPE, 0,
+		buffer.data(), buffer.size());
+	if(bytesRead >= 0) {
+		buffer.resize(bytesRead);
+		return state.Deserialize(buffer) ? B_OK : B_BAD_DATA;
+	}
+	if(bytesRead != B_ENTRY_NOT_FOUND)
+		return bytesRead;
+
+	int32 caret;
+	bool found = false;
+	if(ReadAttr(kCaretPositionAttribute, B_INT32_TYPE, 0, &caret,
+			sizeof(caret)) == sizeof(caret)) {
+		state.caret = state.anchor = caret;
+		found = true;
+	}
+	attr_info info;
+	if(GetAttrInfo(kBookmarksAttribute, &info) == B_OK
+			&& info.type == B_MESSAGE_TYPE) {
+		std::vector<char> data(info.size);
+		ReadAttr(kBookmarksAttribute, B_MESSAGE_TYPE, 0, data.data(),
+			data.size());
+		BMemoryIO memIO(data.data(), data.size());
+		BMessage bookmarks;
+		if(bookmarks.Unflatten(&memIO) == B_OK) {
+			int64 line;
+			for(int32 i = 0; bookmarks.FindInt64("line", i, &line) == B_OK; i++)
+				state.bookmarks.push_back(line);
+			found = true;
+		}
+	}
+	return found ? B_OK : B_ENTRY_NOT_FOUND;
 }
 
 
-BMessage
-File::ReadBookmarks()
+/**
+ * Writes the editor state, and the caret position on its own in the
+ * attribute other Haiku applications use.
+ */
+status_t
+File::WriteState(const FileState& state)
 {
-	BMessage bookmarks;
-	attr_info info;
-	BFile::GetAttrInfo(kBookmarksAttribute.c_str(), &info);
-	if(info.type == B_MESSAGE_TYPE) {
-		std::vector<char> buffer(info.size);
-		BFile::ReadAttr(kBookmarksAttribute.c_str(), B_MESSAGE_TYPE, 0,
-			buffer.data(), buffer.size());
-		BMemoryIO memIO(buffer.data(), buffer.size());
-		bookmarks.Unflatten(&memIO);
-	}
-	return bookmarks;
+	const std::string data = state.Serialize();
+	if(data.size() > kMaxStateSize)
+		return B_BUFFER_OVERFLOW;
+	ssize_t written = WriteAttr(kStateAttribute, B_RAW_TYPE, 0, data.data(),
+		data.size());
+	if(written < 0)
+		return written;
+	const int32 caret = static_cast<int32>(std::clamp<int64_t>(state.caret, 0,
+		INT32_MAX));
+	written = WriteAttr(kCaretPositionAttribute, B_INT32_TYPE, 0, &caret,
+		sizeof(caret));
+	return written < 0 ? written : B_OK;
 }
 
 
@@ -207,6 +278,132 @@ File::SetWritable(BStatable* file, bool writable)
 }
 
 
+AtomicFile::AtomicFile(const char* path)
+	:
+	File(static_cast<const char*>(nullptr), 0),
+	fCommitted(false)
+{
+	// replace the file a symlink points to, not the symlink itself
+	BEntry entry(path, true);
+	BPath resolved;
+	if(entry.InitCheck() != B_OK || entry.GetPath(&resolved) != B_OK) {
+		Unset();
+		return;
+	}
+	fPath = resolved.Path();
+	if(entry.Exists() && File::CanWrite(&entry) == false) {
+		Unset();
+		return;
+	}
+
+	BPath directory;
+	resolved.GetParent(&directory);
+	BString name;
+	name.SetToFormat(".%s.koder-%" B_PRId32 "-%" B_PRId64, resolved.Leaf(),
+		find_thread(nullptr), system_time());
+	directory.Append(name.String());
+	fTemporaryPath = directory.Path();
+	SetTo(fTemporaryPath.c_str(), B_WRITE_ONLY | B_CREATE_FILE | B_FAIL_IF_EXISTS);
+}
+
+
+AtomicFile::~AtomicFile()
+{
+	if(fCommitted == false && !fTemporaryPath.empty())
+		BEntry(fTemporaryPath.c_str()).Remove();
+}
+
+
+status_t
+AtomicFile::Commit()
+{
+	status_t status = InitCheck();
+	if(status != B_OK)
+		return status;
+
+	if((status = Sync()) != B_OK)
+		return status;
+
+	BNode original(fPath.c_str());
+	if(original.InitCheck() == B_OK) {
+		_CopyAttributesFrom(original);
+		mode_t permissions;
+		if(original.GetPermissions(&permissions) == B_OK)
+			SetPermissions(permissions);
+		uid_t owner;
+		gid_t group;
+		// might fail if we are not the owner, this is not fatal
+		if(original.GetOwner(&owner) == B_OK)
+			SetOwner(owner);
+		if(original.GetGroup(&group) == B_OK)
+			SetGroup(group);
+	}
+
+	BEntry temporary(fTemporaryPath.c_str());
+	if((status = temporary.Rename(fPath.c_str(), true)) != B_OK)
+		return status;
+	fCommitted = true;
+	return B_OK;
+}
+
+
+void
+AtomicFile::_CopyAttributesFrom(BNode& node)
+{
+	char name[B_ATTR_NAME_LENGTH];
+	node.RewindAttrs();
+	while(node.GetNextAttrName(name) == B_OK) {
+		attr_info info;
+		if(node.GetAttrInfo(name, &info) != B_OK)
+			continue;
+		std::vector<char> buffer(info.size);
+		ssize_t bytesRead = node.ReadAttr(name, info.type, 0, buffer.data(),
+			buffer.size());
+		if(bytesRead >= 0)
+			WriteAttr(name, info.type, 0, buffer.data(), bytesRead);
+	}
+}
+
+
+FileMapping::FileMapping(const char* path)
+	:
+	fData(nullptr),
+	fSize(0),
+	fStatus(B_NO_INIT)
+{
+	int fd = open(path, O_RDONLY);
+	if(fd < 0) {
+		fStatus = errno;
+		return;
+	}
+
+	struct stat st;
+	if(fstat(fd, &st) != 0) {
+		fStatus = errno;
+	} else if(st.st_size == 0) {
+		fStatus = B_OK;
+	} else {
+		void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if(data == MAP_FAILED) {
+			fStatus = errno;
+		} else {
+			fData = static_cast<char*>(data);
+			fSize = st.st_size;
+			fStatus = B_OK;
+		}
+	}
+	// the mapping stays valid after the descriptor is closed
+	close(fd);
+}
+
+
+FileMapping::~FileMapping()
+{
+	if(fData != nullptr)
+		munmap(fData, fSize);
+}
+
+
 BackupFileGuard::BackupFileGuard(const char* path, BHandler* /*handler*/)
 	:
 	fPath(path ? path : ""),
@@ -10,10 +10,12 @@
 #include <Message.h>
 
 #include <string>
+#include <string_view>
 #include <vector>
 
 
 struct entry_ref;
+struct FileState;
 class BEntry;
 
 
@@ -24,14 +26,13 @@ public:
 	File(const char* path, uint32 openMode);
 
 	std::vector<char>	Read();
-	void				Write(std::vector<char> &buffer);
+	status_t			Write(std::string_view data);
+	bool				LooksBinary();
 
-	int32				ReadCaretPosition();
-	void				WriteCaretPosition(int32 caretPos);
+	status_t			ReadState(FileState& state);
+	status_t			WriteState(const FileState& state);
 	std::string			ReadMimeType();
 	void				WriteMimeType(std::string mimeType);
-	BMessage			ReadBookmarks();
-	void				WriteBookmarks(BMessage bookmarks);
 
 	status_t			Monitor(bool enable, BHandler* handler);
 
@@ -42,6 +43,56 @@ public:
 };
 
 
+/**
+ * AtomicFile is a temporary file created next to path. Once everything is
+ * written, Commit() flushes it to disk, carries over attributes and
+ * permissions of the existing file and renames it over path. If Commit() is
+ * never reached the temporary file is removed and path stays untouched, so
+ * there is no need for a backup copy.
+ * If the existing file is not writable, or the directory does not allow
+ * creating files, InitCheck() fails.
+ */
+class AtomicFile : public File {
+public:
+	AtomicFile(const char* path);
+	~AtomicFile();
+
+	status_t			Commit();
+
+private:
+	void				_CopyAttributesFrom(BNode& node);
+
+	std::string			fPath;
+	std::string			fTemporaryPath;
+	bool				fCommitted;
+};
+
+
+/**
+ * FileMapping maps a whole file read-only into memory for as long as it exists.
+ * Pages come straight from the file cache, so the contents can be handed to
+ * Scintilla without reading them into an intermediate buffer first.
+ * Empty files map successfully, with Data() returning nullptr.
+ */
+class FileMapping {
+public:
+	FileMapping(const char* path);
+	~FileMapping();
+
+	status_t	InitCheck() const { return fStatus; }
+	const char*	Data() const { return fData; }
+	size_t		Size() const { return fSize; }
+
+private:
+	FileMapping(const FileMapping&) = delete;
+	FileMapping& operator=(const FileMapping&) = delete;
+
+	char*		fData;
+	size_t		fSize;
+	status_t	fStatus;
+};
+
+
 /**
  * BackupFileGuard will create a backup of a file and let it exist until the
  * guard goes out of scope. If SaveSuccessful() checkpoint is not reached
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include "FileState.h"
+
+#include <algorithm>
+#include <utility>
+
+
+namespace {
+
+const uint8_t kVersion = 1;
+// a 64-bit value takes at most 10 groups of 7 bits
+const uint64_t kMaxVarintLength = 10;
+
+
+void
+WriteVarint(std::string& out, uint64_t value)
+{
+	while(value >= 0x80) {
+		out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	out.push_back(static_cast<char>(value));
+}
+
+
+bool
+ReadVarint(std::string_view& in, uint64_t& value)
+{
+	value = 0;
+	for(uint64_t i = 0; i < kMaxVarintLength && i < in.size(); i++) {
+		const uint8_t byte = in[i];
+		value |= static_cast<uint64_t>(byte & 0x7F) << (7 * i);
+		if((byte & 0x80) == 0) {
+			in.remove_prefix(i + 1);
+			return true;
+		}
+	}
+	return false;
+}
+
+
+bool
+ReadPosition(std::string_view& in, int64_t& value)
+{
+	uint64_t raw;
+	if(ReadVarint(in, raw) == false || raw > INT64_MAX)
+		return false;
+	value = raw;
+	return true;
+}
+
+
+/**
+ * Lines are stored as differences from the previous one, which keeps them
+ * at a byte or two each.
+ */
+void
+WriteLines(std::string& out, const std::vector<int64_t>& lines)
+{
+	WriteVarint(out, lines.size());
+	int64_t previous = 0;
+	for(int64_t line : lines) {
+		WriteVarint(out, line - previous);
+		previous = line;
+	}
+}
+
+
+bool
+ReadLines(std::string_view& in, std::vector<int64_t>& lines)
+{
+	uint64_t count;
+	// every line takes at least a byte
+	if(ReadVarint(in, count) == false || count > in.size())
+		return false;
+	lines.clear();
+	lines.reserve(count);
+	int64_t previous = 0;
+	for(uint64_t i = 0; i < count; i++) {
+		int64_t delta;
+		if(ReadPosition(in, delta) == false || delta > INT64_MAX - previous)
+			return false;
+		previous += delta;
+		lines.push_back(previous);
+	}
+	return true;
+}
+
+
+std::vector<int64_t>
+Normalized(std::vector<int64_t> lines)
+{
+	std::erase_if(lines, [](int64_t line) { return line < 0; });
+	std::sort(lines.begin(), lines.end());
+	lines.erase(std::unique(lines.begin(), lines.end()), lines.end());
+	return lines;
+}
+
+}
+
+
+/**
+ * Record layout: version byte, then caret, anchor and first visible line,
+ * followed by the fold and bookmark lines, all as LEB128 varints.
+ * Negative values are stored as 0, unsorted lines are sorted first.
+ */
+std::string
+FileState::Serialize() const
+{
+	std::string out;
+	out.push_back(static_cast<char>(kVersion));
+	WriteVarint(out, std::max<int64_t>(caret, 0));
+	WriteVarint(out, std::max<int64_t>(anchor, 0));
+	WriteVarint(out, std::max<int64_t>(firstVisibleLine, 0));
+	WriteLines(out, Normalized(folds));
+	WriteLines(out, Normalized(bookmarks));
+	return out;
+}
+
+
+/**
+ * Fills the state from a record made by Serialize(). Returns false, leaving
+ * the state unchanged, if the record is damaged or of an unknown version.
+ */
+bool
+FileState::Deserialize(std::string_view data)
+{
+	if(data.empty() || static_cast<uint8_t>(data[0]) != kVersion)
+		return false;
+	data.remove_prefix(1);
+
+	FileState state;
+	if(ReadPosition(data, state.caret) == false
+			|| ReadPosition(data, state.anchor) == false
+			|| ReadPosition(data, state.firstVisibleLine) == false
+			|| ReadLines(data, state.folds) == false
+			|| ReadLines(data, state.bookmarks) == false
+			|| !data.empty())
+		return false;
+	*this = std::move(state);
+	return true;
+}
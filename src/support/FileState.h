@@ -0,0 +1,38 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#ifndef FILESTATE_H
+#define FILESTATE_H
+
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+/**
+ * FileState is what the editor remembers about a file between sessions:
+ * where the caret and selection were, which line was at the top of the view,
+ * which folds were collapsed and which lines were bookmarked.
+ * It is serialized into a small versioned record, so that it can be read and
+ * written with a single attribute operation.
+ */
+struct FileState {
+	int64_t					caret = 0;
+	int64_t					anchor = 0;
+	int64_t					firstVisibleLine = 0;
+	// lines, in ascending order
+	std::vector<int64_t>	folds;
+	std::vector<int64_t>	bookmarks;
+
+	bool					operator==(const FileState& other) const = default;
+
+	std::string				Serialize() const;
+	bool					Deserialize(std::string_view data);
+};
+
+
+#endif // FILESTATE_H
@@ -0,0 +1,102 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include "FileStateStore.h"
+
+#include <Directory.h>
+#include <Volume.h>
+
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "File.h"
+#include "FileState.h"
+#include "Hash.h"
+
+
+namespace {
+
+bool
+KnowsAttributes(File& file)
+{
+	BVolume volume;
+	return file.GetVolume(&volume) == B_OK && volume.KnowsAttr();
+}
+
+}
+
+
+FileStateStore::FileStateStore(const BPath& cacheDirectory)
+	:
+	fCacheDirectory(cacheDirectory)
+{
+}
+
+
+status_t
+FileStateStore::Read(const char* path, FileState& state)
+{
+	File file(path, B_READ_ONLY);
+	status_t status = file.InitCheck();
+	if(status != B_OK)
+		return status;
+	if(KnowsAttributes(file))
+		return file.ReadState(state);
+
+	// the cached record starts with the full path, in case two paths
+	// end up with the same hash
+	File cache(_CachePath(path).Path(), B_READ_ONLY);
+	if((status = cache.InitCheck()) != B_OK)
+		return status;
+	std::vector<char> buffer = cache.Read();
+	std::string_view data(buffer.data(), buffer.size() - 1);
+	const std::string_view expected(path, strlen(path) + 1);
+	if(data.substr(0, expected.size()) != expected)
+		return B_ENTRY_NOT_FOUND;
+	data.remove_prefix(expected.size());
+	return state.Deserialize(data) ? B_OK : B_BAD_DATA;
+}
+
+
+status_t
+FileStateStore::Write(const char* path, const FileState& state)
+{
+	File file(path, B_READ_ONLY);
+	status_t status = file.InitCheck();
+	if(status != B_OK)
+		return status;
+	if(KnowsAttributes(file))
+		return file.WriteState(state);
+
+	create_directory(fCacheDirectory.Path(), 0755);
+	AtomicFile cache(_CachePath(path).Path());
+	if((status = cache.InitCheck()) != B_OK)
+		return status;
+	if((status = cache.Write(std::string_view(path, strlen(path) + 1))) != B_OK
+			|| (status = cache.Write(state.Serialize())) != B_OK)
+		return status;
+	return cache.Commit();
+}
+
+
+BPath
+FileStateStore::Directory(const BPath& settingsPath)
+{
+	BPath path(settingsPath);
+	path.Append("state");
+	return path;
+}
+
+
+BPath
+FileStateStore::_CachePath(const char* path) const
+{
+	BPath cachePath(fCacheDirectory);
+	cachePath.Append(HashData(path).ToString().c_str());
+	return cachePath;
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#ifndef FILESTATESTORE_H
+#define FILESTATESTORE_H
+
+
+#include <Path.h>
+#include <SupportDefs.h>
+
+
+struct FileState;
+
+
+/**
+ * FileStateStore keeps the editor state of files in their koder:state
+ * attribute. Files on volumes which do not support attributes (e.g. FAT or
+ * network shares) get a small file in a cache directory instead, named after
+ * the hash of their path.
+ */
+class FileStateStore {
+public:
+	FileStateStore(const BPath& cacheDirectory);
+
+	status_t		Read(const char* path, FileState& state);
+	status_t		Write(const char* path, const FileState& state);
+
+	static	BPath	Directory(const BPath& settingsPath);
+
+private:
+	BPath			_CachePath(const char* path) const;
+
+	BPath			fCacheDirectory;
+};
+
+
+#endif // FILESTATESTORE_H
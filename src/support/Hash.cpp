@@ -0,0 +1,145 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include "Hash.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+
+namespace {
+
+const uint64_t kC1 = 0x87c37b91114253d5ULL;
+const uint64_t kC2 = 0x4cf5ad432745937fULL;
+
+
+inline uint64_t
+rotl64(uint64_t x, int8_t r)
+{
+	return (x << r) | (x >> (64 - r));
+}
+
+
+inline uint64_t
+fmix64(uint64_t k)
+{
+	k ^= k >> 33;
+	k *= 0xff51afd7ed558ccdULL;
+	k ^= k >> 33;
+	k *= 0xc4ceb9fe1a85ec53ULL;
+	k ^= k >> 33;
+	return k;
+}
+
+
+inline uint64_t
+load64(const uint8_t* p)
+{
+	uint64_t value;
+	memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+}
+
+
+std::string
+Hash128::ToString() const
+{
+	char buffer[33];
+	snprintf(buffer, sizeof(buffer), "%016llx%016llx",
+		static_cast<unsigned long long>(high),
+		static_cast<unsigned long long>(low));
+	return buffer;
+}
+
+
+Hasher::Hasher(uint64_t seed)
+	:
+	fH1(seed),
+	fH2(seed),
+	fTailSize(0),
+	fLength(0)
+{
+}
+
+
+void
+Hasher::Update(const void* data, size_t size)
+{
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	fLength += size;
+	if(fTailSize > 0) {
+		size_t missing = sizeof(fTail) - fTailSize;
+		if(size < missing) {
+			memcpy(fTail + fTailSize, bytes, size);
+			fTailSize += size;
+			return;
+		}
+		memcpy(fTail + fTailSize, bytes, missing);
+		_Block(fTail);
+		fTailSize = 0;
+		bytes += missing;
+		size -= missing;
+	}
+	for(; size >= sizeof(fTail); bytes += sizeof(fTail), size -= sizeof(fTail))
+		_Block(bytes);
+	memcpy(fTail, bytes, size);
+	fTailSize = size;
+}
+
+
+Hash128
+Hasher::Final() const
+{
+	uint64_t h1 = fH1;
+	uint64_t h2 = fH2;
+	uint64_t k1 = 0;
+	uint64_t k2 = 0;
+	for(size_t i = fTailSize; i > 8; i--)
+		k2 ^= static_cast<uint64_t>(fTail[i - 1]) << ((i - 9) * 8);
+	if(fTailSize > 8) {
+		k2 *= kC2; k2 = rotl64(k2, 33); k2 *= kC1; h2 ^= k2;
+	}
+	for(size_t i = std::min<size_t>(fTailSize, 8); i > 0; i--)
+		k1 ^= static_cast<uint64_t>(fTail[i - 1]) << ((i - 1) * 8);
+	if(fTailSize > 0) {
+		k1 *= kC1; k1 = rotl64(k1, 31); k1 *= kC2; h1 ^= k1;
+	}
+
+	h1 ^= fLength;
+	h2 ^= fLength;
+	h1 += h2;
+	h2 += h1;
+	h1 = fmix64(h1);
+	h2 = fmix64(h2);
+	h1 += h2;
+	h2 += h1;
+	return Hash128{ h1, h2 };
+}
+
+
+void
+Hasher::_Block(const uint8_t* block)
+{
+	uint64_t k1 = load64(block);
+	uint64_t k2 = load64(block + 8);
+
+	k1 *= kC1; k1 = rotl64(k1, 31); k1 *= kC2; fH1 ^= k1;
+	fH1 = rotl64(fH1, 27); fH1 += fH2; fH1 = fH1 * 5 + 0x52dce729;
+	k2 *= kC2; k2 = rotl64(k2, 33); k2 *= kC1; fH2 ^= k2;
+	fH2 = rotl64(fH2, 31); fH2 += fH1; fH2 = fH2 * 5 + 0x38495ab5;
+}
+
+
+Hash128
+HashData(std::string_view data, uint64_t seed)
+{
+	Hasher hasher(seed);
+	hasher.Update(data);
+	return hasher.Final();
+}
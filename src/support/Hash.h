@@ -0,0 +1,53 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#ifndef HASH_H
+#define HASH_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+
+struct Hash128 {
+	uint64_t	high = 0;
+	uint64_t	low = 0;
+
+	bool		operator==(const Hash128& other) const = default;
+	std::string	ToString() const;
+};
+
+
+/**
+ * Hasher computes 128-bit MurmurHash3 (x64 variant) of data fed to it in
+ * arbitrary pieces. The result does not depend on how the data was split.
+ * It is not cryptographic, but good enough to identify contents.
+ */
+class Hasher {
+public:
+	Hasher(uint64_t seed = 0);
+
+	void		Update(const void* data, size_t size);
+	void		Update(std::string_view data) { Update(data.data(), data.size()); }
+	Hash128		Final() const;
+	uint64_t	Length() const { return fLength; }
+
+private:
+	void		_Block(const uint8_t* block);
+
+	uint64_t	fH1;
+	uint64_t	fH2;
+	uint8_t		fTail[16];
+	size_t		fTailSize;
+	uint64_t	fLength;
+};
+
+
+Hash128 HashData(std::string_view data, uint64_t seed = 0);
+
+
+#endif // HASH_H
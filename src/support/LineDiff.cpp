@@ -0,0 +1,141 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include "LineDiff.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+
+#include "Hash.h"
+
+
+namespace {
+
+struct Lines {
+	std::string_view		text;
+	// offset of every line and of the end of text
+	std::vector<size_t>		offsets;
+	std::vector<uint64_t>	hashes;
+
+	Lines(std::string_view data)
+		:
+		text(data)
+	{
+		size_t offset = 0;
+		while(offset < text.size()) {
+			size_t end = text.find('\n', offset);
+			end = end == std::string_view::npos ? text.size() : end + 1;
+			offsets.push_back(offset);
+			hashes.push_back(HashData(text.substr(offset, end - offset)).low);
+			offset = end;
+		}
+		offsets.push_back(text.size());
+	}
+
+	size_t Count() const { return hashes.size(); }
+
+	std::string_view Line(size_t index) const
+	{
+		return text.substr(offsets[index], offsets[index + 1] - offsets[index]);
+	}
+};
+
+
+bool
+Equal(const Lines& a, size_t i, const Lines& b, size_t j)
+{
+	return a.hashes[i] == b.hashes[j] && a.Line(i) == b.Line(j);
+}
+
+}
+
+
+/**
+ * Lines common to the start and end of both texts are skipped first, so the
+ * cost depends on the size of the changed region rather than of the texts.
+ * The search keeps its frontier for every edit count to walk back along the
+ * shortest path, which takes memory quadratic in maxEdits.
+ */
+std::optional<std::vector<DiffHunk>>
+DiffLines(std::string_view oldText, std::string_view newText, size_t maxEdits)
+{
+	const Lines a(oldText);
+	const Lines b(newText);
+
+	size_t prefix = 0;
+	while(prefix < a.Count() && prefix < b.Count() && Equal(a, prefix, b, prefix))
+		prefix++;
+	size_t suffix = 0;
+	while(suffix < a.Count() - prefix && suffix < b.Count() - prefix
+			&& Equal(a, a.Count() - 1 - suffix, b, b.Count() - 1 - suffix))
+		suffix++;
+
+	const int64_t n = a.Count() - prefix - suffix;
+	const int64_t m = b.Count() - prefix - suffix;
+	const int64_t maxD = std::min<int64_t>(n + m, maxEdits);
+
+	// v[k] is the furthest x reached on diagonal k = x - y
+	const int64_t offset = maxD + 1;
+	std::vector<int64_t> v(2 * offset + 1, 0);
+	std::vector<std::vector<int64_t>> trace;
+	int64_t d = 0;
+	for(;; d++) {
+		if(d > maxD)
+			return std::nullopt;
+		trace.emplace_back(v.begin() + offset - d - 1, v.begin() + offset + d + 2);
+		bool done = false;
+		for(int64_t k = -d; k <= d; k += 2) {
+			int64_t x = (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1]))
+				? v[offset + k + 1] : v[offset + k - 1] + 1;
+			int64_t y = x - k;
+			while(x < n && y < m && Equal(a, prefix + x, b, prefix + y))
+				x++, y++;
+			v[offset + k] = x;
+			if(x >= n && y >= m) {
+				done = true;
+				break;
+			}
+		}
+		if(done)
+			break;
+	}
+
+	// walk back collecting matched lines, then turn the gaps into hunks
+	std::vector<std::pair<int64_t, int64_t>> matches;
+	int64_t x = n, y = m;
+	for(; d >= 0; d--) {
+		const std::vector<int64_t>& previous = trace[d];
+		const auto at = [&](int64_t k) { return previous[k + d + 1]; };
+		const int64_t k = x - y;
+		const int64_t previousK = (k == -d || (k != d && at(k - 1) < at(k + 1)))
+			? k + 1 : k - 1;
+		const int64_t previousX = d == 0 ? 0 : at(previousK);
+		const int64_t previousY = previousX - previousK;
+		while(x > previousX && y > previousY) {
+			x--, y--;
+			matches.emplace_back(x, y);
+		}
+		x = previousX;
+		y = previousY;
+	}
+	std::reverse(matches.begin(), matches.end());
+	matches.emplace_back(n, m);
+
+	std::vector<DiffHunk> hunks;
+	int64_t nextX = 0, nextY = 0;
+	for(const auto& [matchX, matchY] : matches) {
+		if(matchX > nextX || matchY > nextY) {
+			const size_t oldStart = a.offsets[prefix + nextX];
+			const size_t newStart = b.offsets[prefix + nextY];
+			hunks.push_back({ oldStart, a.offsets[prefix + matchX] - oldStart,
+				newStart, b.offsets[prefix + matchY] - newStart });
+		}
+		nextX = matchX + 1;
+		nextY = matchY + 1;
+	}
+	return hunks;
+}
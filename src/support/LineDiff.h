@@ -0,0 +1,41 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#ifndef LINEDIFF_H
+#define LINEDIFF_H
+
+
+#include <cstddef>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+
+/**
+ * A range of bytes in the old text, replaced by a range of bytes in the new
+ * text. Hunks always cover whole lines.
+ */
+struct DiffHunk {
+	size_t	oldOffset;
+	size_t	oldLength;
+	size_t	newOffset;
+	size_t	newLength;
+
+	bool	operator==(const DiffHunk& other) const = default;
+};
+
+
+/**
+ * Finds the smallest set of lines to delete from and insert into oldText to
+ * turn it into newText, using Myers' algorithm on line hashes. Hunks are
+ * sorted and don't overlap. Returns nothing if more than maxEdits lines
+ * differ, in which case replacing the whole text is the cheaper option.
+ */
+std::optional<std::vector<DiffHunk>>
+	DiffLines(std::string_view oldText, std::string_view newText,
+		size_t maxEdits = 1024);
+
+
+#endif // LINEDIFF_H
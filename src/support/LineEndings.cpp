@@ -0,0 +1,80 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include "LineEndings.h"
+
+#include <bit>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+LineEndingCounter::LineEndingCounter()
+	:
+	fLF(0),
+	fCR(0),
+	fCRLF(0),
+	fPendingCR(false)
+{
+}
+
+
+void
+LineEndingCounter::Update(std::string_view data)
+{
+	// every LF and CR is counted, and CRLF is an LF right after a CR
+	const char* bytes = data.data();
+	const size_t size = data.size();
+	size_t i = 0;
+#if defined(__SSE2__)
+	const __m128i lf = _mm_set1_epi8('\n');
+	const __m128i cr = _mm_set1_epi8('\r');
+	for(; i + 16 <= size; i += 16) {
+		const __m128i block = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(bytes + i));
+		const uint32_t lfMask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, lf));
+		const uint32_t crMask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, cr));
+		if((lfMask | crMask) == 0) {
+			fPendingCR = false;
+			continue;
+		}
+		fLF += std::popcount(lfMask);
+		fCR += std::popcount(crMask);
+		fCRLF += std::popcount(((crMask << 1) | fPendingCR) & lfMask);
+		fPendingCR = (crMask >> 15) & 1;
+	}
+#endif
+	for(; i < size; i++) {
+		const char c = bytes[i];
+		if(c == '\n') {
+			fLF++;
+			fCRLF += fPendingCR;
+		} else if(c == '\r')
+			fCR++;
+		fPendingCR = c == '\r';
+	}
+}
+
+
+LineEndingCounter::Style
+LineEndingCounter::Dominant() const
+{
+	if(fLF == 0 && fCR == 0)
+		return NONE;
+	if(CountCRLF() > CountLF() && CountCRLF() >= CountCR())
+		return CRLF;
+	if(CountCR() > CountLF())
+		return CR;
+	return LF;
+}
+
+
+bool
+LineEndingCounter::Mixed() const
+{
+	return (CountLF() > 0) + (CountCRLF() > 0) + (CountCR() > 0) > 1;
+}
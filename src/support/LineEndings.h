@@ -0,0 +1,48 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#ifndef LINEENDINGS_H
+#define LINEENDINGS_H
+
+
+#include <cstdint>
+#include <string_view>
+
+
+/**
+ * LineEndingCounter counts LF, CRLF and CR line endings in text fed to it in
+ * arbitrary pieces; a CRLF split between two pieces is counted once.
+ * It compares 16 bytes at a time (SSE2) and only counts bits, so it runs at
+ * about the speed of memchr().
+ */
+class LineEndingCounter {
+public:
+	enum Style {
+		NONE,
+		LF,
+		CRLF,
+		CR
+	};
+
+	LineEndingCounter();
+
+	void		Update(std::string_view data);
+
+	uint64_t	CountLF() const { return fLF - fCRLF; }
+	uint64_t	CountCRLF() const { return fCRLF; }
+	uint64_t	CountCR() const { return fCR - fCRLF; }
+
+	Style		Dominant() const;
+	bool		Mixed() const;
+
+private:
+	uint64_t	fLF;
+	uint64_t	fCR;
+	uint64_t	fCRLF;
+	bool		fPendingCR;
+};
+
+
+#endif // LINEENDINGS_H
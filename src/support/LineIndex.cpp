@@ -0,0 +1,51 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include "LineIndex.h"
+
+#include <algorithm>
+#include <cstring>
+
+
+LineIndex::LineIndex(uint64_t stride)
+	:
+	fStride(std::max<uint64_t>(stride, 1)),
+	fSize(0),
+	fNewlines(0),
+	fOffsets{ 0 }
+{
+}
+
+
+void
+LineIndex::Update(std::string_view data)
+{
+	const char* start = data.data();
+	const char* end = start + data.size();
+	const char* newline;
+	// memchr skips over long lines much faster than a loop over bytes
+	while(start < end
+			&& (newline = static_cast<const char*>(
+				memchr(start, '\n', end - start))) != nullptr) {
+		fNewlines++;
+		if(fNewlines % fStride == 0)
+			fOffsets.push_back(fSize + (newline - data.data()) + 1);
+		start = newline + 1;
+	}
+	fSize += data.size();
+}
+
+
+/**
+ * Returns the recorded line closest to line, but not after it. Lines past
+ * the ones seen so far are treated as the last line.
+ */
+LinePosition
+LineIndex::Locate(uint64_t line) const
+{
+	const uint64_t index = std::min<uint64_t>(line / fStride, fOffsets.size() - 1);
+	return { index * fStride, fOffsets[index] };
+}
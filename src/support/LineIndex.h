@@ -0,0 +1,55 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#ifndef LINEINDEX_H
+#define LINEINDEX_H
+
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+
+/**
+ * Start of a line: its number, counted from 0, and its byte offset.
+ */
+struct LinePosition {
+	uint64_t	line;
+	uint64_t	offset;
+
+	bool		operator==(const LinePosition& other) const = default;
+};
+
+
+/**
+ * LineIndex records where every stride-th line starts, so that any line of
+ * a text too big to keep in memory can be found by reading at most stride
+ * lines from the nearest recorded one. The text is given in consecutive
+ * pieces with Update().
+ */
+class LineIndex {
+public:
+	static const uint64_t	kDefaultStride = 1024;
+
+							LineIndex(uint64_t stride = kDefaultStride);
+
+	void					Update(std::string_view data);
+
+	// bytes given so far
+	uint64_t				Size() const { return fSize; }
+	// lines started so far, the last one may still continue
+	uint64_t				LineCount() const { return fNewlines + 1; }
+	LinePosition			Locate(uint64_t line) const;
+
+private:
+	uint64_t				fStride;
+	uint64_t				fSize;
+	uint64_t				fNewlines;
+	// offset of line i * fStride
+	std::vector<uint64_t>	fOffsets;
+};
+
+
+#endif // LINEINDEX_H
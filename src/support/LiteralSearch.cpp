@@ -0,0 +1,154 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include "LiteralSearch.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+
+namespace {
+
+const std::array<unsigned char, 256> kLowerTable = [] {
+	std::array<unsigned char, 256> table;
+	for(int c = 0; c < 256; c++)
+		table[c] = (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+	return table;
+}();
+
+
+unsigned char
+Other(unsigned char c)
+{
+	return (c >= 'a' && c <= 'z') ? c - ('a' - 'A') : c;
+}
+
+}
+
+
+LiteralSearch::LiteralSearch(std::string_view needle, bool ignoreCase)
+	:
+	fNeedle(needle),
+	fIgnoreCase(ignoreCase)
+{
+	if(fIgnoreCase == true) {
+		for(char& c : fNeedle)
+			c = kLowerTable[static_cast<unsigned char>(c)];
+	}
+}
+
+
+size_t
+LiteralSearch::Find(std::string_view text, size_t start, size_t end) const
+{
+	end = std::min(end, text.size());
+	const size_t length = fNeedle.size();
+	if(length == 0 || start > end || end - start < length)
+		return npos;
+	// last position a match can start at, plus one
+	const size_t limit = end - length + 1;
+	const char* data = text.data();
+	const unsigned char first = fNeedle.front();
+	const unsigned char last = fNeedle.back();
+	const unsigned char otherFirst = fIgnoreCase ? Other(first) : first;
+	const unsigned char otherLast = fIgnoreCase ? Other(last) : last;
+
+	size_t i = start;
+#ifdef __SSE2__
+	const __m128i firsts = _mm_set1_epi8(first);
+	const __m128i otherFirsts = _mm_set1_epi8(otherFirst);
+	const __m128i lasts = _mm_set1_epi8(last);
+	const __m128i otherLasts = _mm_set1_epi8(otherLast);
+	for(; i + 16 <= limit; i += 16) {
+		const __m128i blockFirst = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(data + i));
+		const __m128i blockLast = _mm_loadu_si128(
+			reinterpret_cast<const __m128i*>(data + i + length - 1));
+		const __m128i matches = _mm_and_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(blockFirst, firsts),
+				_mm_cmpeq_epi8(blockFirst, otherFirsts)),
+			_mm_or_si128(_mm_cmpeq_epi8(blockLast, lasts),
+				_mm_cmpeq_epi8(blockLast, otherLasts)));
+		unsigned int mask = _mm_movemask_epi8(matches);
+		while(mask != 0) {
+			const size_t candidate = i + __builtin_ctz(mask);
+			if(_Equals(data + candidate))
+				return candidate;
+			mask &= mask - 1;
+		}
+	}
+#endif
+	if(first == otherFirst) {
+		// memchr is vectorized by the C library
+		while(i < limit) {
+			const void* found = memchr(data + i, first, limit - i);
+			if(found == nullptr)
+				return npos;
+			i = static_cast<const char*>(found) - data;
+			if(static_cast<unsigned char>(data[i + length - 1]) == last
+					|| static_cast<unsigned char>(data[i + length - 1]) == otherLast) {
+				if(_Equals(data + i))
+					return i;
+			}
+			i++;
+		}
+		return npos;
+	}
+	for(; i < limit; i++) {
+		if(kLowerTable[static_cast<unsigned char>(data[i])] == first
+				&& _Equals(data + i))
+			return i;
+	}
+	return npos;
+}
+
+
+size_t
+LiteralSearch::FindBackward(std::string_view text, size_t start,
+	size_t end) const
+{
+	end = std::min(end, text.size());
+	const size_t length = fNeedle.size();
+	if(length == 0 || start > end || end - start < length)
+		return npos;
+	// forwards in blocks from the end, so that the fast scan can be used
+	const size_t kBlockSize = 64 * 1024;
+	size_t blockEnd = end;
+	while(true) {
+		const size_t blockStart = blockEnd - start > kBlockSize + length
+			? blockEnd - kBlockSize - length + 1 : start;
+		size_t found = npos;
+		size_t position = blockStart;
+		size_t match;
+		while((match = Find(text, position, blockEnd)) != npos) {
+			found = match;
+			position = match + 1;
+		}
+		if(found != npos || blockStart == start)
+			return found;
+		// matches starting before blockStart end before blockStart + length
+		blockEnd = blockStart + length - 1;
+	}
+}
+
+
+bool
+LiteralSearch::_Equals(const char* candidate) const
+{
+	if(fIgnoreCase == false)
+		return memcmp(candidate, fNeedle.data(), fNeedle.size()) == 0;
+	for(size_t i = 0; i < fNeedle.size(); i++) {
+		if(kLowerTable[static_cast<unsigned char>(candidate[i])]
+				!= static_cast<unsigned char>(fNeedle[i]))
+			return false;
+	}
+	return true;
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#ifndef LITERALSEARCH_H
+#define LITERALSEARCH_H
+
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+
+/**
+ * LiteralSearch finds a fixed string in text. Candidates are picked by
+ * comparing the first and the last byte of the needle with 16 positions at
+ * once, which skips most of the text without looking at it byte by byte.
+ * Ignoring case folds ASCII letters only, other bytes must be equal.
+ */
+class LiteralSearch {
+public:
+	static constexpr size_t	npos = std::string_view::npos;
+
+						LiteralSearch(std::string_view needle,
+							bool ignoreCase = false);
+
+	// start of the first match which lies between start and end, or npos
+	size_t				Find(std::string_view text, size_t start,
+							size_t end) const;
+	// start of the last match which lies between start and end, or npos
+	size_t				FindBackward(std::string_view text, size_t start,
+							size_t end) const;
+
+	size_t				Length() const { return fNeedle.size(); }
+
+private:
+	bool				_Equals(const char* candidate) const;
+
+	// folded to lower case if ignoring case
+	std::string			fNeedle;
+	bool				fIgnoreCase;
+};
+
+
+#endif // LITERALSEARCH_H
@@ -0,0 +1,429 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include "LocalHistory.h"
+
+#include <Autolock.h>
+#include <Directory.h>
+#include <Entry.h>
+#include <File.h>
+#include <Locker.h>
+
+#include <cstring>
+#include <ctime>
+#include <unordered_set>
+
+#include "Chunker.h"
+#include "File.h"
+
+
+namespace {
+
+const uint32 kIndexMagic = 'KLHI';
+const uint32 kIndexVersion = 1;
+// keep this many revisions per file, trimming down to kPrunedRevisions
+// at once so that garbage collection runs only every few saves
+const size_t kMaxRevisions = 50;
+const size_t kPrunedRevisions = 40;
+
+// serializes access of all windows to the store, so that garbage
+// collection cannot remove a chunk another window has just stored
+BLocker sLock("local history");
+
+
+template<typename T>
+void
+Append(std::string& buffer, T value)
+{
+	buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+
+template<typename T>
+bool
+Read(BFile& file, T& value)
+{
+	return file.Read(&value, sizeof(value)) == static_cast<ssize_t>(sizeof(value));
+}
+
+
+bool
+ReadHash(BFile& file, Hash128& hash)
+{
+	return Read(file, hash.high) && Read(file, hash.low);
+}
+
+
+status_t
+ReadIndexFile(const char* indexPath, std::string& path,
+	std::vector<LocalHistory::Revision>* revisions,
+	std::vector<std::vector<Hash128>>* chunks)
+{
+	BFile file(indexPath, B_READ_ONLY);
+	status_t status = file.InitCheck();
+	if(status != B_OK)
+		return status;
+
+	uint32 magic, version, pathLength;
+	if(!Read(file, magic) || !Read(file, version) || !Read(file, pathLength)
+			|| magic != kIndexMagic || version != kIndexVersion)
+		return B_BAD_DATA;
+	path.resize(pathLength);
+	if(file.Read(path.data(), pathLength) != static_cast<ssize_t>(pathLength))
+		return B_BAD_DATA;
+
+	// a truncated last entry (e.g. after a crash) is ignored
+	for(int32 index = 0; ; index++) {
+		LocalHistory::Revision revision;
+		int64 time;
+		uint32 chunkCount;
+		if(!Read(file, time) || !Read(file, revision.size)
+				|| !ReadHash(file, revision.hash) || !Read(file, chunkCount))
+			break;
+		revision.index = index;
+		revision.time = time;
+		if(chunks != nullptr) {
+			std::vector<Hash128> list(chunkCount);
+			bool complete = true;
+			for(auto& hash : list)
+				complete = complete && ReadHash(file, hash);
+			if(!complete)
+				break;
+			chunks->push_back(std::move(list));
+		} else {
+			off_t position = file.Position() + chunkCount * 2 * sizeof(uint64);
+			off_t size;
+			if(file.GetSize(&size) != B_OK || position > size)
+				break;
+			file.Seek(position, SEEK_SET);
+		}
+		if(revisions != nullptr)
+			revisions->push_back(revision);
+	}
+	return B_OK;
+}
+
+
+std::string
+SerializeHeader(const char* path)
+{
+	std::string buffer;
+	Append(buffer, kIndexMagic);
+	Append(buffer, kIndexVersion);
+	Append(buffer, static_cast<uint32>(strlen(path)));
+	buffer.append(path);
+	return buffer;
+}
+
+
+void
+SerializeEntry(std::string& buffer, const LocalHistory::Revision& revision,
+	const std::vector<Hash128>& chunks)
+{
+	Append(buffer, static_cast<int64>(revision.time));
+	Append(buffer, revision.size);
+	Append(buffer, revision.hash.high);
+	Append(buffer, revision.hash.low);
+	Append(buffer, static_cast<uint32>(chunks.size()));
+	for(const auto& hash : chunks) {
+		Append(buffer, hash.high);
+		Append(buffer, hash.low);
+	}
+}
+
+}
+
+
+LocalHistory::LocalHistory(const BPath& directory)
+	:
+	fDirectory(directory)
+{
+}
+
+
+/**
+ * Stores contents (given in pieces, e.g. both halves of Scintilla's gap
+ * buffer) as a new revision of path, unless they match the latest one.
+ */
+status_t
+LocalHistory::Record(const char* path,
+	std::span<const std::string_view> contents)
+{
+	BAutolock lock(sLock);
+
+	Entry entry;
+	entry.revision.time = time(nullptr);
+	entry.revision.size = 0;
+	Hasher hasher;
+	for(const auto& part : contents) {
+		hasher.Update(part);
+		entry.revision.size += part.size();
+	}
+	entry.revision.hash = hasher.Final();
+
+	std::vector<Entry> entries;
+	if(_ReadIndex(path, entries, false) == B_OK && !entries.empty()
+			&& entries.back().revision.hash == entry.revision.hash)
+		return B_OK;
+
+	status_t status = B_OK;
+	auto store = [&](std::string_view chunk) {
+		if(status != B_OK)
+			return;
+		Hash128 hash;
+		status = _StoreChunk(chunk, hash);
+		entry.chunks.push_back(hash);
+	};
+	Chunker chunker;
+	for(const auto& part : contents)
+		chunker.Update(part, store);
+	chunker.Finish(store);
+	if(status != B_OK)
+		return status;
+
+	if((status = _AppendEntry(path, entry)) != B_OK)
+		return status;
+	if(entries.size() + 1 > kMaxRevisions)
+		_Prune(path);
+	return B_OK;
+}
+
+
+/**
+ * Lists revisions of path, oldest first.
+ */
+std::vector<LocalHistory::Revision>
+LocalHistory::Revisions(const char* path)
+{
+	BAutolock lock(sLock);
+
+	std::vector<Entry> entries;
+	_ReadIndex(path, entries, false);
+	std::vector<Revision> revisions;
+	for(const auto& entry : entries)
+		revisions.push_back(entry.revision);
+	return revisions;
+}
+
+
+status_t
+LocalHistory::Restore(const char* path, int32 index, std::string& contents)
+{
+	BAutolock lock(sLock);
+
+	std::vector<Entry> entries;
+	status_t status = _ReadIndex(path, entries, true);
+	if(status != B_OK)
+		return status;
+	if(index < 0 || index >= static_cast<int32>(entries.size()))
+		return B_BAD_INDEX;
+
+	const Entry& entry = entries[index];
+	contents.clear();
+	contents.reserve(entry.revision.size);
+	for(const auto& hash : entry.chunks) {
+		BFile object(_ObjectPath(hash).c_str(), B_READ_ONLY);
+		off_t size;
+		if((status = object.InitCheck()) != B_OK
+				|| (status = object.GetSize(&size)) != B_OK)
+			return status;
+		size_t offset = contents.size();
+		contents.resize(offset + size);
+		if(object.Read(contents.data() + offset, size) != size)
+			return B_IO_ERROR;
+	}
+	if(HashData(contents) != entry.revision.hash)
+		return B_BAD_DATA;
+	return B_OK;
+}
+
+
+std::string
+LocalHistory::_IndexPath(const char* path)
+{
+	BPath indexPath(fDirectory);
+	indexPath.Append("index");
+	indexPath.Append(HashData(path).ToString().c_str());
+	return indexPath.Path();
+}
+
+
+std::string
+LocalHistory::_ObjectPath(const Hash128& hash)
+{
+	const std::string name = hash.ToString();
+	BPath objectPath(fDirectory);
+	objectPath.Append("objects");
+	objectPath.Append(name.substr(0, 2).c_str());
+	objectPath.Append(name.substr(2).c_str());
+	return objectPath.Path();
+}
+
+
+status_t
+LocalHistory::_ReadIndex(const char* path, std::vector<Entry>& entries,
+	bool withChunks)
+{
+	std::string storedPath;
+	std::vector<Revision> revisions;
+	std::vector<std::vector<Hash128>> chunks;
+	status_t status = ReadIndexFile(_IndexPath(path).c_str(), storedPath,
+		&revisions, withChunks ? &chunks : nullptr);
+	if(status != B_OK)
+		return status;
+	// paths with colliding hashes do not share history
+	if(storedPath != path)
+		return B_ENTRY_NOT_FOUND;
+
+	for(size_t i = 0; i < revisions.size(); i++) {
+		Entry entry;
+		entry.revision = revisions[i];
+		if(withChunks)
+			entry.chunks = std::move(chunks[i]);
+		entries.push_back(std::move(entry));
+	}
+	return B_OK;
+}
+
+
+status_t
+LocalHistory::_WriteIndex(const char* path, const std::vector<Entry>& entries)
+{
+	std::string buffer = SerializeHeader(path);
+	for(const auto& entry : entries)
+		SerializeEntry(buffer, entry.revision, entry.chunks);
+
+	AtomicFile file(_IndexPath(path).c_str());
+	status_t status = file.InitCheck();
+	if(status != B_OK)
+		return status;
+	if((status = file.Write(buffer)) != B_OK)
+		return status;
+	return file.Commit();
+}
+
+
+status_t
+LocalHistory::_AppendEntry(const char* path, const Entry& entry)
+{
+	const std::string indexPath = _IndexPath(path);
+	BPath parent;
+	BPath(indexPath.c_str()).GetParent(&parent);
+	create_directory(parent.Path(), 0755);
+
+	std::string storedPath;
+	if(ReadIndexFile(indexPath.c_str(), storedPath, nullptr, nullptr) == B_OK
+			&& storedPath != path) {
+		// another path with the same hash took this index, start over
+		BEntry(indexPath.c_str()).Remove();
+	}
+
+	File file(indexPath.c_str(), B_WRITE_ONLY | B_CREATE_FILE | B_OPEN_AT_END);
+	status_t status = file.InitCheck();
+	if(status != B_OK)
+		return status;
+	off_t size;
+	if((status = file.GetSize(&size)) != B_OK)
+		return status;
+
+	std::string buffer;
+	if(size == 0)
+		buffer = SerializeHeader(path);
+	SerializeEntry(buffer, entry.revision, entry.chunks);
+	return file.Write(buffer);
+}
+
+
+status_t
+LocalHistory::_StoreChunk(std::string_view chunk, Hash128& hash)
+{
+	hash = HashData(chunk);
+	const std::string objectPath = _ObjectPath(hash);
+
+	BFile existing(objectPath.c_str(), B_READ_ONLY);
+	off_t size;
+	if(existing.InitCheck() == B_OK && existing.GetSize(&size) == B_OK
+			&& size == static_cast<off_t>(chunk.size()))
+		return B_OK;
+
+	BPath parent;
+	BPath(objectPath.c_str()).GetParent(&parent);
+	status_t status = create_directory(parent.Path(), 0755);
+	if(status != B_OK)
+		return status;
+	File file(objectPath.c_str(), B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
+	if((status = file.InitCheck()) != B_OK)
+		return status;
+	return file.Write(chunk);
+}
+
+
+void
+LocalHistory::_Prune(const char* path)
+{
+	std::vector<Entry> entries;
+	if(_ReadIndex(path, entries, true) != B_OK
+			|| entries.size() <= kMaxRevisions)
+		return;
+
+	entries.erase(entries.begin(), entries.end() - kPrunedRevisions);
+	if(_WriteIndex(path, entries) == B_OK)
+		_CollectGarbage();
+}
+
+
+/**
+ * Removes chunks which are not referenced by any index.
+ */
+void
+LocalHistory::_CollectGarbage()
+{
+	BPath indexPath(fDirectory);
+	indexPath.Append("index");
+	BDirectory indexDirectory(indexPath.Path());
+	if(indexDirectory.InitCheck() != B_OK)
+		return;
+
+	std::unordered_set<std::string> referenced;
+	BEntry entry;
+	while(indexDirectory.GetNextEntry(&entry) == B_OK) {
+		char name[B_FILE_NAME_LENGTH];
+		entry.GetName(name);
+		if(name[0] == '.') {
+			// leftover temporary file of an interrupted rewrite
+			continue;
+		}
+		BPath path;
+		entry.GetPath(&path);
+		std::string storedPath;
+		std::vector<std::vector<Hash128>> chunks;
+		if(ReadIndexFile(path.Path(), storedPath, nullptr, &chunks) != B_OK) {
+			// could be an index of a newer version, leave everything be
+			return;
+		}
+		for(const auto& list : chunks) {
+			for(const auto& hash : list)
+				referenced.insert(hash.ToString());
+		}
+	}
+
+	BPath objectsPath(fDirectory);
+	objectsPath.Append("objects");
+	BDirectory objectsDirectory(objectsPath.Path());
+	BEntry bucket;
+	while(objectsDirectory.GetNextEntry(&bucket) == B_OK) {
+		char bucketName[B_FILE_NAME_LENGTH];
+		bucket.GetName(bucketName);
+		BDirectory bucketDirectory(&bucket);
+		BEntry object;
+		while(bucketDirectory.GetNextEntry(&object) == B_OK) {
+			char objectName[B_FILE_NAME_LENGTH];
+			object.GetName(objectName);
+			if(referenced.count(std::string(bucketName) + objectName) == 0)
+				object.Remove();
+		}
+	}
+}
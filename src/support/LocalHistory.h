@@ -0,0 +1,70 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#ifndef LOCALHISTORY_H
+#define LOCALHISTORY_H
+
+
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <Path.h>
+#include <SupportDefs.h>
+
+#include "Hash.h"
+
+
+/**
+ * LocalHistory keeps saved revisions of files in a content-addressed store.
+ * Contents are split into content-defined chunks, each stored once under
+ * objects/ and named after its hash, so revisions of a large file which
+ * differ in a few places share almost all of their data.
+ * Every file has an index under index/, named after the hash of its path,
+ * holding a small header per revision followed by its list of chunks.
+ * Listing revisions only reads the headers.
+ */
+class LocalHistory {
+public:
+	struct Revision {
+		int32		index;
+		time_t		time;
+		uint64		size;
+		Hash128		hash;
+	};
+
+	LocalHistory(const BPath& directory);
+
+	status_t				Record(const char* path,
+								std::span<const std::string_view> contents);
+	std::vector<Revision>	Revisions(const char* path);
+	status_t				Restore(const char* path, int32 index,
+								std::string& contents);
+
+private:
+	struct Entry {
+		Revision				revision;
+		std::vector<Hash128>	chunks;
+	};
+
+	std::string				_IndexPath(const char* path);
+	std::string				_ObjectPath(const Hash128& hash);
+	status_t				_ReadIndex(const char* path,
+								std::vector<Entry>& entries,
+								bool withChunks);
+	status_t				_WriteIndex(const char* path,
+								const std::vector<Entry>& entries);
+	status_t				_AppendEntry(const char* path, const Entry& entry);
+	status_t				_StoreChunk(std::string_view chunk,
+								Hash128& hash);
+	void					_Prune(const char* path);
+	void					_CollectGarbage();
+
+	BPath					fDirectory;
+};
+
+
+#endif // LOCALHISTORY_H
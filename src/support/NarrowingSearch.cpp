@@ -0,0 +1,130 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include "NarrowingSearch.h"
+
+#include <algorithm>
+
+#include "TextSearch.h"
+
+
+NarrowingSearch::NarrowingSearch(size_t maxCandidates, size_t collectDistance)
+	:
+	fMaxCandidates(maxCandidates),
+	fCollectDistance(collectDistance)
+{
+}
+
+
+/**
+ * Finds term in text, at from or after it, or before it if there is nothing
+ * after.
+ */
+bool
+NarrowingSearch::Find(std::string_view text, std::string_view term,
+	size_t from, size_t& matchStart, size_t& matchEnd)
+{
+	// drop the terms which term doesn't extend, as after a backspace
+	while(!fLevels.empty() && !term.starts_with(fLevels.back().term))
+		fLevels.pop_back();
+	if(term.empty())
+		return false;
+
+	const TextSearch search(term, false, false, false);
+	if(!fLevels.empty() && fLevels.back().term != term
+			&& fLevels.back().complete == true) {
+		Level level{ std::string(term), true, {} };
+		_Narrow(text, search, level);
+		fLevels.push_back(std::move(level));
+	}
+
+	if(!fLevels.empty() && fLevels.back().term == term) {
+		const Level& level = fLevels.back();
+		if(level.complete == true) {
+			if(level.candidates.empty())
+				return false;
+			auto it = std::lower_bound(level.candidates.begin(),
+				level.candidates.end(), from);
+			if(it == level.candidates.end())
+				it = level.candidates.begin();
+			// the occurrence at it is the first one from there
+			return search.Find(text, *it, text.size(), matchStart, matchEnd);
+		}
+		fLevels.pop_back();
+	}
+
+	Level level{ std::string(term), false, {} };
+	const bool found
+		= search.Find(text, from, text.size(), matchStart, matchEnd)
+		|| search.Find(text, 0, text.size(), matchStart, matchEnd);
+	if(found == false) {
+		// there are none
+		level.complete = true;
+	} else {
+		const size_t searched = matchStart >= from ? matchStart - from
+			: text.size() - from + matchStart;
+		if(searched >= fCollectDistance)
+			_Collect(text, search, level);
+	}
+	fLevels.push_back(std::move(level));
+	return found;
+}
+
+
+ssize_t
+NarrowingSearch::CountCandidates() const
+{
+	if(fLevels.empty() || fLevels.back().complete == false)
+		return -1;
+	return fLevels.back().candidates.size();
+}
+
+
+/**
+ * Keeps the occurrences of the previous term which are also ones of the
+ * term of level.
+ */
+void
+NarrowingSearch::_Narrow(std::string_view text, const TextSearch& search,
+	Level& level) const
+{
+	// a character folds to at most 4 bytes
+	const size_t longest = level.term.size() * 4;
+	size_t matchStart, matchEnd;
+	for(size_t candidate : fLevels.back().candidates) {
+		if(search.Find(text, candidate,
+				std::min(text.size(), candidate + longest),
+				matchStart, matchEnd) == true
+				&& matchStart == candidate)
+			level.candidates.push_back(candidate);
+	}
+}
+
+
+/**
+ * Finds every occurrence of the term of level, unless there are too many.
+ */
+void
+NarrowingSearch::_Collect(std::string_view text, const TextSearch& search,
+	Level& level) const
+{
+	level.complete = true;
+	size_t position = 0;
+	size_t matchStart, matchEnd;
+	while(search.Find(text, position, text.size(), matchStart,
+			matchEnd) == true) {
+		if(level.candidates.size() == fMaxCandidates) {
+			level.complete = false;
+			level.candidates = std::vector<size_t>();
+			return;
+		}
+		level.candidates.push_back(matchStart);
+		// occurrences can overlap
+		position = matchStart + 1;
+		while(position < text.size() && (text[position] & 0xC0) == 0x80)
+			position++;
+	}
+}
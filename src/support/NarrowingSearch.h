@@ -0,0 +1,68 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#ifndef NARROWINGSEARCH_H
+#define NARROWINGSEARCH_H
+
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <sys/types.h>
+
+
+class TextSearch;
+
+
+/**
+ * NarrowingSearch finds a term which is typed a character at a time, ignoring
+ * case. Every occurrence of a longer term is also one of the term it extends,
+ * so once the occurrences of a term are known, only those are checked for the
+ * terms typed after it. They are kept for each term typed so far, going back
+ * to a shorter term reuses them without searching at all.
+ * Finding the next occurrence the usual way is quick while they are common,
+ * so they are only all collected when it had to look far, or when there are
+ * none at all, which also settles every longer term. When there are too many
+ * to keep, the text is searched the usual way.
+ */
+class NarrowingSearch {
+public:
+	static constexpr size_t	kDefaultMaxCandidates = 1 << 20;
+	static constexpr size_t	kDefaultCollectDistance = 1 << 20;
+
+						NarrowingSearch(
+							size_t maxCandidates = kDefaultMaxCandidates,
+							size_t collectDistance = kDefaultCollectDistance);
+
+	// forgets the occurrences, the text has changed
+	void				Reset() { fLevels.clear(); }
+
+	bool				Find(std::string_view text, std::string_view term,
+							size_t from, size_t& matchStart, size_t& matchEnd);
+	// occurrences kept for the last term, or -1 if they are not known
+	ssize_t				CountCandidates() const;
+
+private:
+	struct Level {
+		std::string			term;
+		bool				complete;
+		std::vector<size_t>	candidates;
+	};
+
+	void				_Narrow(std::string_view text, const TextSearch& search,
+							Level& level) const;
+	void				_Collect(std::string_view text,
+							const TextSearch& search, Level& level) const;
+
+	std::vector<Level>	fLevels;
+	size_t				fMaxCandidates;
+	// searched by the usual way before all occurrences are collected
+	size_t				fCollectDistance;
+};
+
+
+#endif // NARROWINGSEARCH_H
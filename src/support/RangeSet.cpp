@@ -0,0 +1,61 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include "RangeSet.h"
+
+#include <algorithm>
+
+
+void
+RangeSet::Add(int64_t start, int64_t end)
+{
+	if(end <= start)
+		return;
+	// the first range which could touch the new one
+	auto it = fRanges.upper_bound(start);
+	if(it != fRanges.begin() && std::prev(it)->second >= start)
+		it = std::prev(it);
+	while(it != fRanges.end() && it->first <= end) {
+		start = std::min(start, it->first);
+		end = std::max(end, it->second);
+		it = fRanges.erase(it);
+	}
+	fRanges.emplace(start, end);
+}
+
+
+bool
+RangeSet::Contains(int64_t start, int64_t end) const
+{
+	if(end <= start)
+		return true;
+	auto it = fRanges.upper_bound(start);
+	if(it == fRanges.begin())
+		return false;
+	return std::prev(it)->second >= end;
+}
+
+
+std::vector<RangeSet::Range>
+RangeSet::Gaps(int64_t start, int64_t end) const
+{
+	std::vector<Range> gaps;
+	auto it = fRanges.upper_bound(start);
+	if(it != fRanges.begin())
+		it = std::prev(it);
+	for(; it != fRanges.end() && start < end; it++) {
+		if(it->second <= start)
+			continue;
+		if(it->first >= end)
+			break;
+		if(it->first > start)
+			gaps.emplace_back(start, it->first);
+		start = it->second;
+	}
+	if(start < end)
+		gaps.emplace_back(start, end);
+	return gaps;
+}
@@ -0,0 +1,38 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#ifndef RANGESET_H
+#define RANGESET_H
+
+
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+
+/**
+ * RangeSet holds half-open ranges of positions, merging the ones which touch
+ * or overlap, and tells which parts of a range are not in it yet.
+ */
+class RangeSet {
+public:
+	typedef std::pair<int64_t, int64_t> Range;
+
+	void				Clear() { fRanges.clear(); }
+	bool				IsEmpty() const { return fRanges.empty(); }
+
+	void				Add(int64_t start, int64_t end);
+	bool				Contains(int64_t start, int64_t end) const;
+	// parts of start to end which are not in the set, in order
+	std::vector<Range>	Gaps(int64_t start, int64_t end) const;
+
+private:
+	// start to end
+	std::map<int64_t, int64_t>	fRanges;
+};
+
+
+#endif // RANGESET_H
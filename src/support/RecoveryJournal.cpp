@@ -0,0 +1,386 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include "RecoveryJournal.h"
+
+#include <Directory.h>
+#include <Entry.h>
+#include <OS.h>
+#include <String.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <utility>
+
+#include "File.h"
+
+
+namespace {
+
+const uint32 kJournalMagic = 'KRCJ';
+const uint32 kJournalVersion = 1;
+// changes smaller than this are never compacted, rewriting the document
+// would cost more than keeping them
+const uint64 kMinCompactionSize = 1024 * 1024;
+
+int32 sSerial = 0;
+
+
+template<typename T>
+void
+Append(std::string& buffer, T value)
+{
+	buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+
+template<typename T>
+bool
+Read(BFile& file, T& value)
+{
+	return file.Read(&value, sizeof(value)) == static_cast<ssize_t>(sizeof(value));
+}
+
+
+std::string
+SerializeChange(RecoveryJournal::Operation operation, uint64 position,
+	uint64 length)
+{
+	std::string buffer;
+	Append(buffer, static_cast<uint8>(operation));
+	Append(buffer, position);
+	Append(buffer, length);
+	return buffer;
+}
+
+
+status_t
+ReadHeader(BFile& file, RecoveryJournal::Info& info)
+{
+	status_t status = file.InitCheck();
+	if(status != B_OK)
+		return status;
+
+	uint32 magic, version, pathLength;
+	uint8 fileBase;
+	if(!Read(file, magic) || !Read(file, version) || !Read(file, pathLength)
+			|| magic != kJournalMagic || version != kJournalVersion
+			|| pathLength > B_PATH_NAME_LENGTH)
+		return B_BAD_DATA;
+	info.path.resize(pathLength);
+	if(file.Read(info.path.data(), pathLength) != static_cast<ssize_t>(pathLength))
+		return B_BAD_DATA;
+	if(!Read(file, fileBase) || !Read(file, info.size)
+			|| !Read(file, info.modificationTime))
+		return B_BAD_DATA;
+	info.fileBase = fileBase != 0;
+	return B_OK;
+}
+
+}
+
+
+RecoveryJournal::RecoveryJournal(const BPath& directory)
+	:
+	fDirectory(directory),
+	fBaseSize(-1),
+	fBaseTime(-1),
+	fChangesSize(0),
+	fStarted(false),
+	fFailed(false),
+	fDirty(false)
+{
+	// the team lets the next launch tell journals of running instances apart
+	BString name;
+	name.SetToFormat("%" B_PRId32 "-%" B_PRId32, static_cast<int32>(getpid()),
+		atomic_add(&sSerial, 1));
+	BPath path(directory);
+	path.Append(name.String());
+	fPath = path.Path();
+}
+
+
+RecoveryJournal::~RecoveryJournal()
+{
+	Stop();
+}
+
+
+/**
+ * Starts journaling a document which is now identical to the file at path,
+ * or empty if the file does not exist (size < 0) or path is nullptr.
+ * Any previous journal is removed.
+ */
+void
+RecoveryJournal::Start(const char* path, off_t size, time_t modificationTime)
+{
+	Stop();
+	fDocumentPath = path != nullptr ? path : "";
+	fBaseSize = size;
+	fBaseTime = modificationTime;
+	fStarted = true;
+}
+
+
+/**
+ * Removes the journal and ignores changes until Start() is called again.
+ */
+void
+RecoveryJournal::Stop()
+{
+	if(fFile.InitCheck() == B_OK) {
+		fFile.Unset();
+		BEntry(fPath.c_str()).Remove();
+	}
+	fChangesSize = 0;
+	fStarted = false;
+	fFailed = false;
+	fDirty = false;
+}
+
+
+void
+RecoveryJournal::Inserted(uint64 position, const char* text, uint64 length)
+{
+	_Append(SerializeChange(INSERTION, position, length),
+		std::string_view(text, length));
+}
+
+
+void
+RecoveryJournal::Deleted(uint64 position, uint64 length)
+{
+	_Append(SerializeChange(DELETION, position, length));
+}
+
+
+/**
+ * Flushes changes written since the last call, so that they survive a crash
+ * of the whole system too.
+ */
+status_t
+RecoveryJournal::Sync()
+{
+	if(fDirty == false || fFile.InitCheck() != B_OK)
+		return B_OK;
+	fDirty = false;
+	return fFile.Sync();
+}
+
+
+/**
+ * Compaction costs writing the whole document, so it is worth it only once
+ * the changes have grown as large.
+ */
+bool
+RecoveryJournal::NeedsCompaction(uint64 documentSize) const
+{
+	return fFile.InitCheck() == B_OK && fFailed == false
+		&& fChangesSize >= std::max(kMinCompactionSize, documentSize);
+}
+
+
+/**
+ * Replaces the journal with a snapshot of contents, which must be the current
+ * text of the document.
+ */
+status_t
+RecoveryJournal::Compact(std::span<const std::string_view> contents)
+{
+	if(fStarted == false)
+		return B_NOT_ALLOWED;
+
+	create_directory(fDirectory.Path(), 0755);
+	AtomicFile file(fPath.c_str());
+	status_t status = file.InitCheck();
+	if(status != B_OK)
+		return status;
+
+	uint64 size = 0;
+	for(const auto& span : contents)
+		size += span.size();
+	if((status = file.Write(_Header(false))) != B_OK
+			|| (status = file.Write(SerializeChange(SNAPSHOT, 0, size))) != B_OK)
+		return status;
+	for(const auto& span : contents) {
+		if((status = file.Write(span)) != B_OK)
+			return status;
+	}
+	if((status = file.Commit()) != B_OK)
+		return status;
+
+	fFile.SetTo(fPath.c_str(), B_WRITE_ONLY | B_OPEN_AT_END);
+	fChangesSize = 0;
+	fFailed = false;
+	fDirty = false;
+	return fFile.InitCheck();
+}
+
+
+BPath
+RecoveryJournal::Directory(const BPath& settingsPath)
+{
+	BPath path(settingsPath);
+	path.Append("recovery");
+	return path;
+}
+
+
+/**
+ * Returns journals left behind by instances which are not running anymore,
+ * oldest first.
+ */
+std::vector<BPath>
+RecoveryJournal::Orphans(const BPath& directory)
+{
+	std::vector<std::pair<time_t, BPath>> journals;
+	BDirectory dir(directory.Path());
+	BEntry entry;
+	while(dir.GetNextEntry(&entry) == B_OK) {
+		char name[B_FILE_NAME_LENGTH];
+		int32 team, serial;
+		// hidden files are leftovers of an interrupted compaction
+		if(entry.GetName(name) != B_OK || name[0] == '.'
+				|| sscanf(name, "%" B_SCNd32 "-%" B_SCNd32, &team, &serial) != 2)
+			continue;
+		team_info info;
+		if(team == getpid() || get_team_info(team, &info) == B_OK)
+			continue;
+		time_t time = 0;
+		entry.GetModificationTime(&time);
+		journals.emplace_back(time, BPath(&entry));
+	}
+	std::sort(journals.begin(), journals.end(),
+		[](const auto& a, const auto& b) { return a.first < b.first; });
+
+	std::vector<BPath> paths;
+	for(auto& journal : journals)
+		paths.push_back(std::move(journal.second));
+	return paths;
+}
+
+
+status_t
+RecoveryJournal::ReadInfo(const char* journalPath, Info& info)
+{
+	BFile file(journalPath, B_READ_ONLY);
+	return ReadHeader(file, info);
+}
+
+
+/**
+ * Calls callback for every change in the journal, in order. A document with
+ * an empty base starts with an empty snapshot.
+ * A truncated last change (e.g. after a crash) is ignored.
+ */
+status_t
+RecoveryJournal::Replay(const char* journalPath, const Callback& callback)
+{
+	BFile file(journalPath, B_READ_ONLY);
+	Info info;
+	status_t status = ReadHeader(file, info);
+	if(status != B_OK)
+		return status;
+	off_t fileSize;
+	if((status = file.GetSize(&fileSize)) != B_OK)
+		return status;
+
+	// unless the journal was compacted into a snapshot
+	bool emptyBase = info.fileBase == false;
+	std::string text;
+	while(true) {
+		uint8 operation;
+		Change change;
+		if(!Read(file, operation) || !Read(file, change.position)
+				|| !Read(file, change.length))
+			break;
+		change.operation = static_cast<Operation>(operation);
+		if(change.operation == SNAPSHOT || change.operation == INSERTION) {
+			if(change.length > static_cast<uint64>(fileSize - file.Position()))
+				break;
+			text.resize(change.length);
+			if(file.Read(text.data(), change.length)
+					!= static_cast<ssize_t>(change.length))
+				break;
+			change.text = text;
+		} else if(change.operation != DELETION)
+			return B_BAD_DATA;
+		if(emptyBase == true && change.operation != SNAPSHOT)
+			callback(Change{ SNAPSHOT, 0, 0, std::string_view() });
+		emptyBase = false;
+		callback(change);
+	}
+	if(emptyBase == true)
+		callback(Change{ SNAPSHOT, 0, 0, std::string_view() });
+	return B_OK;
+}
+
+
+std::string
+RecoveryJournal::_Header(bool fileBase)
+{
+	std::string buffer;
+	Append(buffer, kJournalMagic);
+	Append(buffer, kJournalVersion);
+	Append(buffer, static_cast<uint32>(fDocumentPath.size()));
+	buffer.append(fDocumentPath);
+	Append(buffer, static_cast<uint8>(fileBase));
+	Append(buffer, fBaseSize);
+	Append(buffer, fBaseTime);
+	return buffer;
+}
+
+
+status_t
+RecoveryJournal::_Open()
+{
+	create_directory(fDirectory.Path(), 0755);
+	fFile.SetTo(fPath.c_str(), B_WRITE_ONLY | B_CREATE_FILE | B_ERASE_FILE);
+	status_t status = fFile.InitCheck();
+	if(status != B_OK)
+		return status;
+
+	const std::string header = _Header(!fDocumentPath.empty() && fBaseSize >= 0);
+	if(fFile.Write(header.data(), header.size())
+			!= static_cast<ssize_t>(header.size()))
+		return B_IO_ERROR;
+	return B_OK;
+}
+
+
+/**
+ * Appends a change. If writing fails, e.g. the disk is full, the journal stops
+ * recording until it is restarted, a gap would make the rest of it useless.
+ */
+void
+RecoveryJournal::_Append(const std::string& record, std::string_view text)
+{
+	if(fStarted == false || fFailed == true)
+		return;
+	if(fFile.InitCheck() != B_OK && _Open() != B_OK) {
+		_Fail();
+		return;
+	}
+
+	if(fFile.Write(record.data(), record.size()) != static_cast<ssize_t>(record.size())
+			|| fFile.Write(text.data(), text.size()) != static_cast<ssize_t>(text.size())) {
+		_Fail();
+		return;
+	}
+	fChangesSize += record.size() + text.size();
+	fDirty = true;
+}
+
+
+void
+RecoveryJournal::_Fail()
+{
+	fFile.Unset();
+	BEntry(fPath.c_str()).Remove();
+	fFailed = true;
+}
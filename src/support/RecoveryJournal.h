@@ -0,0 +1,93 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#ifndef RECOVERYJOURNAL_H
+#define RECOVERYJOURNAL_H
+
+
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <File.h>
+#include <Path.h>
+#include <SupportDefs.h>
+
+
+/**
+ * RecoveryJournal keeps unsaved changes of a document on disk, so that they
+ * survive a crash. A journal starts with the base of the document, either the
+ * file it was opened from or an empty text, followed by every insertion and
+ * deletion made since, appended as they happen. When the changes outgrow the
+ * document the journal is compacted into a snapshot of the whole text.
+ * The journal is created with the first change and removed when the document
+ * is saved or closed, so journals left in the directory belong to windows
+ * which did not close properly.
+ */
+class RecoveryJournal {
+public:
+	enum Operation {
+		SNAPSHOT	= 'S',
+		INSERTION	= 'I',
+		DELETION	= 'D'
+	};
+	struct Change {
+		Operation			operation;
+		uint64				position;
+		uint64				length;
+		std::string_view	text;
+	};
+	struct Info {
+		std::string			path;
+		bool				fileBase;
+		int64				size;
+		int64				modificationTime;
+	};
+	typedef std::function<void(const Change&)> Callback;
+
+	RecoveryJournal(const BPath& directory);
+	~RecoveryJournal();
+
+	void					Start(const char* path, off_t size,
+								time_t modificationTime);
+	void					Stop();
+	bool					IsStarted() const { return fStarted; }
+
+	void					Inserted(uint64 position, const char* text,
+								uint64 length);
+	void					Deleted(uint64 position, uint64 length);
+	status_t				Sync();
+	bool					NeedsCompaction(uint64 documentSize) const;
+	status_t				Compact(std::span<const std::string_view> contents);
+
+	static	BPath			Directory(const BPath& settingsPath);
+	static	std::vector<BPath>	Orphans(const BPath& directory);
+	static	status_t		ReadInfo(const char* journalPath, Info& info);
+	static	status_t		Replay(const char* journalPath,
+								const Callback& callback);
+
+private:
+	std::string				_Header(bool fileBase);
+	status_t				_Open();
+	void					_Append(const std::string& record,
+								std::string_view text = std::string_view());
+	void					_Fail();
+
+	BPath					fDirectory;
+	std::string				fPath;
+	BFile					fFile;
+	std::string				fDocumentPath;
+	int64					fBaseSize;
+	int64					fBaseTime;
+	uint64					fChangesSize;
+	bool					fStarted;
+	bool					fFailed;
+	bool					fDirty;
+};
+
+
+#endif // RECOVERYJOURNAL_H
@@ -0,0 +1,948 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include "Regex.h"
+
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <mutex>
+
+
+namespace {
+
+// repeats are unrolled, these keep patterns like (a{1000}){1000} in check
+const size_t kMaxProgramSize = 100000;
+const uint32_t kMaxRepeat = 1000;
+const int kMaxNesting = 256;
+const size_t kCacheSize = 32;
+
+enum Op : uint8_t {
+	CHAR,
+	ANY,
+	CLASS,
+	SPLIT,
+	JUMP,
+	SAVE,
+	ASSERT,
+	MATCH
+};
+
+enum Assertion : uint32_t {
+	LINE_START,
+	LINE_END,
+	WORD_BOUNDARY,
+	NOT_WORD_BOUNDARY
+};
+
+
+/**
+ * Simple case folding of the most common alphabets: ASCII, Latin-1, Latin
+ * Extended-A, Greek and Cyrillic.
+ */
+uint32_t
+Lower(uint32_t c)
+{
+	if((c >= 'A' && c <= 'Z') || (c >= 0xC0 && c <= 0xDE && c != 0xD7)
+			|| (c >= 0x391 && c <= 0x3AB && c != 0x3A2) || (c >= 0x410 && c <= 0x42F))
+		return c + 0x20;
+	if(c >= 0x400 && c <= 0x40F)
+		return c + 0x50;
+	// Latin Extended-A pairs upper and lower case letters
+	if(((c >= 0x100 && c <= 0x137 && c != 0x130) || (c >= 0x14A && c <= 0x177))
+			&& c % 2 == 0)
+		return c + 1;
+	if(((c >= 0x139 && c <= 0x148) || (c >= 0x179 && c <= 0x17E)) && c % 2 == 1)
+		return c + 1;
+	return c;
+}
+
+
+uint32_t
+Upper(uint32_t c)
+{
+	if((c >= 'a' && c <= 'z') || (c >= 0xE0 && c <= 0xFE && c != 0xF7)
+			|| (c >= 0x3B1 && c <= 0x3CB && c != 0x3C2) || (c >= 0x430 && c <= 0x44F))
+		return c - 0x20;
+	if(c >= 0x450 && c <= 0x45F)
+		return c - 0x50;
+	if(((c >= 0x101 && c <= 0x137 && c != 0x131) || (c >= 0x14B && c <= 0x177))
+			&& c % 2 == 1)
+		return c - 1;
+	if(((c >= 0x13A && c <= 0x148) || (c >= 0x17A && c <= 0x17E)) && c % 2 == 0)
+		return c - 1;
+	return c;
+}
+
+
+/**
+ * Reads the UTF-8 character at pos into c and returns its length. A byte
+ * which does not start a valid sequence is read on its own, as 0xDC00 plus
+ * the byte, so that it can't match a real character.
+ */
+size_t
+Decode(std::string_view text, size_t pos, size_t end, uint32_t& c)
+{
+	const unsigned char first = text[pos];
+	if(first < 0x80) {
+		c = first;
+		return 1;
+	}
+	size_t length;
+	uint32_t minimum;
+	if((first & 0xE0) == 0xC0) {
+		length = 2;
+		minimum = 0x80;
+		c = first & 0x1F;
+	} else if((first & 0xF0) == 0xE0) {
+		length = 3;
+		minimum = 0x800;
+		c = first & 0x0F;
+	} else if((first & 0xF8) == 0xF0) {
+		length = 4;
+		minimum = 0x10000;
+		c = first & 0x07;
+	} else {
+		c = 0xDC00 + first;
+		return 1;
+	}
+	if(pos + length > end) {
+		c = 0xDC00 + first;
+		return 1;
+	}
+	for(size_t i = 1; i < length; i++) {
+		const unsigned char next = text[pos + i];
+		if((next & 0xC0) != 0x80) {
+			c = 0xDC00 + first;
+			return 1;
+		}
+		c = (c << 6) | (next & 0x3F);
+	}
+	if(c < minimum || c > 0x10FFFF || (c >= 0xD800 && c <= 0xDFFF)) {
+		c = 0xDC00 + first;
+		return 1;
+	}
+	return length;
+}
+
+
+/**
+ * Bytes of multibyte characters count as word characters, like in
+ * Scintilla's default character classes.
+ */
+bool
+IsWordByte(unsigned char c)
+{
+	return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z')
+		|| (c >= 'A' && c <= 'Z') || c == '_' || c >= 0x80;
+}
+
+
+bool
+Holds(uint32_t assertion, std::string_view text, size_t pos)
+{
+	switch(assertion) {
+		case LINE_START:
+			return pos == 0 || text[pos - 1] == '\n'
+				|| (text[pos - 1] == '\r' && (pos == text.size() || text[pos] != '\n'));
+		case LINE_END:
+			return pos == text.size() || text[pos] == '\r'
+				|| (text[pos] == '\n' && (pos == 0 || text[pos - 1] != '\r'));
+		case WORD_BOUNDARY:
+		case NOT_WORD_BOUNDARY: {
+			const bool before = pos > 0 && IsWordByte(text[pos - 1]);
+			const bool after = pos < text.size() && IsWordByte(text[pos]);
+			return (before != after) == (assertion == WORD_BOUNDARY);
+		}
+	}
+	return false;
+}
+
+
+struct Node {
+	enum Type {
+		EMPTY,
+		LITERAL,
+		ANY_CHAR,
+		CHAR_CLASS,
+		ASSERTION,
+		GROUP,
+		CONCAT,
+		ALTERNATE,
+		REPEAT
+	};
+
+	Type				type = EMPTY;
+	// character, class, assertion or group number
+	uint32_t			value = 0;
+	uint32_t			min = 0;
+	// UINT32_MAX for no limit
+	uint32_t			max = 0;
+	bool				greedy = true;
+	std::vector<Node>	children;
+};
+
+
+class Parser {
+public:
+	Parser(std::string_view pattern, std::vector<Regex::CharClass>& classes)
+		:
+		fPattern(pattern),
+		fPosition(0),
+		fGroupCount(1),
+		fClasses(classes)
+	{
+	}
+
+	bool Parse(Node& node)
+	{
+		return _Alternation(node, 0) && fPosition == fPattern.size();
+	}
+
+	size_t GroupCount() const { return fGroupCount; }
+
+private:
+	bool _AtEnd() const { return fPosition >= fPattern.size(); }
+	char _Peek() const { return fPattern[fPosition]; }
+
+	uint32_t _Next()
+	{
+		uint32_t c;
+		fPosition += Decode(fPattern, fPosition, fPattern.size(), c);
+		return c;
+	}
+
+	bool _Alternation(Node& node, int depth)
+	{
+		if(depth > kMaxNesting)
+			return false;
+		node.type = Node::ALTERNATE;
+		while(true) {
+			node.children.emplace_back();
+			if(_Sequence(node.children.back(), depth) == false)
+				return false;
+			if(_AtEnd() || _Peek() != '|')
+				break;
+			fPosition++;
+		}
+		if(node.children.size() == 1) {
+			Node only = std::move(node.children[0]);
+			node = std::move(only);
+		}
+		return true;
+	}
+
+	bool _Sequence(Node& node, int depth)
+	{
+		node.type = Node::CONCAT;
+		while(!_AtEnd() && _Peek() != '|' && _Peek() != ')') {
+			node.children.emplace_back();
+			if(_Atom(node.children.back(), depth) == false
+					|| _Quantifier(node.children.back()) == false)
+				return false;
+		}
+		return true;
+	}
+
+	bool _Number(uint32_t& number)
+	{
+		const size_t start = fPosition;
+		number = 0;
+		while(!_AtEnd() && _Peek() >= '0' && _Peek() <= '9') {
+			number = std::min<uint32_t>(number * 10 + (_Peek() - '0'), kMaxRepeat + 1);
+			fPosition++;
+		}
+		return fPosition > start;
+	}
+
+	bool _Quantifier(Node& node)
+	{
+		if(_AtEnd())
+			return true;
+		uint32_t min, max;
+		const size_t start = fPosition;
+		switch(_Peek()) {
+			case '*': min = 0; max = UINT32_MAX; fPosition++; break;
+			case '+': min = 1; max = UINT32_MAX; fPosition++; break;
+			case '?': min = 0; max = 1; fPosition++; break;
+			case '{': {
+				fPosition++;
+				if(_Number(min) == false) {
+					// not a quantifier, { is taken literally
+					fPosition = start;
+					return true;
+				}
+				max = min;
+				if(!_AtEnd() && _Peek() == ',') {
+					fPosition++;
+					if(_Number(max) == false)
+						max = UINT32_MAX;
+				}
+				if(_AtEnd() || _Peek() != '}') {
+					fPosition = start;
+					return true;
+				}
+				fPosition++;
+				if(min > kMaxRepeat || (max != UINT32_MAX && (max > kMaxRepeat || max < min)))
+					return false;
+			} break;
+			default:
+				return true;
+		}
+		if(node.type == Node::EMPTY)
+			return false;
+		Node repeat;
+		repeat.type = Node::REPEAT;
+		repeat.min = min;
+		repeat.max = max;
+		if(!_AtEnd() && _Peek() == '?') {
+			repeat.greedy = false;
+			fPosition++;
+		}
+		repeat.children.push_back(std::move(node));
+		node = std::move(repeat);
+		// a quantifier can't follow another one
+		return _AtEnd() || (_Peek() != '*' && _Peek() != '+' && _Peek() != '?');
+	}
+
+	bool _Atom(Node& node, int depth)
+	{
+		const uint32_t c = _Next();
+		switch(c) {
+			case '(': {
+				uint32_t group = 0;
+				if(fPattern.substr(fPosition, 2) == "?:")
+					fPosition += 2;
+				else
+					group = fGroupCount++;
+				Node inner;
+				if(_Alternation(inner, depth + 1) == false || _AtEnd() || _Peek() != ')')
+					return false;
+				fPosition++;
+				if(group == 0) {
+					node = std::move(inner);
+					// (?:) can be repeated, unlike nothing at all
+					if(node.type == Node::EMPTY)
+						node.type = Node::CONCAT;
+				} else {
+					node.type = Node::GROUP;
+					node.value = group;
+					node.children.push_back(std::move(inner));
+				}
+			} break;
+			case ')':
+			case '*':
+			case '+':
+			case '?':
+				return false;
+			case '.':
+				node.type = Node::ANY_CHAR;
+			break;
+			case '^':
+				node.type = Node::ASSERTION;
+				node.value = LINE_START;
+			break;
+			case '$':
+				node.type = Node::ASSERTION;
+				node.value = LINE_END;
+			break;
+			case '[':
+				return _Class(node);
+			case '\\':
+				return _Escape(node);
+			default:
+				node.type = Node::LITERAL;
+				node.value = c;
+			break;
+		}
+		return true;
+	}
+
+	bool _Hex(size_t digits, uint32_t& c)
+	{
+		if(fPosition + digits > fPattern.size())
+			return false;
+		c = 0;
+		for(size_t i = 0; i < digits; i++) {
+			const char digit = fPattern[fPosition++];
+			c <<= 4;
+			if(digit >= '0' && digit <= '9')
+				c |= digit - '0';
+			else if(digit >= 'a' && digit <= 'f')
+				c |= digit - 'a' + 10;
+			else if(digit >= 'A' && digit <= 'F')
+				c |= digit - 'A' + 10;
+			else
+				return false;
+		}
+		return true;
+	}
+
+	/**
+	 * Reads an escaped character, as used both in and out of classes.
+	 */
+	bool _EscapedChar(uint32_t escaped, uint32_t& c)
+	{
+		switch(escaped) {
+			case 'n': c = '\n'; return true;
+			case 'r': c = '\r'; return true;
+			case 't': c = '\t'; return true;
+			case 'f': c = '\f'; return true;
+			case 'v': c = '\v'; return true;
+			case '0': c = '\0'; return true;
+			case 'x': return _Hex(2, c);
+			case 'u': return _Hex(4, c);
+		}
+		// back references
+		if(escaped >= '1' && escaped <= '9')
+			return false;
+		c = escaped;
+		return true;
+	}
+
+	/**
+	 * Adds the ranges of \d, \w or \s to charClass. Returns false for other
+	 * characters.
+	 */
+	static bool _Shorthand(uint32_t c, Regex::CharClass& charClass)
+	{
+		switch(c) {
+			case 'd':
+				charClass.ranges.push_back({ '0', '9' });
+				return true;
+			case 'w':
+				charClass.ranges.insert(charClass.ranges.end(),
+					{ { '0', '9' }, { 'A', 'Z' }, { '_', '_' }, { 'a', 'z' } });
+				return true;
+			case 's':
+				charClass.ranges.insert(charClass.ranges.end(),
+					{ { '\t', '\r' }, { ' ', ' ' }, { 0xA0, 0xA0 }, { 0x2028, 0x2029 } });
+				return true;
+		}
+		return false;
+	}
+
+	bool _Escape(Node& node)
+	{
+		if(_AtEnd())
+			return false;
+		const uint32_t escaped = _Next();
+		Regex::CharClass charClass;
+		const uint32_t lower = Lower(escaped);
+		if(lower < 0x80 && _Shorthand(lower, charClass)) {
+			charClass.negated = escaped != lower;
+			node.type = Node::CHAR_CLASS;
+			node.value = fClasses.size();
+			fClasses.push_back(std::move(charClass));
+			return true;
+		}
+		if(escaped == 'b' || escaped == 'B') {
+			node.type = Node::ASSERTION;
+			node.value = escaped == 'b' ? WORD_BOUNDARY : NOT_WORD_BOUNDARY;
+			return true;
+		}
+		node.type = Node::LITERAL;
+		return _EscapedChar(escaped, node.value);
+	}
+
+	bool _ClassChar(uint32_t& c)
+	{
+		if(_AtEnd())
+			return false;
+		c = _Next();
+		if(c != '\\')
+			return true;
+		if(_AtEnd())
+			return false;
+		const uint32_t escaped = _Next();
+		if(escaped == 'b') {
+			c = '\b';
+			return true;
+		}
+		return _EscapedChar(escaped, c);
+	}
+
+	bool _Class(Node& node)
+	{
+		Regex::CharClass charClass;
+		if(!_AtEnd() && _Peek() == '^') {
+			charClass.negated = true;
+			fPosition++;
+		}
+		bool first = true;
+		while(_AtEnd() || _Peek() != ']' || first) {
+			if(_AtEnd())
+				return false;
+			first = false;
+			// \d, \w and \s, the negated ones can't be expressed as ranges
+			if(_Peek() == '\\' && fPosition + 1 < fPattern.size()) {
+				const char escaped = fPattern[fPosition + 1];
+				if(escaped == 'D' || escaped == 'W' || escaped == 'S')
+					return false;
+				if(_Shorthand(escaped, charClass)) {
+					fPosition += 2;
+					continue;
+				}
+			}
+			uint32_t low, high;
+			if(_ClassChar(low) == false)
+				return false;
+			high = low;
+			if(fPosition + 1 < fPattern.size() && _Peek() == '-'
+					&& fPattern[fPosition + 1] != ']') {
+				fPosition++;
+				if(_ClassChar(high) == false || high < low)
+					return false;
+			}
+			charClass.ranges.push_back({ low, high });
+		}
+		fPosition++;
+		std::sort(charClass.ranges.begin(), charClass.ranges.end());
+		node.type = Node::CHAR_CLASS;
+		node.value = fClasses.size();
+		fClasses.push_back(std::move(charClass));
+		return true;
+	}
+
+	std::string_view				fPattern;
+	size_t							fPosition;
+	size_t							fGroupCount;
+	std::vector<Regex::CharClass>&	fClasses;
+};
+
+
+class Compiler {
+public:
+	Compiler(std::vector<Regex::Instruction>& program, bool ignoreCase)
+		:
+		fProgram(program),
+		fIgnoreCase(ignoreCase)
+	{
+	}
+
+	bool Compile(const Node& node)
+	{
+		switch(node.type) {
+			case Node::EMPTY:
+				return true;
+			case Node::LITERAL:
+				return _Emit(CHAR, fIgnoreCase ? Lower(node.value) : node.value);
+			case Node::ANY_CHAR:
+				return _Emit(ANY);
+			case Node::CHAR_CLASS:
+				return _Emit(CLASS, node.value);
+			case Node::ASSERTION:
+				return _Emit(ASSERT, node.value);
+			case Node::GROUP:
+				return _Emit(SAVE, node.value * 2) && Compile(node.children[0])
+					&& _Emit(SAVE, node.value * 2 + 1);
+			case Node::CONCAT:
+				for(const Node& child : node.children) {
+					if(Compile(child) == false)
+						return false;
+				}
+				return true;
+			case Node::ALTERNATE:
+				return _Alternate(node);
+			case Node::REPEAT:
+				return _Repeat(node);
+		}
+		return false;
+	}
+
+private:
+	bool _Emit(uint8_t op, uint32_t x = 0, uint32_t y = 0)
+	{
+		if(fProgram.size() >= kMaxProgramSize)
+			return false;
+		fProgram.push_back({ op, x, y });
+		return true;
+	}
+
+	uint32_t _Here() const { return fProgram.size(); }
+
+	bool _Alternate(const Node& node)
+	{
+		std::vector<uint32_t> jumps;
+		for(size_t i = 0; i < node.children.size(); i++) {
+			uint32_t split = 0;
+			const bool last = i + 1 == node.children.size();
+			if(last == false) {
+				split = _Here();
+				if(_Emit(SPLIT, split + 1) == false)
+					return false;
+			}
+			if(Compile(node.children[i]) == false)
+				return false;
+			if(last == false) {
+				jumps.push_back(_Here());
+				if(_Emit(JUMP) == false)
+					return false;
+				fProgram[split].y = _Here();
+			}
+		}
+		for(uint32_t jump : jumps)
+			fProgram[jump].x = _Here();
+		return true;
+	}
+
+	void _SetSplit(uint32_t split, uint32_t body, uint32_t out, bool greedy)
+	{
+		fProgram[split].x = greedy ? body : out;
+		fProgram[split].y = greedy ? out : body;
+	}
+
+	bool _Repeat(const Node& node)
+	{
+		const Node& child = node.children[0];
+		for(uint32_t i = 0; i < node.min; i++) {
+			if(Compile(child) == false)
+				return false;
+		}
+		if(node.max == UINT32_MAX) {
+			const uint32_t split = _Here();
+			if(_Emit(SPLIT) == false || Compile(child) == false
+					|| _Emit(JUMP, split) == false)
+				return false;
+			_SetSplit(split, split + 1, _Here(), node.greedy);
+			return true;
+		}
+		std::vector<uint32_t> splits;
+		for(uint32_t i = node.min; i < node.max; i++) {
+			splits.push_back(_Here());
+			if(_Emit(SPLIT) == false || Compile(child) == false)
+				return false;
+		}
+		for(uint32_t split : splits)
+			_SetSplit(split, split + 1, _Here(), node.greedy);
+		return true;
+	}
+
+	std::vector<Regex::Instruction>&	fProgram;
+	bool								fIgnoreCase;
+};
+
+
+/**
+ * The byte every match of node starts with, or -1 if there is no such byte
+ * or it can't be told easily.
+ */
+int
+FirstByte(const Node& node, bool ignoreCase)
+{
+	switch(node.type) {
+		case Node::LITERAL:
+			if(node.value >= 0x80 || (ignoreCase && Lower(node.value) != Upper(node.value)))
+				return -1;
+			return node.value;
+		case Node::GROUP:
+			return FirstByte(node.children[0], ignoreCase);
+		case Node::REPEAT:
+			return node.min > 0 ? FirstByte(node.children[0], ignoreCase) : -1;
+		case Node::CONCAT:
+			for(const Node& child : node.children) {
+				if(child.type != Node::ASSERTION && child.type != Node::EMPTY)
+					return FirstByte(child, ignoreCase);
+			}
+			return -1;
+		default:
+			return -1;
+	}
+}
+
+
+/**
+ * Threads of the VM at one position of the text, in the order of priority.
+ * Every instruction is run by one thread at most, the first to reach it.
+ */
+struct ThreadList {
+	std::vector<uint32_t>	threads;
+	// position of each instruction in threads, if it's there
+	std::vector<uint32_t>	index;
+	// capture slots of the thread at each instruction
+	std::vector<size_t>		captures;
+
+	ThreadList(size_t programSize, size_t slots)
+		:
+		index(programSize),
+		captures(programSize * slots)
+	{
+		threads.reserve(programSize);
+	}
+
+	bool Contains(uint32_t pc) const
+	{
+		return index[pc] < threads.size() && threads[index[pc]] == pc;
+	}
+};
+
+}
+
+
+std::string_view
+RegexMatch::Group(std::string_view text, size_t index) const
+{
+	if(index >= groups.size() || groups[index].first == npos)
+		return std::string_view();
+	return text.substr(groups[index].first,
+		groups[index].second - groups[index].first);
+}
+
+
+bool
+Regex::CharClass::Matches(uint32_t c, bool ignoreCase) const
+{
+	const auto contains = [this](uint32_t c) {
+		auto it = std::upper_bound(ranges.begin(), ranges.end(),
+			std::pair<uint32_t, uint32_t>(c, UINT32_MAX));
+		// ranges may overlap, so one that starts earlier may still hold c
+		for(; it != ranges.begin(); it--) {
+			if(std::prev(it)->second >= c)
+				return true;
+		}
+		return false;
+	};
+	bool found = contains(c);
+	if(found == false && ignoreCase == true)
+		found = contains(Lower(c)) || contains(Upper(c));
+	return found != negated;
+}
+
+
+/**
+ * Patterns are kept in a small cache, most recently used first, so that
+ * searching for the same pattern again does not compile it again.
+ */
+/* static */ std::shared_ptr<const Regex>
+Regex::Compile(std::string_view pattern, uint32_t flags)
+{
+	using Entry = std::pair<std::pair<std::string, uint32_t>,
+		std::shared_ptr<const Regex>>;
+	static std::mutex lock;
+	static std::list<Entry> cache;
+
+	std::lock_guard<std::mutex> guard(lock);
+	for(auto it = cache.begin(); it != cache.end(); it++) {
+		if(it->first.first == pattern && it->first.second == flags) {
+			cache.splice(cache.begin(), cache, it);
+			return it->second;
+		}
+	}
+
+	std::shared_ptr<Regex> regex(new Regex());
+	if(regex->_Parse(pattern, flags) == false)
+		regex.reset();
+	// invalid patterns are remembered too
+	cache.emplace_front(std::make_pair(std::string(pattern), flags), regex);
+	if(cache.size() > kCacheSize)
+		cache.pop_back();
+	return regex;
+}
+
+
+/**
+ * Finds the first match which starts at or after start and ends before end.
+ * Assertions like ^ and \b look at text outside of that range.
+ */
+bool
+Regex::Search(std::string_view text, size_t start, size_t end,
+	RegexMatch& match, size_t lastStart) const
+{
+	end = std::min(end, text.size());
+	if(start > end)
+		return false;
+	return _Match(text, start, end, std::min(lastStart, end), match);
+}
+
+
+/**
+ * Finds the last of the matches in range, going from start to end.
+ */
+bool
+Regex::SearchBackward(std::string_view text, size_t start, size_t end,
+	RegexMatch& match) const
+{
+	RegexMatch found;
+	bool any = false;
+	end = std::min(end, text.size());
+	while(start <= end && Search(text, start, end, found) == true) {
+		match = found;
+		any = true;
+		if(found.End() > found.Start())
+			start = found.End();
+		else if(found.End() < end) {
+			uint32_t c;
+			start = found.End() + Decode(text, found.End(), end, c);
+		} else
+			break;
+	}
+	return any;
+}
+
+
+bool
+Regex::_Parse(std::string_view pattern, uint32_t flags)
+{
+	Node node;
+	Parser parser(pattern, fClasses);
+	if(parser.Parse(node) == false)
+		return false;
+	fGroupCount = parser.GroupCount();
+	fIgnoreCase = (flags & IGNORE_CASE) != 0;
+
+	if((flags & WHOLE_WORD) != 0) {
+		Node word;
+		word.type = Node::CONCAT;
+		word.children.resize(3);
+		word.children[0].type = Node::ASSERTION;
+		word.children[0].value = WORD_BOUNDARY;
+		word.children[1] = std::move(node);
+		word.children[2].type = Node::ASSERTION;
+		word.children[2].value = WORD_BOUNDARY;
+		node = std::move(word);
+	}
+	fFirstByte = FirstByte(node, fIgnoreCase);
+
+	Compiler compiler(fProgram, fIgnoreCase);
+	fProgram.push_back({ SAVE, 0, 0 });
+	if(compiler.Compile(node) == false)
+		return false;
+	fProgram.push_back({ SAVE, 1, 0 });
+	fProgram.push_back({ MATCH, 0, 0 });
+	return true;
+}
+
+
+/**
+ * Runs the program over the text once, starting a new thread at every
+ * position until a match is found. Threads are kept in the order of
+ * priority, so the match is the one a backtracking engine would find.
+ */
+bool
+Regex::_Match(std::string_view text, size_t start, size_t end,
+	size_t lastStart, RegexMatch& match) const
+{
+	const size_t slots = fGroupCount * 2;
+	ThreadList current(fProgram.size(), slots);
+	ThreadList next(fProgram.size(), slots);
+	std::vector<size_t> initial(slots);
+
+	struct Frame {
+		uint32_t	pc;
+		// restore the slot to value instead of running pc
+		bool		restore;
+		uint32_t	slot;
+		size_t		value;
+	};
+	std::vector<Frame> stack;
+	// follows jumps, splits, saves and assertions to the instructions which
+	// consume a character or match, in the order of priority
+	const auto add = [&](ThreadList& list, uint32_t pc, size_t* captures,
+			size_t position) {
+		stack.push_back({ pc, false, 0, 0 });
+		while(!stack.empty()) {
+			const Frame frame = stack.back();
+			stack.pop_back();
+			if(frame.restore == true) {
+				captures[frame.slot] = frame.value;
+				continue;
+			}
+			if(list.Contains(frame.pc))
+				continue;
+			list.index[frame.pc] = list.threads.size();
+			list.threads.push_back(frame.pc);
+			const Instruction& instruction = fProgram[frame.pc];
+			switch(instruction.op) {
+				case JUMP:
+					stack.push_back({ instruction.x, false, 0, 0 });
+				break;
+				case SPLIT:
+					stack.push_back({ instruction.y, false, 0, 0 });
+					stack.push_back({ instruction.x, false, 0, 0 });
+				break;
+				case SAVE:
+					stack.push_back({ 0, true, instruction.x, captures[instruction.x] });
+					captures[instruction.x] = position;
+					stack.push_back({ frame.pc + 1, false, 0, 0 });
+				break;
+				case ASSERT:
+					if(Holds(instruction.x, text, position))
+						stack.push_back({ frame.pc + 1, false, 0, 0 });
+				break;
+				default:
+					std::copy(captures, captures + slots,
+						list.captures.begin() + frame.pc * slots);
+				break;
+			}
+		}
+	};
+
+	bool matched = false;
+	size_t position = start;
+	while(true) {
+		if(matched == false) {
+			if(current.threads.empty()) {
+				if(position > lastStart)
+					break;
+				if(fFirstByte >= 0) {
+					const void* found = memchr(text.data() + position, fFirstByte,
+						std::min(lastStart + 1, end) - position);
+					if(found == nullptr)
+						break;
+					position = static_cast<const char*>(found) - text.data();
+				}
+			}
+			// threads started before go on past lastStart
+			if(position <= lastStart) {
+				std::fill(initial.begin(), initial.end(), RegexMatch::npos);
+				add(current, 0, initial.data(), position);
+			}
+		}
+		if(matched == true && current.threads.empty())
+			break;
+
+		uint32_t c = 0;
+		const size_t length = position < end ? Decode(text, position, end, c) : 0;
+		const uint32_t folded = fIgnoreCase ? Lower(c) : c;
+		next.threads.clear();
+		for(uint32_t pc : current.threads) {
+			const Instruction& instruction = fProgram[pc];
+			bool step = false;
+			switch(instruction.op) {
+				case CHAR:
+					step = length > 0 && folded == instruction.x;
+				break;
+				case ANY:
+					step = length > 0 && c != '\n' && c != '\r';
+				break;
+				case CLASS:
+					step = length > 0
+						&& fClasses[instruction.x].Matches(c, fIgnoreCase);
+				break;
+				case MATCH: {
+					const size_t* captures = &current.captures[pc * slots];
+					match.groups.resize(fGroupCount);
+					for(size_t i = 0; i < fGroupCount; i++) {
+						match.groups[i] = { captures[i * 2], captures[i * 2 + 1] };
+						if(match.groups[i].second == RegexMatch::npos)
+							match.groups[i].first = RegexMatch::npos;
+					}
+					matched = true;
+				} break;
+			}
+			if(step == true)
+				add(next, pc + 1, &current.captures[pc * slots], position + length);
+			// threads after a match have lower priority
+			if(instruction.op == MATCH)
+				break;
+		}
+		std::swap(current, next);
+		if(length == 0)
+			break;
+		position += length;
+	}
+	return matched;
+}
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#ifndef REGEX_H
+#define REGEX_H
+
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+
+/**
+ * Where a regex matched: the whole match is group 0, followed by the capture
+ * groups in the order of their opening parentheses. Groups which did not
+ * take part in the match are (npos, npos).
+ */
+struct RegexMatch {
+	static constexpr size_t	npos = std::string_view::npos;
+
+	std::vector<std::pair<size_t, size_t>>	groups;
+
+	size_t				Start() const { return groups[0].first; }
+	size_t				End() const { return groups[0].second; }
+	std::string_view	Group(std::string_view text, size_t index) const;
+};
+
+
+/**
+ * Regex is a regular expression compiled to a program for a Pike VM, which
+ * runs every alternative at once instead of backtracking. Matching takes
+ * time linear in the length of the text whatever the pattern, and matches
+ * can span lines.
+ *
+ * The syntax is a subset of ECMAScript's: literals, ., [] classes with
+ * ranges, \d \w \s \D \W \S, \b \B, ^ and $ (at line ends), groups (...)
+ * and (?:...), | and the greedy and lazy quantifiers * + ? {n} {n,} {n,m}.
+ * Text is read as UTF-8, . and classes match whole characters. Back
+ * references can't be matched in linear time and are not supported.
+ */
+class Regex {
+public:
+	enum {
+		IGNORE_CASE	= 1 << 0,
+		// match only where a word starts and ends
+		WHOLE_WORD	= 1 << 1
+	};
+
+	// compiled patterns are shared, nullptr if pattern is not valid
+	static	std::shared_ptr<const Regex>	Compile(std::string_view pattern,
+												uint32_t flags = 0);
+
+			size_t		GroupCount() const { return fGroupCount; }
+
+			// with lastStart, only matches starting at or before it
+			bool		Search(std::string_view text, size_t start, size_t end,
+							RegexMatch& match,
+							size_t lastStart = RegexMatch::npos) const;
+			bool		SearchBackward(std::string_view text, size_t start,
+							size_t end, RegexMatch& match) const;
+
+	struct Instruction {
+		uint8_t		op;
+		// character, class, jump target, capture slot or assertion
+		uint32_t	x;
+		// second jump target
+		uint32_t	y;
+	};
+	struct CharClass {
+		// inclusive ranges of characters
+		std::vector<std::pair<uint32_t, uint32_t>>	ranges;
+		bool		negated = false;
+
+		bool		Matches(uint32_t c, bool ignoreCase) const;
+	};
+
+private:
+						Regex() = default;
+
+			bool		_Parse(std::string_view pattern, uint32_t flags);
+			bool		_Match(std::string_view text, size_t start, size_t end,
+							size_t lastStart, RegexMatch& match) const;
+
+	std::vector<Instruction>	fProgram;
+	std::vector<CharClass>		fClasses;
+	size_t						fGroupCount = 0;
+	bool						fIgnoreCase = false;
+	// every match starts with this byte, -1 if not known
+	int							fFirstByte = -1;
+};
+
+
+#endif // REGEX_H
@@ -159,6 +159,12 @@ Styler::_ApplyGlobal(Editor* editor, const char* style, const BPath &path, const
 		editor->SendMessage(SCI_INDICSETSTYLE, 0, INDIC_ROUNDBOX);
 		editor->SendMessage(SCI_INDICSETFORE, 0, 0x0000FF);
 		editor->SendMessage(SCI_INDICSETALPHA, 0, 100);
+		// occurrences
+		editor->SendMessage(SCI_INDICSETSTYLE, 1, INDIC_STRAIGHTBOX);
+		editor->SendMessage(SCI_INDICSETFORE, 1, 0x00C8FF);
+		editor->SendMessage(SCI_INDICSETALPHA, 1, 70);
+		editor->SendMessage(SCI_INDICSETOUTLINEALPHA, 1, 140);
+		editor->SendMessage(SCI_INDICSETUNDER, 1, true);
 		// IME
 		editor->SendMessage(SCI_INDICSETSTYLE, INDIC_IME, INDIC_FULLBOX);
 		editor->SendMessage(SCI_INDICSETFORE, INDIC_IME, 0xFF0000);
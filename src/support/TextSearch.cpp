@@ -0,0 +1,201 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include "TextSearch.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+
+namespace {
+
+// text searched between checks for cancellation
+const size_t kCancelCheckSize = 1024 * 1024;
+
+
+std::string
+EscapeRegex(std::string_view text)
+{
+	std::string escaped;
+	for(char c : text) {
+		if(strchr("\\^$.|?*+()[]{}", c) != nullptr && c != '\0')
+			escaped += '\\';
+		escaped += c;
+	}
+	return escaped;
+}
+
+
+/**
+ * Counts line ends between start and end the way Scintilla does: CR LF, a
+ * lone CR or a lone LF.
+ */
+uint64_t
+CountLines(std::string_view text, size_t start, size_t end)
+{
+	uint64_t lines = 0;
+	for(size_t i = start; i < end; i++) {
+		if(text[i] == '\n')
+			lines++;
+		else if(text[i] == '\r' && (i + 1 == text.size() || text[i + 1] != '\n'))
+			lines++;
+	}
+	return lines;
+}
+
+}
+
+
+TextSearch::TextSearch(std::string_view pattern, bool matchCase,
+	bool matchWord, bool regex)
+{
+	const bool ascii = std::all_of(pattern.begin(), pattern.end(),
+		[](char c) { return static_cast<unsigned char>(c) < 0x80; });
+	if(regex == false && matchWord == false && (matchCase == true || ascii == true)) {
+		if(!pattern.empty())
+			fLiteral.emplace(pattern, !matchCase);
+		return;
+	}
+	const uint32_t flags = (matchCase == true ? 0 : Regex::IGNORE_CASE)
+		| (matchWord == true ? Regex::WHOLE_WORD : 0);
+	if(regex == true)
+		fRegex = Regex::Compile(pattern, flags);
+	else if(!pattern.empty())
+		fRegex = Regex::Compile(EscapeRegex(pattern), flags);
+}
+
+
+bool
+TextSearch::IsValid() const
+{
+	return fLiteral.has_value() || fRegex != nullptr;
+}
+
+
+/**
+ * Finds the first match between start and end.
+ */
+bool
+TextSearch::Find(std::string_view text, size_t start, size_t end,
+	size_t& matchStart, size_t& matchEnd) const
+{
+	if(fLiteral) {
+		matchStart = fLiteral->Find(text, start, end);
+		matchEnd = matchStart + fLiteral->Length();
+		return matchStart != LiteralSearch::npos;
+	}
+	RegexMatch match;
+	if(Search(text, start, end, false, match) == false)
+		return false;
+	matchStart = match.Start();
+	matchEnd = match.End();
+	return true;
+}
+
+
+/**
+ * Finds the first match between start and end, or the last one if backward
+ * is set. Plain text matches have only the whole match as group 0.
+ */
+bool
+TextSearch::Search(std::string_view text, size_t start, size_t end,
+	bool backward, RegexMatch& match) const
+{
+	match.groups.clear();
+	if(fLiteral) {
+		const size_t found = backward
+			? fLiteral->FindBackward(text, start, end)
+			: fLiteral->Find(text, start, end);
+		if(found == LiteralSearch::npos)
+			return false;
+		match.groups.emplace_back(found, found + fLiteral->Length());
+		return true;
+	}
+	if(fRegex == nullptr)
+		return false;
+	return backward
+		? fRegex->SearchBackward(text, start, end, match)
+		: fRegex->Search(text, start, end, match);
+}
+
+
+/**
+ * Finds every match in text and passes them to batch, batchSize at a time,
+ * with whatever is left at the end. Lines are counted on the way, so that
+ * the caller does not have to.
+ * The text is searched kCancelCheckSize at a time, and cancelled is polled
+ * in between, so that a search with few matches stops quickly too.
+ */
+bool
+TextSearch::FindAll(std::string_view text, size_t batchSize,
+	const BatchFunction& batch, const CancelFunction& cancelled) const
+{
+	std::vector<TextMatch> matches;
+	matches.reserve(batchSize);
+	uint64_t line = 0;
+	size_t counted = 0;
+	size_t position = 0;
+	size_t matchStart, matchEnd;
+	while(position <= text.size()) {
+		if(cancelled && cancelled() == true)
+			return false;
+		// matches starting in the chunk may end past it
+		size_t chunkEnd = std::min(position + kCancelCheckSize, text.size());
+		while(chunkEnd < text.size() && (text[chunkEnd] & 0xC0) == 0x80)
+			chunkEnd++;
+		const size_t lastStart = chunkEnd < text.size() ? chunkEnd - 1 : chunkEnd;
+		if(_FindStartingBy(text, position, lastStart, matchStart,
+				matchEnd) == false) {
+			if(chunkEnd == text.size())
+				break;
+			position = chunkEnd;
+			continue;
+		}
+		line += CountLines(text, counted, matchStart);
+		counted = matchStart;
+		matches.push_back({ matchStart, matchEnd, line });
+		if(matches.size() >= batchSize) {
+			if(batch(matches) == false)
+				return false;
+			matches.clear();
+		}
+		position = matchEnd;
+		if(matchEnd == matchStart) {
+			// an empty match would be found again, skip a whole character
+			position++;
+			while(position < text.size() && (text[position] & 0xC0) == 0x80)
+				position++;
+		}
+	}
+	if(!matches.empty())
+		return batch(matches);
+	return true;
+}
+
+
+/**
+ * Finds the first match which starts between start and lastStart, it may
+ * end after lastStart.
+ */
+bool
+TextSearch::_FindStartingBy(std::string_view text, size_t start,
+	size_t lastStart, size_t& matchStart, size_t& matchEnd) const
+{
+	if(fLiteral) {
+		matchStart = fLiteral->Find(text, start,
+			std::min(text.size(), lastStart + fLiteral->Length()));
+		matchEnd = matchStart + fLiteral->Length();
+		return matchStart != LiteralSearch::npos;
+	}
+	RegexMatch match;
+	if(fRegex == nullptr
+			|| fRegex->Search(text, start, text.size(), match, lastStart) == false)
+		return false;
+	matchStart = match.Start();
+	matchEnd = match.End();
+	return true;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+#ifndef TEXTSEARCH_H
+#define TEXTSEARCH_H
+
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "LiteralSearch.h"
+#include "Regex.h"
+
+
+/**
+ * A match and the line it starts on, counted from 0.
+ */
+struct TextMatch {
+	uint64_t	start;
+	uint64_t	end;
+	uint64_t	line;
+
+	bool		operator==(const TextMatch& other) const = default;
+};
+
+
+/**
+ * TextSearch finds a pattern with the options of the Find window. Plain
+ * text is found with LiteralSearch when it can be, whole words and case
+ * folding beyond ASCII need the regex engine.
+ */
+class TextSearch {
+public:
+	// called with the next matches, returns false to stop
+	typedef std::function<bool(const std::vector<TextMatch>&)> BatchFunction;
+	// polled while searching, returns true to stop
+	typedef std::function<bool()> CancelFunction;
+
+							TextSearch(std::string_view pattern, bool matchCase,
+								bool matchWord, bool regex);
+
+	bool					IsValid() const;
+	// plain text is matched without looking outside of start and end
+	bool					IsLiteral() const { return fLiteral.has_value(); }
+
+	bool					Find(std::string_view text, size_t start,
+								size_t end, size_t& matchStart,
+								size_t& matchEnd) const;
+	// the first match, or the last one if backward, with regex groups
+	bool					Search(std::string_view text, size_t start,
+								size_t end, bool backward,
+								RegexMatch& match) const;
+	// returns false if stopped by batch or cancelled
+	bool					FindAll(std::string_view text, size_t batchSize,
+								const BatchFunction& batch,
+								const CancelFunction& cancelled = {}) const;
+
+private:
+	bool					_FindStartingBy(std::string_view text,
+								size_t start, size_t lastStart,
+								size_t& matchStart, size_t& matchEnd) const;
+
+	std::optional<LiteralSearch>	fLiteral;
+	std::shared_ptr<const Regex>	fRegex;
+};
+
+
+#endif // TEXTSEARCH_H
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "support/Chunker.h"
+#include "support/Hash.h"
+
+
+namespace {
+
+std::string
+RandomData(size_t size, unsigned seed)
+{
+	std::mt19937 generator(seed);
+	std::string data(size, '\0');
+	for(auto& c : data)
+		c = static_cast<char>(generator());
+	return data;
+}
+
+
+std::vector<std::string>
+Split(const std::string& data, size_t pieceSize)
+{
+	std::vector<std::string> chunks;
+	Chunker chunker;
+	auto collect = [&](std::string_view chunk) { chunks.emplace_back(chunk); };
+	for(size_t i = 0; i < data.size(); i += pieceSize)
+		chunker.Update(std::string_view(data).substr(i, pieceSize), collect);
+	chunker.Finish(collect);
+	return chunks;
+}
+
+}
+
+// Hasher
+
+TEST(HasherTest, MatchesReferenceValues) {
+	ASSERT_EQ(HashData("").ToString(), "00000000000000000000000000000000");
+	ASSERT_EQ(HashData("hello").ToString(), "cbd8a7b341bd9b025b1e906a48ae1d19");
+	ASSERT_EQ(HashData("The quick brown fox jumps over the lazy dog").ToString(),
+		"e34bbc7bbc071b6c7a433ca9c49a9347");
+}
+
+TEST(HasherTest, IndependentOfSplitting) {
+	const std::string data = RandomData(1000, 1);
+	Hasher hasher;
+	for(size_t i = 0; i < data.size(); i += 7)
+		hasher.Update(std::string_view(data).substr(i, 7));
+	ASSERT_EQ(hasher.Final(), HashData(data));
+}
+
+// Chunker
+
+TEST(ChunkerTest, ChunksCoverInput) {
+	const std::string data = RandomData(1 << 20, 2);
+	const auto chunks = Split(data, data.size());
+	std::string joined;
+	for(const auto& chunk : chunks) {
+		ASSERT_LE(chunk.size(), 64u * 1024);
+		joined += chunk;
+	}
+	ASSERT_EQ(joined, data);
+	ASSERT_GT(chunks.size(), 1u);
+}
+
+TEST(ChunkerTest, IndependentOfSplitting) {
+	const std::string data = RandomData(256 * 1024, 3);
+	ASSERT_EQ(Split(data, data.size()), Split(data, 1000));
+}
+
+TEST(ChunkerTest, InsertionChangesFewChunks) {
+	const std::string data = RandomData(1 << 20, 4);
+	std::string edited = data;
+	edited.insert(data.size() / 2, "inserted");
+	const auto before = Split(data, data.size());
+	const auto after = Split(edited, edited.size());
+	size_t shared = 0;
+	for(const auto& chunk : after) {
+		if(std::find(before.begin(), before.end(), chunk) != before.end())
+			shared++;
+	}
+	ASSERT_GE(shared + 2, before.size());
+}
@@ -0,0 +1,146 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "support/Compression.h"
+
+
+namespace {
+
+std::string
+Compress(Compression compression, const std::string& input, size_t pieceSize)
+{
+	Compressor compressor(compression);
+	std::string output;
+	for(size_t i = 0; i < input.size(); i += pieceSize)
+		EXPECT_TRUE(compressor.Compress(std::string_view(input).substr(i, pieceSize), output));
+	EXPECT_TRUE(compressor.Finish(output));
+	return output;
+}
+
+
+bool
+Decompress(Compression compression, const std::string& input, size_t pieceSize,
+	std::string& output)
+{
+	Decompressor decompressor(compression);
+	for(size_t i = 0; i < input.size(); i += pieceSize) {
+		if(!decompressor.Decompress(std::string_view(input).substr(i, pieceSize), output))
+			return false;
+	}
+	return decompressor.Finish(output);
+}
+
+
+std::string
+SampleText()
+{
+	std::string text;
+	for(int i = 0; i < 20000; i++)
+		text += "2026-10-18 12:00:00 INFO request " + std::to_string(i * 7919 % 1000) + " served\n";
+	return text;
+}
+
+const Compression kFormats[] = { Compression::GZIP, Compression::ZSTD, Compression::XZ };
+
+}
+
+// DetectCompression
+
+TEST(DetectCompressionTest, RecognizesMagicBytes) {
+	ASSERT_EQ(DetectCompression("\x1F\x8B\x08\x00", 4), Compression::GZIP);
+	ASSERT_EQ(DetectCompression("\x28\xB5\x2F\xFD\x00", 5), Compression::ZSTD);
+	ASSERT_EQ(DetectCompression("\xFD" "7zXZ\0", 6), Compression::XZ);
+	ASSERT_EQ(DetectCompression("\xFD" "7zX", 4), Compression::NONE);
+	ASSERT_EQ(DetectCompression("plain text", 10), Compression::NONE);
+	ASSERT_EQ(DetectCompression("", 0), Compression::NONE);
+}
+
+TEST(DetectCompressionTest, RecognizesCompressedOutput) {
+	for(Compression compression : kFormats)
+		ASSERT_EQ(DetectCompression(Compress(compression, "text", 4).data(),
+			kCompressionMagicSize), compression);
+}
+
+// Filenames
+
+TEST(CompressionFilenameTest, MatchesExtensions) {
+	ASSERT_EQ(CompressionForFilename("syslog.1.gz"), Compression::GZIP);
+	ASSERT_EQ(CompressionForFilename("dump.SQL.ZST"), Compression::ZSTD);
+	ASSERT_EQ(CompressionForFilename("a.tar.xz"), Compression::XZ);
+	ASSERT_EQ(CompressionForFilename("notes.txt"), Compression::NONE);
+	ASSERT_EQ(CompressionForFilename(".gz"), Compression::NONE);
+}
+
+TEST(CompressionFilenameTest, StripsExtension) {
+	ASSERT_EQ(StripCompressionExtension("foo.log.gz"), "foo.log");
+	ASSERT_EQ(StripCompressionExtension("main.cpp.xz"), "main.cpp");
+	ASSERT_EQ(StripCompressionExtension("Makefile.zst"), "Makefile");
+	ASSERT_EQ(StripCompressionExtension("foo.log"), "foo.log");
+}
+
+// Compressor and Decompressor
+
+TEST(CompressionTest, RoundTripsInPieces) {
+	const std::string text = SampleText();
+	for(Compression compression : kFormats) {
+		const std::string compressed = Compress(compression, text, 100000);
+		ASSERT_LT(compressed.size(), text.size() / 4);
+		for(size_t pieceSize : { (size_t) 7, (size_t) 333, compressed.size() }) {
+			std::string output;
+			ASSERT_TRUE(Decompress(compression, compressed, pieceSize, output));
+			ASSERT_EQ(output, text);
+		}
+	}
+}
+
+TEST(CompressionTest, RoundTripsEmptyText) {
+	for(Compression compression : kFormats) {
+		std::string output;
+		ASSERT_TRUE(Decompress(compression, Compress(compression, "", 1), 5, output));
+		ASSERT_EQ(output, "");
+	}
+}
+
+TEST(CompressionTest, DecompressesConcatenatedStreams) {
+	for(Compression compression : kFormats) {
+		const std::string joined = Compress(compression, "first\n", 6)
+			+ Compress(compression, "second\n", 7);
+		std::string output;
+		ASSERT_TRUE(Decompress(compression, joined, 3, output));
+		ASSERT_EQ(output, "first\nsecond\n");
+	}
+}
+
+TEST(CompressionTest, DetectsTruncatedData) {
+	const std::string text = SampleText();
+	for(Compression compression : kFormats) {
+		const std::string compressed = Compress(compression, text, text.size());
+		std::string output;
+		ASSERT_FALSE(Decompress(compression,
+			compressed.substr(0, compressed.size() / 2), 4096, output));
+	}
+}
+
+TEST(CompressionTest, DetectsCorruptedData) {
+	for(Compression compression : kFormats) {
+		std::string compressed = Compress(compression, SampleText(), 65536);
+		for(size_t i = 32; i < 64; i++)
+			compressed[i] = ~compressed[i];
+		std::string output;
+		ASSERT_FALSE(Decompress(compression, compressed, 4096, output));
+	}
+}
+
+TEST(CompressionTest, CopiesUncompressedData) {
+	std::string output;
+	ASSERT_TRUE(Decompress(Compression::NONE, "plain", 2, output));
+	ASSERT_EQ(output, "plain");
+	ASSERT_EQ(Compress(Compression::NONE, "plain", 3), "plain");
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "support/Encoding.h"
+
+
+namespace {
+
+std::string
+Decode(TextEncoding encoding, const std::string& input, size_t pieceSize)
+{
+	TextDecoder decoder(encoding);
+	std::string output;
+	for(size_t i = 0; i < input.size(); i += pieceSize)
+		decoder.Decode(std::string_view(input).substr(i, pieceSize), output);
+	decoder.Finish(output);
+	return output;
+}
+
+
+std::string
+Encode(TextEncoding encoding, const std::string& input, size_t pieceSize)
+{
+	TextEncoder encoder(encoding);
+	std::string output;
+	for(size_t i = 0; i < input.size(); i += pieceSize)
+		encoder.Encode(std::string_view(input).substr(i, pieceSize), output);
+	encoder.Finish(output);
+	return output;
+}
+
+// "zażółć 😀" in UTF-8, UTF-16 LE with BOM and UTF-16 BE with BOM
+const std::string kUTF8 = "za\xC5\xBC\xC3\xB3\xC5\x82\xC4\x87 \xF0\x9F\x98\x80";
+const std::string kUTF16LE = std::string("\xFF\xFEz\0a\0\x7C\x01\xF3\0\x42\x01\x07\x01 \0\x3D\xD8\x00\xDE", 20);
+const std::string kUTF16BE = std::string("\xFE\xFF\0z\0a\x01\x7C\0\xF3\x01\x42\x01\x07\0 \xD8\x3D\xDE\x00", 20);
+
+}
+
+// ValidUTF8Prefix
+
+TEST(ValidUTF8PrefixTest, AcceptsValidText) {
+	const std::string text = std::string(100, 'a') + kUTF8 + std::string(37, 'b');
+	ASSERT_EQ(ValidUTF8Prefix(text.data(), text.size()), text.size());
+}
+
+TEST(ValidUTF8PrefixTest, StopsAtMalformedSequences) {
+	const std::string overlong = std::string(40, 'a') + "\xC0\xAF";
+	ASSERT_EQ(ValidUTF8Prefix(overlong.data(), overlong.size()), 40u);
+	const std::string surrogate = "ab\xED\xA0\x80";
+	ASSERT_EQ(ValidUTF8Prefix(surrogate.data(), surrogate.size()), 2u);
+	const std::string tooBig = "\xF4\x90\x80\x80";
+	ASSERT_EQ(ValidUTF8Prefix(tooBig.data(), tooBig.size()), 0u);
+	const std::string latin1 = "caf\xE9";
+	ASSERT_EQ(ValidUTF8Prefix(latin1.data(), latin1.size()), 3u);
+}
+
+// DetectEncoding
+
+TEST(DetectEncodingTest, RecognizesBOMs) {
+	ASSERT_EQ(DetectEncoding("\xEF\xBB\xBFtext", 7), TextEncoding::UTF8_BOM);
+	ASSERT_EQ(DetectEncoding(kUTF16LE.data(), kUTF16LE.size()), TextEncoding::UTF16_LE);
+	ASSERT_EQ(DetectEncoding(kUTF16BE.data(), kUTF16BE.size()), TextEncoding::UTF16_BE);
+}
+
+TEST(DetectEncodingTest, FallsBackToHeuristics) {
+	ASSERT_EQ(DetectEncoding(kUTF8.data(), kUTF8.size()), TextEncoding::UTF8);
+	ASSERT_EQ(DetectEncoding("caf\xE9", 4), TextEncoding::LATIN1);
+	ASSERT_EQ(DetectEncoding("t\0e\0x\0t\0", 8), TextEncoding::UTF16_LE);
+	ASSERT_EQ(DetectEncoding("\0t\0e\0x\0t", 8), TextEncoding::UTF16_BE);
+}
+
+TEST(DetectEncodingTest, AcceptsCutOffSampleAsUTF8) {
+	const std::string sample = kUTF8.substr(0, kUTF8.size() - 2);
+	ASSERT_EQ(DetectEncoding(sample.data(), sample.size(), false), TextEncoding::UTF8);
+	ASSERT_EQ(DetectEncoding(sample.data(), sample.size(), true), TextEncoding::LATIN1);
+}
+
+// LooksBinary
+
+TEST(LooksBinaryTest, AcceptsText) {
+	const std::string text = "int main()\n{\n\treturn 0;\r\n}\f\x1B[0m\n";
+	ASSERT_FALSE(LooksBinary(text.data(), text.size()));
+	ASSERT_FALSE(LooksBinary(kUTF8.data(), kUTF8.size()));
+	ASSERT_FALSE(LooksBinary(kUTF16LE.data(), kUTF16LE.size()));
+	ASSERT_FALSE(LooksBinary("t\0e\0x\0t\0", 8));
+	ASSERT_FALSE(LooksBinary("caf\xE9 au lait", 12));
+	ASSERT_FALSE(LooksBinary("", 0));
+}
+
+TEST(LooksBinaryTest, RejectsBinaryData) {
+	ASSERT_TRUE(LooksBinary("\x7F" "ELF\x02\x01\x01\0\0\0", 10));
+	ASSERT_TRUE(LooksBinary("text with a NUL\0 in it", 23));
+	std::string noise;
+	for(int i = 0; i < 4096; i++)
+		noise += static_cast<char>((i * 7919 + 13) % 255 + 1);
+	ASSERT_TRUE(LooksBinary(noise.data(), noise.size()));
+}
+
+// TextDecoder / TextEncoder
+
+TEST(TextDecoderTest, DecodesInAnyPieces) {
+	for(size_t pieceSize : { 1, 3, 100 }) {
+		ASSERT_EQ(Decode(TextEncoding::UTF16_LE, kUTF16LE, pieceSize), kUTF8);
+		ASSERT_EQ(Decode(TextEncoding::UTF16_BE, kUTF16BE, pieceSize), kUTF8);
+		ASSERT_EQ(Decode(TextEncoding::UTF8_BOM, "\xEF\xBB\xBF" + kUTF8, pieceSize), kUTF8);
+	}
+	ASSERT_EQ(Decode(TextEncoding::LATIN1, "caf\xE9", 1), "caf\xC3\xA9");
+}
+
+TEST(TextDecoderTest, ReplacesUnpairedSurrogates) {
+	const std::string input("\x3D\xD8" "a\0", 4);
+	ASSERT_EQ(Decode(TextEncoding::UTF16_LE, input, 4), "\xEF\xBF\xBD" "a");
+}
+
+TEST(TextEncoderTest, RoundTrips) {
+	for(size_t pieceSize : { 1, 2, 5, 100 }) {
+		ASSERT_EQ(Encode(TextEncoding::UTF16_LE, kUTF8, pieceSize), kUTF16LE);
+		ASSERT_EQ(Encode(TextEncoding::UTF16_BE, kUTF8, pieceSize), kUTF16BE);
+		ASSERT_EQ(Encode(TextEncoding::LATIN1, "caf\xC3\xA9", pieceSize), "caf\xE9");
+	}
+}
+
+TEST(TextEncoderTest, ReportsUnencodableText) {
+	ASSERT_TRUE(CanEncode(TextEncoding::LATIN1, "caf\xC3\xA9"));
+	ASSERT_FALSE(CanEncode(TextEncoding::LATIN1, kUTF8));
+	ASSERT_TRUE(CanEncode(TextEncoding::UTF16_LE, kUTF8));
+	ASSERT_EQ(Encode(TextEncoding::LATIN1, "\xC5\xBC", 1), "?");
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "support/FileState.h"
+
+
+namespace {
+
+FileState
+SampleState()
+{
+	FileState state;
+	state.caret = 123456;
+	state.anchor = 123400;
+	state.firstVisibleLine = 3000;
+	state.folds = { 10, 42, 43, 5000 };
+	state.bookmarks = { 0, 7, 1000000 };
+	return state;
+}
+
+}
+
+
+TEST(FileStateTest, RoundTrip)
+{
+	const FileState state = SampleState();
+	FileState read;
+	ASSERT_TRUE(read.Deserialize(state.Serialize()));
+	EXPECT_EQ(read, state);
+}
+
+
+TEST(FileStateTest, EmptyState)
+{
+	const FileState state;
+	const std::string data = state.Serialize();
+	EXPECT_EQ(data.size(), 6u);
+	FileState read = SampleState();
+	ASSERT_TRUE(read.Deserialize(data));
+	EXPECT_EQ(read, state);
+}
+
+
+TEST(FileStateTest, IsCompact)
+{
+	FileState state;
+	for(int64_t line = 0; line < 1000; line += 3)
+		state.bookmarks.push_back(line);
+	// close lines take a byte each
+	EXPECT_LT(state.Serialize().size(), state.bookmarks.size() + 16);
+}
+
+
+TEST(FileStateTest, NormalizesLines)
+{
+	FileState state;
+	state.caret = -5;
+	state.folds = { 30, -1, 10, 30, 20 };
+	FileState read;
+	ASSERT_TRUE(read.Deserialize(state.Serialize()));
+	EXPECT_EQ(read.caret, 0);
+	EXPECT_EQ(read.folds, (std::vector<int64_t>{ 10, 20, 30 }));
+}
+
+
+TEST(FileStateTest, LargeValues)
+{
+	FileState state;
+	state.caret = INT64_MAX;
+	state.bookmarks = { 1, INT64_MAX };
+	FileState read;
+	ASSERT_TRUE(read.Deserialize(state.Serialize()));
+	EXPECT_EQ(read, state);
+}
+
+
+TEST(FileStateTest, RejectsDamagedRecords)
+{
+	const FileState original = SampleState();
+	const std::string data = original.Serialize();
+	for(size_t length = 0; length < data.size(); length++) {
+		FileState read = original;
+		read.caret = 1;
+		EXPECT_FALSE(read.Deserialize(data.substr(0, length))) << length;
+		// left unchanged
+		EXPECT_EQ(read.caret, 1);
+	}
+	FileState read;
+	EXPECT_FALSE(read.Deserialize(data + "x"));
+}
+
+
+TEST(FileStateTest, RejectsUnknownVersion)
+{
+	std::string data = SampleState().Serialize();
+	data[0] = 2;
+	FileState read;
+	EXPECT_FALSE(read.Deserialize(data));
+}
+
+
+TEST(FileStateTest, RejectsHugeCounts)
+{
+	// version, three positions, a fold count far beyond the data
+	const std::string data("\x01\x00\x00\x00\xFF\xFF\xFF\xFF\x0F", 9);
+	FileState read;
+	EXPECT_FALSE(read.Deserialize(data));
+}
@@ -11,6 +11,7 @@
 #include <ScintillaView.h>
 #include <Window.h>
 
+#include "editor/Editor.h"
 #include "editor/FindReplaceHandler.h"
 
 
@@ -19,7 +20,7 @@ class FindReplaceTest : public ::testing::Test
 protected:
 	BApplication* fApplication;
 	BWindow* fWindow;
-	BScintillaView* fEditor;
+	Editor* fEditor;
 	FindReplaceHandler* fFindReplaceHandler;
 	BMessenger* fMessenger;
 
@@ -33,7 +34,7 @@ FindReplaceTest::SetUp()
 {
 	fApplication = new BApplication("application/x-vnd.KapiX-KoderFindReplaceTest");
 	fWindow = new BWindow(BRect(100, 100, 400, 400), "FindReplaceTest", B_DOCUMENT_WINDOW, 0);
-	fEditor = new BScintillaView("EditorView", 0, true, true, B_NO_BORDER);
+	fEditor = new Editor();
 	fFindReplaceHandler = new FindReplaceHandler(fEditor, fWindow);
 	fWindow->AddHandler(fFindReplaceHandler);
 	BGroupLayout *layout = new BGroupLayout(B_VERTICAL, 0);
@@ -485,6 +486,29 @@ TEST_F(FindReplaceTest, ReplaceAllDoesntGoIntoInfiniteLoop)
 	fMessenger->SendMessage(&replaceMessage, &reply);
 }
 
+TEST_F(FindReplaceTest, ReplaceAllExpandsRegexGroups)
+{
+	fEditor->LockLooper();
+	fEditor->SetText("a=1 b=2\nc=3");
+	fEditor->SendMessage(SCI_GOTOPOS, 0);
+	fEditor->UnlockLooper();
+
+	BMessage reply;
+	BMessage replaceMessage(FindReplaceHandler::REPLACEALL);
+	replaceMessage.AddString("findText", "(\\w)=(\\d)");
+	replaceMessage.AddString("replaceText", "\\2=\\1\\t");
+	replaceMessage.AddBool("regex", true);
+	fMessenger->SendMessage(&replaceMessage, &reply);
+
+	int32 replaced = reply.GetInt32("replaced", 0);
+	EXPECT_EQ(replaced, 3);
+
+	const int length = fEditor->SendMessage(SCI_GETLENGTH);
+	std::string text(length, '\0');
+	fEditor->GetText(0, length + 1, text.data());
+	EXPECT_EQ(text, "1=a\t 2=b\t\n3=c\t");
+}
+
 TEST_F(FindReplaceTest, ReplaceFindReplacesAndGoesToNextResult)
 {
 	fEditor->LockLooper();
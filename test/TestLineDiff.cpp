@@ -0,0 +1,163 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "support/LineDiff.h"
+
+
+namespace {
+
+/**
+ * Applies hunks from the last one, the way the editor does, so that offsets
+ * of earlier hunks stay valid.
+ */
+std::string
+Apply(std::string text, const std::vector<DiffHunk>& hunks,
+	const std::string& newText)
+{
+	for(auto it = hunks.rbegin(); it != hunks.rend(); it++) {
+		text.replace(it->oldOffset, it->oldLength,
+			newText.substr(it->newOffset, it->newLength));
+	}
+	return text;
+}
+
+
+std::string
+RandomLines(std::mt19937& generator, size_t count)
+{
+	std::string text;
+	for(size_t i = 0; i < count; i++)
+		text += "line " + std::to_string(generator() % 20) + "\n";
+	return text;
+}
+
+}
+
+
+TEST(LineDiffTest, IdenticalTexts)
+{
+	const std::string text = "one\ntwo\nthree\n";
+	auto hunks = DiffLines(text, text);
+	ASSERT_TRUE(hunks.has_value());
+	EXPECT_TRUE(hunks->empty());
+}
+
+
+TEST(LineDiffTest, EmptyTexts)
+{
+	auto hunks = DiffLines("", "abc\n");
+	ASSERT_TRUE(hunks.has_value());
+	EXPECT_EQ(*hunks, (std::vector<DiffHunk>{ { 0, 0, 0, 4 } }));
+
+	hunks = DiffLines("abc\n", "");
+	ASSERT_TRUE(hunks.has_value());
+	EXPECT_EQ(*hunks, (std::vector<DiffHunk>{ { 0, 4, 0, 0 } }));
+}
+
+
+TEST(LineDiffTest, ChangedLine)
+{
+	auto hunks = DiffLines("one\ntwo\nthree\n", "one\n2\nthree\n");
+	ASSERT_TRUE(hunks.has_value());
+	EXPECT_EQ(*hunks, (std::vector<DiffHunk>{ { 4, 4, 4, 2 } }));
+}
+
+
+TEST(LineDiffTest, SeparateHunks)
+{
+	const std::string oldText = "a\nb\nc\nd\ne\nf\n";
+	const std::string newText = "a\nB\nc\nd\nf\ng\n";
+	auto hunks = DiffLines(oldText, newText);
+	ASSERT_TRUE(hunks.has_value());
+	// b -> B, e removed, g added
+	EXPECT_EQ(hunks->size(), 3u);
+	EXPECT_EQ(Apply(oldText, *hunks, newText), newText);
+}
+
+
+TEST(LineDiffTest, MissingFinalNewline)
+{
+	const std::string oldText = "a\nb";
+	const std::string newText = "a\nb\nc";
+	auto hunks = DiffLines(oldText, newText);
+	ASSERT_TRUE(hunks.has_value());
+	EXPECT_EQ(*hunks, (std::vector<DiffHunk>{ { 2, 1, 2, 3 } }));
+}
+
+
+TEST(LineDiffTest, CRLFLines)
+{
+	const std::string oldText = "a\r\nb\r\nc\r\n";
+	const std::string newText = "a\r\nc\r\n";
+	auto hunks = DiffLines(oldText, newText);
+	ASSERT_TRUE(hunks.has_value());
+	EXPECT_EQ(*hunks, (std::vector<DiffHunk>{ { 3, 3, 3, 0 } }));
+}
+
+
+TEST(LineDiffTest, TooManyEdits)
+{
+	std::string oldText, newText;
+	for(int i = 0; i < 100; i++) {
+		oldText += "old " + std::to_string(i) + "\n";
+		newText += "new " + std::to_string(i) + "\n";
+	}
+	EXPECT_FALSE(DiffLines(oldText, newText, 50).has_value());
+	auto hunks = DiffLines(oldText, newText, 200);
+	ASSERT_TRUE(hunks.has_value());
+	EXPECT_EQ(Apply(oldText, *hunks, newText), newText);
+}
+
+
+TEST(LineDiffTest, RandomEditsAreMinimal)
+{
+	std::mt19937 generator(42);
+	for(int round = 0; round < 200; round++) {
+		const std::string oldText = RandomLines(generator, generator() % 40);
+		std::string newText = oldText;
+		// a few whole line edits somewhere in the text
+		const int edits = generator() % 4;
+		for(int i = 0; i < edits; i++) {
+			size_t position = newText.empty() ? 0 : generator() % newText.size();
+			position = newText.rfind('\n', position);
+			position = position == std::string::npos ? 0 : position + 1;
+			newText.insert(position, "inserted\n");
+		}
+		auto hunks = DiffLines(oldText, newText);
+		ASSERT_TRUE(hunks.has_value());
+		EXPECT_EQ(Apply(oldText, *hunks, newText), newText) << round;
+		size_t inserted = 0;
+		for(const auto& hunk : *hunks) {
+			EXPECT_EQ(hunk.oldLength, 0u) << round;
+			inserted += hunk.newLength;
+		}
+		EXPECT_EQ(inserted, edits * 9u) << round;
+	}
+}
+
+
+TEST(LineDiffTest, RandomTexts)
+{
+	std::mt19937 generator(7);
+	for(int round = 0; round < 200; round++) {
+		const std::string oldText = RandomLines(generator, generator() % 30);
+		const std::string newText = RandomLines(generator, generator() % 30);
+		auto hunks = DiffLines(oldText, newText);
+		ASSERT_TRUE(hunks.has_value());
+		EXPECT_EQ(Apply(oldText, *hunks, newText), newText) << round;
+		// at least one unchanged line between hunks
+		for(size_t i = 1; i < hunks->size(); i++) {
+			EXPECT_GT((*hunks)[i].oldOffset,
+				(*hunks)[i - 1].oldOffset + (*hunks)[i - 1].oldLength);
+		}
+	}
+}
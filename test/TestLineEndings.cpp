@@ -0,0 +1,57 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "support/LineEndings.h"
+
+
+namespace {
+
+LineEndingCounter
+Count(const std::string& text, size_t pieceSize)
+{
+	LineEndingCounter counter;
+	for(size_t i = 0; i < text.size(); i += pieceSize)
+		counter.Update(std::string_view(text).substr(i, pieceSize));
+	return counter;
+}
+
+}
+
+
+TEST(LineEndingCounterTest, CountsEachStyle) {
+	std::string text;
+	for(int i = 0; i < 20; i++)
+		text += "line\r\n";
+	text += "unix\nmac\rend";
+	for(size_t pieceSize : { 1, 7, 16, 1000 }) {
+		const LineEndingCounter counter = Count(text, pieceSize);
+		ASSERT_EQ(counter.CountCRLF(), 20u);
+		ASSERT_EQ(counter.CountLF(), 1u);
+		ASSERT_EQ(counter.CountCR(), 1u);
+		ASSERT_EQ(counter.Dominant(), LineEndingCounter::CRLF);
+		ASSERT_TRUE(counter.Mixed());
+	}
+}
+
+TEST(LineEndingCounterTest, CountsCRLFAcrossBlocks) {
+	// CR as the last byte of a 16 byte block, LF as the first of the next
+	const std::string text = std::string(15, 'a') + "\r\n" + std::string(20, 'b');
+	const LineEndingCounter counter = Count(text, text.size());
+	ASSERT_EQ(counter.CountCRLF(), 1u);
+	ASSERT_EQ(counter.CountLF(), 0u);
+	ASSERT_EQ(counter.CountCR(), 0u);
+	ASSERT_FALSE(counter.Mixed());
+}
+
+TEST(LineEndingCounterTest, HandlesTextWithoutLineEndings) {
+	const LineEndingCounter counter = Count(std::string(100, 'x'), 100);
+	ASSERT_EQ(counter.Dominant(), LineEndingCounter::NONE);
+	ASSERT_FALSE(counter.Mixed());
+}
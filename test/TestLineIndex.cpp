@@ -0,0 +1,83 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "support/LineIndex.h"
+
+
+TEST(LineIndexTest, Empty)
+{
+	LineIndex index(2);
+	EXPECT_EQ(index.Size(), 0u);
+	EXPECT_EQ(index.LineCount(), 1u);
+	EXPECT_EQ(index.Locate(0), (LinePosition{ 0, 0 }));
+	EXPECT_EQ(index.Locate(10), (LinePosition{ 0, 0 }));
+}
+
+
+TEST(LineIndexTest, EveryStrideLine)
+{
+	LineIndex index(2);
+	index.Update("a\nbb\nccc\ndddd\neeeee");
+	EXPECT_EQ(index.Size(), 19u);
+	EXPECT_EQ(index.LineCount(), 5u);
+	EXPECT_EQ(index.Locate(0), (LinePosition{ 0, 0 }));
+	EXPECT_EQ(index.Locate(1), (LinePosition{ 0, 0 }));
+	EXPECT_EQ(index.Locate(2), (LinePosition{ 2, 5 }));
+	EXPECT_EQ(index.Locate(3), (LinePosition{ 2, 5 }));
+	EXPECT_EQ(index.Locate(4), (LinePosition{ 4, 14 }));
+	EXPECT_EQ(index.Locate(100), (LinePosition{ 4, 14 }));
+}
+
+
+TEST(LineIndexTest, TrailingNewlineStartsLine)
+{
+	LineIndex index(1);
+	index.Update("a\n");
+	EXPECT_EQ(index.LineCount(), 2u);
+	EXPECT_EQ(index.Locate(1), (LinePosition{ 1, 2 }));
+}
+
+
+TEST(LineIndexTest, PiecesGiveSameResult)
+{
+	std::string text;
+	for(int i = 0; i < 1000; i++)
+		text += std::string(i % 37, 'x') + "\n";
+
+	LineIndex whole(7);
+	whole.Update(text);
+	for(size_t pieceSize : { 1, 3, 64, 1000 }) {
+		LineIndex pieces(7);
+		for(size_t offset = 0; offset < text.size(); offset += pieceSize)
+			pieces.Update(std::string_view(text).substr(offset, pieceSize));
+		EXPECT_EQ(pieces.Size(), whole.Size());
+		EXPECT_EQ(pieces.LineCount(), whole.LineCount());
+		for(uint64_t line = 0; line < whole.LineCount(); line++)
+			EXPECT_EQ(pieces.Locate(line), whole.Locate(line)) << pieceSize;
+	}
+}
+
+
+TEST(LineIndexTest, LocatedOffsetStartsLine)
+{
+	std::string text;
+	for(int i = 0; i < 500; i++)
+		text += "line " + std::to_string(i) + "\n";
+
+	LineIndex index(16);
+	index.Update(text);
+	for(uint64_t line = 0; line < 500; line++) {
+		const LinePosition position = index.Locate(line);
+		EXPECT_LE(position.line, line);
+		EXPECT_GT(position.line + 16, line);
+		EXPECT_EQ(text.substr(position.offset, 5 + std::to_string(position.line).size()),
+			"line " + std::to_string(position.line));
+	}
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+
+#include "support/LiteralSearch.h"
+
+
+namespace {
+
+std::string
+Lower(std::string text)
+{
+	for(char& c : text) {
+		if(c >= 'A' && c <= 'Z')
+			c += 'a' - 'A';
+	}
+	return text;
+}
+
+
+std::string
+RandomText(std::mt19937& generator, size_t length)
+{
+	// few distinct characters, so that there are many candidates
+	const std::string alphabet = "abAB \n\xC3\xA9";
+	std::string text;
+	for(size_t i = 0; i < length; i++)
+		text += alphabet[generator() % alphabet.size()];
+	return text;
+}
+
+}
+
+
+TEST(LiteralSearchTest, Find)
+{
+	const std::string text = "the quick brown fox jumps over the lazy dog";
+	LiteralSearch search("the");
+	EXPECT_EQ(search.Find(text, 0, text.size()), 0u);
+	EXPECT_EQ(search.Find(text, 1, text.size()), 31u);
+	EXPECT_EQ(search.Find(text, 1, 33), LiteralSearch::npos);
+	EXPECT_EQ(search.Find(text, 1, 34), 31u);
+	EXPECT_EQ(LiteralSearch("cat").Find(text, 0, text.size()), LiteralSearch::npos);
+	EXPECT_EQ(LiteralSearch("").Find(text, 0, text.size()), LiteralSearch::npos);
+	EXPECT_EQ(LiteralSearch("g").Find(text, 0, text.size()), text.size() - 1);
+}
+
+
+TEST(LiteralSearchTest, IgnoreCase)
+{
+	const std::string text = "Hello, WORLD! hello world";
+	EXPECT_EQ(LiteralSearch("world").Find(text, 0, text.size()), 20u);
+	EXPECT_EQ(LiteralSearch("world", true).Find(text, 0, text.size()), 7u);
+	EXPECT_EQ(LiteralSearch("HELLO", true).FindBackward(text, 0, text.size()), 14u);
+	EXPECT_EQ(LiteralSearch("D!", true).Find(text, 0, text.size()), 11u);
+	EXPECT_EQ(LiteralSearch("\xC3\xA9T\xC3\xA9", true).Find("\xC3\xA9t\xC3\xA9", 0, 5), 0u);
+}
+
+
+TEST(LiteralSearchTest, FindBackward)
+{
+	const std::string text = "abcabcabc";
+	LiteralSearch search("abc");
+	EXPECT_EQ(search.FindBackward(text, 0, text.size()), 6u);
+	EXPECT_EQ(search.FindBackward(text, 0, 8), 3u);
+	EXPECT_EQ(search.FindBackward(text, 4, 8), LiteralSearch::npos);
+	EXPECT_EQ(LiteralSearch("aa").FindBackward("aaaa", 0, 4), 2u);
+}
+
+
+TEST(LiteralSearchTest, MatchesAcrossBlocks)
+{
+	// a long text with a single match placed at every offset in turn
+	std::string text(200000, 'x');
+	const std::string needle = "needle";
+	for(size_t position : { size_t(0), size_t(15), size_t(16), size_t(65535),
+			size_t(65536 - 3), size_t(131072), text.size() - needle.size() }) {
+		std::string haystack = text;
+		haystack.replace(position, needle.size(), needle);
+		LiteralSearch search(needle);
+		EXPECT_EQ(search.Find(haystack, 0, haystack.size()), position);
+		EXPECT_EQ(search.FindBackward(haystack, 0, haystack.size()), position);
+		EXPECT_EQ(LiteralSearch("NEEDLE", true).FindBackward(haystack, 0,
+			haystack.size()), position);
+	}
+}
+
+
+TEST(LiteralSearchTest, RandomTexts)
+{
+	std::mt19937 generator(42);
+	for(int round = 0; round < 2000; round++) {
+		const std::string text = RandomText(generator, generator() % 300);
+		const std::string needle = RandomText(generator, 1 + generator() % 4);
+		const bool ignoreCase = generator() % 2 == 0;
+		const size_t start = text.empty() ? 0 : generator() % text.size();
+		const size_t end = start + generator() % (text.size() - start + 1);
+
+		const std::string haystack = ignoreCase ? Lower(text) : text;
+		const std::string pattern = ignoreCase ? Lower(needle) : needle;
+		size_t expected = haystack.substr(0, end).find(pattern, start);
+		LiteralSearch search(needle, ignoreCase);
+		EXPECT_EQ(search.Find(text, start, end), expected) << round;
+
+		expected = haystack.substr(0, end).rfind(pattern);
+		if(expected != std::string::npos && expected < start)
+			expected = std::string::npos;
+		EXPECT_EQ(search.FindBackward(text, start, end), expected) << round;
+	}
+}
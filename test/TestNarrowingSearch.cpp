@@ -0,0 +1,153 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+
+#include "support/NarrowingSearch.h"
+#include "support/TextSearch.h"
+
+
+namespace {
+
+// what typing term with the caret at from selects, -1 if nothing
+int64_t
+Typed(NarrowingSearch& search, std::string_view text, std::string_view term,
+	size_t from)
+{
+	size_t matchStart, matchEnd;
+	if(search.Find(text, term, from, matchStart, matchEnd) == false)
+		return -1;
+	EXPECT_EQ(matchEnd - matchStart, term.size());
+	return matchStart;
+}
+
+
+int64_t
+Searched(std::string_view text, std::string_view term, size_t from)
+{
+	const TextSearch search(term, false, false, false);
+	size_t matchStart, matchEnd;
+	if(search.Find(text, from, text.size(), matchStart, matchEnd) == true
+			|| search.Find(text, 0, text.size(), matchStart, matchEnd) == true)
+		return matchStart;
+	return -1;
+}
+
+}
+
+
+TEST(NarrowingSearch, Narrows)
+{
+	const std::string text = "abc abd ABE xabc aab";
+	NarrowingSearch search(1 << 20, 0);
+	EXPECT_EQ(Typed(search, text, "a", 0), 0);
+	EXPECT_EQ(search.CountCandidates(), 6);
+	EXPECT_EQ(Typed(search, text, "ab", 5), 8);
+	EXPECT_EQ(search.CountCandidates(), 5);
+	EXPECT_EQ(Typed(search, text, "abc", 5), 13);
+	EXPECT_EQ(search.CountCandidates(), 2);
+	EXPECT_EQ(Typed(search, text, "abcd", 5), -1);
+	EXPECT_EQ(search.CountCandidates(), 0);
+
+	// backspace goes back to the occurrences found before
+	EXPECT_EQ(Typed(search, text, "abc", 14), 0);
+	EXPECT_EQ(search.CountCandidates(), 2);
+	EXPECT_EQ(Typed(search, text, "ab", 14), 18);
+	EXPECT_EQ(search.CountCandidates(), 5);
+
+	// a different term starts over
+	EXPECT_EQ(Typed(search, text, "x", 0), 12);
+	EXPECT_EQ(search.CountCandidates(), 1);
+	EXPECT_EQ(Typed(search, text, "", 0), -1);
+}
+
+
+TEST(NarrowingSearch, Overlapping)
+{
+	const std::string text = "aaab";
+	NarrowingSearch search(1 << 20, 0);
+	EXPECT_EQ(Typed(search, text, "a", 0), 0);
+	EXPECT_EQ(Typed(search, text, "aa", 0), 0);
+	EXPECT_EQ(search.CountCandidates(), 2);
+	EXPECT_EQ(Typed(search, text, "aab", 0), 1);
+}
+
+
+TEST(NarrowingSearch, TooManyCandidates)
+{
+	const std::string text = "aaaa ab aaaa ab";
+	NarrowingSearch search(4, 0);
+	EXPECT_EQ(Typed(search, text, "a", 6), 8);
+	EXPECT_EQ(search.CountCandidates(), -1);
+	EXPECT_EQ(Typed(search, text, "ab", 6), 13);
+	EXPECT_EQ(search.CountCandidates(), 2);
+	EXPECT_EQ(Typed(search, text, "ab", 14), 5);
+}
+
+
+TEST(NarrowingSearch, CollectsWhenFar)
+{
+	const std::string text = "ab ab ab ab ab ab ab ab ac";
+	NarrowingSearch search(1 << 20, 10);
+	// the next one is near, nothing is collected
+	EXPECT_EQ(Typed(search, text, "a", 0), 0);
+	EXPECT_EQ(search.CountCandidates(), -1);
+	// this one is far
+	EXPECT_EQ(Typed(search, text, "ac", 0), 24);
+	EXPECT_EQ(search.CountCandidates(), 1);
+	// and this one isn't there at all
+	EXPECT_EQ(Typed(search, text, "acd", 0), -1);
+	EXPECT_EQ(search.CountCandidates(), 0);
+	EXPECT_EQ(Typed(search, text, "acde", 0), -1);
+	EXPECT_EQ(search.CountCandidates(), 0);
+	EXPECT_EQ(Typed(search, text, "ab", 4), 6);
+	EXPECT_EQ(search.CountCandidates(), -1);
+	EXPECT_EQ(Typed(search, text, "abx", 4), -1);
+	EXPECT_EQ(search.CountCandidates(), 0);
+}
+
+
+TEST(NarrowingSearch, NonAscii)
+{
+	const std::string text = "Zażółć GĘŚLĄ jaźń, gęśla";
+	const int64_t upper = text.find("GĘŚLĄ");
+	const int64_t lower = text.find("gęśla");
+	NarrowingSearch search(1 << 20, 0);
+	EXPECT_EQ(Typed(search, text, "g", 0), upper);
+	EXPECT_EQ(Typed(search, text, "gę", upper + 1), lower);
+	EXPECT_EQ(Typed(search, text, "gęś", upper + 1), lower);
+	EXPECT_EQ(Typed(search, text, "gęśl", lower + 1), upper);
+	EXPECT_EQ(search.CountCandidates(), 2);
+}
+
+
+TEST(NarrowingSearch, SameAsSearching)
+{
+	std::mt19937 generator(7);
+	std::uniform_int_distribution<int> letter(0, 3);
+	std::string text;
+	for(int i = 0; i < 5000; i++)
+		text += "abAB"[letter(generator)];
+	for(int round = 0; round < 20; round++) {
+		NarrowingSearch search(1 << 20, 0);
+		std::string term;
+		for(int i = 0; i < 8; i++) {
+			term += "ab"[letter(generator) % 2];
+			const size_t from = generator() % text.size();
+			EXPECT_EQ(Typed(search, text, term, from),
+				Searched(text, term, from));
+		}
+		for(int i = 0; i < 4; i++) {
+			term.pop_back();
+			const size_t from = generator() % text.size();
+			EXPECT_EQ(Typed(search, text, term, from),
+				Searched(text, term, from));
+		}
+	}
+}
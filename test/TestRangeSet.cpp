@@ -0,0 +1,62 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include "support/RangeSet.h"
+
+
+TEST(RangeSet, Empty)
+{
+	RangeSet set;
+	EXPECT_TRUE(set.IsEmpty());
+	EXPECT_FALSE(set.Contains(0, 1));
+	EXPECT_TRUE(set.Contains(5, 5));
+	EXPECT_EQ(set.Gaps(0, 10), std::vector<RangeSet::Range>({ { 0, 10 } }));
+	EXPECT_TRUE(set.Gaps(3, 3).empty());
+}
+
+
+TEST(RangeSet, Merge)
+{
+	RangeSet set;
+	set.Add(10, 20);
+	set.Add(30, 40);
+	EXPECT_TRUE(set.Contains(12, 18));
+	EXPECT_FALSE(set.Contains(15, 35));
+
+	// touching ranges are merged
+	set.Add(20, 30);
+	EXPECT_TRUE(set.Contains(10, 40));
+	EXPECT_EQ(set.Gaps(0, 50),
+		std::vector<RangeSet::Range>({ { 0, 10 }, { 40, 50 } }));
+
+	// one range covering several
+	set.Add(50, 60);
+	set.Add(70, 80);
+	set.Add(5, 75);
+	EXPECT_TRUE(set.Contains(5, 80));
+	EXPECT_EQ(set.Gaps(0, 100),
+		std::vector<RangeSet::Range>({ { 0, 5 }, { 80, 100 } }));
+
+	set.Clear();
+	EXPECT_TRUE(set.IsEmpty());
+}
+
+
+TEST(RangeSet, Gaps)
+{
+	RangeSet set;
+	set.Add(10, 20);
+	set.Add(30, 40);
+	set.Add(50, 60);
+	EXPECT_EQ(set.Gaps(15, 55),
+		std::vector<RangeSet::Range>({ { 20, 30 }, { 40, 50 } }));
+	EXPECT_EQ(set.Gaps(0, 12), std::vector<RangeSet::Range>({ { 0, 10 } }));
+	EXPECT_EQ(set.Gaps(35, 38), std::vector<RangeSet::Range>());
+	EXPECT_EQ(set.Gaps(58, 70), std::vector<RangeSet::Range>({ { 60, 70 } }));
+	EXPECT_EQ(set.Gaps(22, 28), std::vector<RangeSet::Range>({ { 22, 28 } }));
+}
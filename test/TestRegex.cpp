@@ -0,0 +1,189 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <string>
+
+#include "support/Regex.h"
+
+
+namespace {
+
+/**
+ * Returns the first match of pattern in text, or "<none>".
+ */
+std::string
+Find(const std::string& pattern, const std::string& text, uint32_t flags = 0)
+{
+	auto regex = Regex::Compile(pattern, flags);
+	if(regex == nullptr)
+		return "<invalid>";
+	RegexMatch match;
+	if(regex->Search(text, 0, text.size(), match) == false)
+		return "<none>";
+	return std::string(match.Group(text, 0));
+}
+
+}
+
+
+TEST(RegexTest, Literals)
+{
+	EXPECT_EQ(Find("abc", "xxabcxx"), "abc");
+	EXPECT_EQ(Find("abd", "xxabcxx"), "<none>");
+	EXPECT_EQ(Find("a.c", "abc"), "abc");
+	EXPECT_EQ(Find("a\\.c", "abc a.c"), "a.c");
+	EXPECT_EQ(Find("", "abc"), "");
+}
+
+
+TEST(RegexTest, Quantifiers)
+{
+	EXPECT_EQ(Find("a+", "baaab"), "aaa");
+	EXPECT_EQ(Find("a+?", "baaab"), "a");
+	EXPECT_EQ(Find("ba*", "baaab"), "baaa");
+	EXPECT_EQ(Find("ba*?", "baaab"), "b");
+	EXPECT_EQ(Find("colou?r", "color"), "color");
+	EXPECT_EQ(Find("a{2}", "aaaa"), "aa");
+	EXPECT_EQ(Find("a{2,}", "aaaa"), "aaaa");
+	EXPECT_EQ(Find("a{1,3}", "aaaa"), "aaa");
+	EXPECT_EQ(Find("a{,3}", "a{,3}"), "a{,3}");
+	EXPECT_EQ(Find("<.*>", "<a><b>"), "<a><b>");
+	EXPECT_EQ(Find("<.*?>", "<a><b>"), "<a>");
+}
+
+
+TEST(RegexTest, LeftmostFirstAlternation)
+{
+	EXPECT_EQ(Find("ab|abc", "abc"), "ab");
+	EXPECT_EQ(Find("abc|ab", "abc"), "abc");
+	EXPECT_EQ(Find("b|ab", "ab"), "ab");
+	EXPECT_EQ(Find("(a|ab)(c|bcd)", "abcd"), "abcd");
+	EXPECT_EQ(Find("(ab|a)(c|bcd)", "abcd"), "abc");
+}
+
+
+TEST(RegexTest, Groups)
+{
+	const std::string text = "key = value";
+	auto regex = Regex::Compile("(\\w+)\\s*=\\s*(\\w+)(;)?");
+	ASSERT_NE(regex, nullptr);
+	EXPECT_EQ(regex->GroupCount(), 4u);
+	RegexMatch match;
+	ASSERT_TRUE(regex->Search(text, 0, text.size(), match));
+	EXPECT_EQ(match.Group(text, 1), "key");
+	EXPECT_EQ(match.Group(text, 2), "value");
+	EXPECT_EQ(match.groups[3].first, RegexMatch::npos);
+
+	regex = Regex::Compile("(?:(a)|b)+");
+	ASSERT_TRUE(regex->Search("ab", 0, 2, match));
+	EXPECT_EQ(regex->GroupCount(), 2u);
+	EXPECT_EQ(match.End(), 2u);
+	EXPECT_EQ(match.Group("ab", 1), "a");
+}
+
+
+TEST(RegexTest, Classes)
+{
+	EXPECT_EQ(Find("[a-c]+", "xxbcaxx"), "bca");
+	EXPECT_EQ(Find("[^a-c]+", "abxyc"), "xy");
+	EXPECT_EQ(Find("[]a]+", "x]a]x"), "]a]");
+	EXPECT_EQ(Find("[a-]+", "x-a-x"), "-a-");
+	EXPECT_EQ(Find("\\d+", "abc123def"), "123");
+	EXPECT_EQ(Find("\\D+", "123abc456"), "abc");
+	EXPECT_EQ(Find("[\\d.]+", "v1.25;"), "1.25");
+	EXPECT_EQ(Find("\\x41\\u0042", "zAB"), "AB");
+	EXPECT_EQ(Find("\\S+", "  word  "), "word");
+}
+
+
+TEST(RegexTest, Anchors)
+{
+	EXPECT_EQ(Find("^b", "ab\nbc"), "b");
+	EXPECT_EQ(Find("a$", "ba\r\nab"), "a");
+	EXPECT_EQ(Find("[ \\t]+$", "x \ty  \nz"), "  ");
+	EXPECT_EQ(Find("\\bis\\b", "this is"), "is");
+	EXPECT_EQ(Find("\\Bis", "is this"), "is");
+	EXPECT_EQ(Find("is", "this is", Regex::WHOLE_WORD), "is");
+
+	const std::string text = "ab\nab";
+	auto regex = Regex::Compile("^ab");
+	RegexMatch match;
+	ASSERT_TRUE(regex->Search(text, 1, text.size(), match));
+	EXPECT_EQ(match.Start(), 3u);
+}
+
+
+TEST(RegexTest, IgnoreCase)
+{
+	EXPECT_EQ(Find("hello", "Say HeLLo", Regex::IGNORE_CASE), "HeLLo");
+	EXPECT_EQ(Find("hello", "Say HeLLo"), "<none>");
+	EXPECT_EQ(Find("[a-z]+", "ABC", Regex::IGNORE_CASE), "ABC");
+	EXPECT_EQ(Find("ÉTÉ", "été", Regex::IGNORE_CASE), "été");
+	EXPECT_EQ(Find("źdźbło", "ŹDŹBŁO", Regex::IGNORE_CASE), "ŹDŹBŁO");
+	EXPECT_EQ(Find("привет", "ПРИВЕТ", Regex::IGNORE_CASE), "ПРИВЕТ");
+}
+
+
+TEST(RegexTest, Utf8)
+{
+	EXPECT_EQ(Find("a.b", "aéb"), "aéb");
+	EXPECT_EQ(Find("[é]", "été"), "é");
+	EXPECT_EQ(Find("[^a]", "é"), "é");
+	// an invalid byte is a character of its own
+	EXPECT_EQ(Find("a.b", "a\xFF" "b"), "a\xFF" "b");
+}
+
+
+TEST(RegexTest, InvalidPatterns)
+{
+	EXPECT_EQ(Regex::Compile("(ab"), nullptr);
+	EXPECT_EQ(Regex::Compile("ab)"), nullptr);
+	EXPECT_EQ(Regex::Compile("[ab"), nullptr);
+	EXPECT_EQ(Regex::Compile("*a"), nullptr);
+	EXPECT_EQ(Regex::Compile("a**"), nullptr);
+	EXPECT_EQ(Regex::Compile("[z-a]"), nullptr);
+	EXPECT_EQ(Regex::Compile("(a)\\1"), nullptr);
+	EXPECT_EQ(Regex::Compile("a{2000}"), nullptr);
+	EXPECT_EQ(Regex::Compile(std::string(1000, '(') + std::string(1000, ')')), nullptr);
+	EXPECT_EQ(Regex::Compile("\\"), nullptr);
+}
+
+
+TEST(RegexTest, SearchBackward)
+{
+	const std::string text = "one two three";
+	auto regex = Regex::Compile("\\w+");
+	RegexMatch match;
+	ASSERT_TRUE(regex->SearchBackward(text, 0, text.size(), match));
+	EXPECT_EQ(match.Group(text, 0), "three");
+	ASSERT_TRUE(regex->SearchBackward(text, 0, 7, match));
+	EXPECT_EQ(match.Group(text, 0), "two");
+	EXPECT_FALSE(regex->SearchBackward(text, 3, 4, match));
+}
+
+
+TEST(RegexTest, CompiledPatternsAreCached)
+{
+	auto first = Regex::Compile("cache(d)?");
+	auto second = Regex::Compile("cache(d)?");
+	EXPECT_EQ(first, second);
+	EXPECT_NE(first, Regex::Compile("cache(d)?", Regex::IGNORE_CASE));
+}
+
+
+TEST(RegexTest, PathologicalPatternIsLinear)
+{
+	// (a*)*b backtracks exponentially, here it is one pass over the text
+	const std::string text(100000, 'a');
+	const auto start = std::chrono::steady_clock::now();
+	EXPECT_EQ(Find("(a*)*b", text), "<none>");
+	EXPECT_EQ(Find("(a|aa)+$", text).size(), text.size());
+	const auto elapsed = std::chrono::steady_clock::now() - start;
+	EXPECT_LT(elapsed, std::chrono::seconds(10));
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2026 Kacper Kasper <kacperkasper@gmail.com>
+ * All rights reserved. Distributed under the terms of the MIT license.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "support/TextSearch.h"
+
+
+namespace {
+
+std::vector<TextMatch>
+FindAll(const TextSearch& search, const std::string& text,
+	size_t batchSize = 1000)
+{
+	std::vector<TextMatch> matches;
+	search.FindAll(text, batchSize, [&](const std::vector<TextMatch>& batch) {
+		matches.insert(matches.end(), batch.begin(), batch.end());
+		return true;
+	});
+	return matches;
+}
+
+}
+
+
+TEST(TextSearchTest, PlainText)
+{
+	const std::string text = "one two\nTwo three\r\ntwo";
+	TextSearch search("two", true, false, false);
+	ASSERT_TRUE(search.IsValid());
+	EXPECT_EQ(FindAll(search, text), (std::vector<TextMatch>{
+		{ 4, 7, 0 }, { 19, 22, 2 } }));
+
+	TextSearch ignoreCase("two", false, false, false);
+	EXPECT_EQ(FindAll(ignoreCase, text).size(), 3u);
+}
+
+
+TEST(TextSearchTest, WholeWords)
+{
+	const std::string text = "cat concat cat.scatter (cat)";
+	TextSearch search("cat", true, true, false);
+	const auto matches = FindAll(search, text);
+	ASSERT_EQ(matches.size(), 3u);
+	EXPECT_EQ(matches[1].start, 11u);
+	EXPECT_EQ(matches[2].start, 24u);
+
+	// special characters are matched literally
+	TextSearch dots("a.b", true, true, false);
+	EXPECT_EQ(FindAll(dots, "axb a.b").size(), 1u);
+}
+
+
+TEST(TextSearchTest, NonAsciiIgnoringCase)
+{
+	TextSearch search("żółw", false, false, false);
+	ASSERT_TRUE(search.IsValid());
+	size_t start, end;
+	const std::string text = "ŻÓŁW żółw";
+	ASSERT_TRUE(search.Find(text, 0, text.size(), start, end));
+	EXPECT_EQ(start, 0u);
+	EXPECT_EQ(end, 7u);
+}
+
+
+TEST(TextSearchTest, Regex)
+{
+	TextSearch search("^\\w+", true, false, true);
+	const std::string text = "first line\nsecond\rthird";
+	const auto matches = FindAll(search, text);
+	ASSERT_EQ(matches.size(), 3u);
+	EXPECT_EQ(matches[1], (TextMatch{ 11, 17, 1 }));
+	EXPECT_EQ(matches[2], (TextMatch{ 18, 23, 2 }));
+
+	EXPECT_FALSE(TextSearch("(", true, false, true).IsValid());
+	EXPECT_FALSE(TextSearch("", true, false, false).IsValid());
+}
+
+
+TEST(TextSearchTest, EmptyMatches)
+{
+	TextSearch search("x*", true, false, true);
+	const auto matches = FindAll(search, "ab\xC3\xA9");
+	// before a, before b, before é and at the end
+	ASSERT_EQ(matches.size(), 4u);
+	EXPECT_EQ(matches[3].start, 4u);
+}
+
+
+TEST(TextSearchTest, Batches)
+{
+	std::string text;
+	for(int i = 0; i < 25; i++)
+		text += "match\n";
+	TextSearch search("match", true, false, false);
+	std::vector<size_t> sizes;
+	search.FindAll(text, 10, [&](const std::vector<TextMatch>& batch) {
+		sizes.push_back(batch.size());
+		return true;
+	});
+	EXPECT_EQ(sizes, (std::vector<size_t>{ 10, 10, 5 }));
+	EXPECT_EQ(FindAll(search, text, 10).back().line, 24u);
+
+	size_t delivered = 0;
+	EXPECT_FALSE(search.FindAll(text, 10, [&](const std::vector<TextMatch>& batch) {
+		delivered += batch.size();
+		return false;
+	}));
+	EXPECT_EQ(delivered, 10u);
+}
+
+
+TEST(TextSearchTest, SearchBackward)
+{
+	const std::string text = "word words word";
+	RegexMatch match;
+	TextSearch plain("word", true, false, false);
+	ASSERT_TRUE(plain.IsLiteral());
+	ASSERT_TRUE(plain.Search(text, 0, text.size(), true, match));
+	EXPECT_EQ(match.Start(), 11u);
+	EXPECT_EQ(match.End(), 15u);
+
+	TextSearch whole("word", true, true, false);
+	EXPECT_FALSE(whole.IsLiteral());
+	ASSERT_TRUE(whole.Search(text, 0, 10, true, match));
+	EXPECT_EQ(match.Start(), 0u);
+
+	TextSearch regex("w(or)d", true, false, true);
+	ASSERT_TRUE(regex.Search(text, 0, text.size(), false, match));
+	EXPECT_EQ(match.Group(text, 1), "or");
+}
+
+
+TEST(TextSearchTest, MatchesAcrossChunks)
+{
+	// longer than the part of the text searched between cancellation checks
+	std::string text(3 * 1024 * 1024 + 5, 'a');
+	text[1024 * 1024 - 2] = 'x';
+	text[2 * 1024 * 1024] = '\xC3';
+	text[2 * 1024 * 1024 + 1] = '\xA9';
+	TextSearch literal("xaaaa", true, false, false);
+	EXPECT_EQ(FindAll(literal, text).size(), 1u);
+	TextSearch regex("xa+", true, false, true);
+	const auto matches = FindAll(regex, text);
+	ASSERT_EQ(matches.size(), 1u);
+	EXPECT_EQ(matches[0].end, 2u * 1024 * 1024u);
+	TextSearch character("\xC3\xA9", true, false, true);
+	EXPECT_EQ(FindAll(character, text).size(), 1u);
+
+	int polls = 0;
+	EXPECT_FALSE(literal.FindAll(text, 10, [](const std::vector<TextMatch>&) {
+		return true;
+	}, [&]() { return ++polls == 2; }));
+}